@@ -0,0 +1,70 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ArtNetPollReply.h"
+
+#include <algorithm>
+
+// must be last include
+#include "LeakWatcher.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t ArtNetPollReply::BuildPages(PORT_ADDRESSES portAddresses, PAGES &pages)
+{
+  pages.clear();
+
+  // sorted, so universes sharing a Net and Sub-Net are adjacent and fill pages together
+  std::sort(portAddresses.begin(), portAddresses.end());
+  portAddresses.erase(std::unique(portAddresses.begin(), portAddresses.end()), portAddresses.end());
+
+  size_t advertised = 0;
+  for (PORT_ADDRESSES::const_iterator i = portAddresses.begin(); i != portAddresses.end(); ++i)
+  {
+    uint16_t portAddress = (*i & 0x7fff);
+    uint8_t net = static_cast<uint8_t>(portAddress >> 8);
+    uint8_t subNet = static_cast<uint8_t>((portAddress >> 4) & 0xf);
+
+    if (pages.empty() || pages.back().portCount == PORTS_PER_PAGE || pages.back().net != net || pages.back().subNet != subNet)
+    {
+      if (pages.size() == MAX_PAGES)
+        break;
+
+      sPage page;
+      page.bindIndex = static_cast<uint8_t>(pages.size() + 1);
+      page.net = net;
+      page.subNet = subNet;
+      pages.push_back(page);
+    }
+
+    sPage &page = pages.back();
+    page.universes[page.portCount++] = static_cast<uint8_t>(portAddress & 0xf);
+    ++advertised;
+  }
+
+  return advertised;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint16_t ArtNetPollReply::GetPortAddress(const sPage &page, size_t port)
+{
+  return static_cast<uint16_t>(((page.net & 0x7f) << 8) | ((page.subNet & 0xf) << 4) | (page.universes[port] & 0xf));
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef ARTNET_POLL_REPLY_H
+#define ARTNET_POLL_REPLY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// ArtPollReply pages advertising the universes a raw ArtNet node receives
+//
+// one reply describes at most PORTS_PER_PAGE output ports, all sharing a Net and Sub-Net, so a node
+// receiving many universes answers each ArtPoll with several replies told apart by bind index
+class ArtNetPollReply
+{
+public:
+  enum EnumConstants
+  {
+    PORTS_PER_PAGE = 4,  // ARTNET_MAX_PORTS
+    MAX_PAGES = 255      // bind index is one byte, starting at 1
+  };
+
+  struct sPage
+  {
+    uint8_t bindIndex = 0;
+    uint8_t net = 0;     // port address bits 14-8
+    uint8_t subNet = 0;  // bits 7-4
+    uint8_t portCount = 0;
+    std::array<uint8_t, PORTS_PER_PAGE> universes{};  // bits 3-0, per port
+  };
+
+  typedef std::vector<sPage> PAGES;
+  typedef std::vector<uint16_t> PORT_ADDRESSES;
+
+  // returns how many distinct port addresses the pages advertise, fewer than given only past MAX_PAGES
+  static size_t BuildPages(PORT_ADDRESSES portAddresses, PAGES &pages);
+  static uint16_t GetPortAddress(const sPage &page, size_t port);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
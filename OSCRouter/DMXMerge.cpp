@@ -0,0 +1,418 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "DMXMerge.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define DMX_MERGE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DMX_MERGE_AVX2_TARGET
+#else
+#define DMX_MERGE_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DMX_MERGE_NEON
+#include <arm_neon.h>
+#endif
+
+// must be last include
+#include "LeakWatcher.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool MergeScalar(const uint8_t *dmx, const uint8_t *priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  bool taken = false;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (priority[i] > mergedPriority[i])
+    {
+      mergedDMX[i] = dmx[i];
+      mergedPriority[i] = priority[i];
+      owner[i] = index;
+      taken = true;
+    }
+  }
+
+  return taken;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool MergeLevelScalar(const uint8_t *dmx, uint8_t priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  bool taken = false;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (priority > mergedPriority[i])
+    {
+      mergedDMX[i] = dmx[i];
+      mergedPriority[i] = priority;
+      owner[i] = index;
+      taken = true;
+    }
+  }
+
+  return taken;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef DMX_MERGE_X86
+
+// unsigned bytes have no greater-than compare, so a channel is kept where max(priority, merged) == merged
+
+static bool MergeSSE2Block(__m128i priority, __m128i index, const uint8_t *dmx, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner)
+{
+  __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dmx));
+  __m128i md = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mergedDMX));
+  __m128i mp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mergedPriority));
+  __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i *>(owner));
+  __m128i maxp = _mm_max_epu8(priority, mp);
+  __m128i keep = _mm_cmpeq_epi8(maxp, mp);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(mergedDMX), _mm_or_si128(_mm_and_si128(keep, md), _mm_andnot_si128(keep, d)));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(mergedPriority), maxp);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(owner), _mm_or_si128(_mm_and_si128(keep, o), _mm_andnot_si128(keep, index)));
+  return (_mm_movemask_epi8(keep) != 0xffff);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool MergeSSE2(const uint8_t *dmx, const uint8_t *priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  __m128i n = _mm_set1_epi8(static_cast<char>(index));
+  bool taken = false;
+  size_t i = 0;
+  for (; (i + 16) <= count; i += 16)
+    taken |= MergeSSE2Block(_mm_loadu_si128(reinterpret_cast<const __m128i *>(priority + i)), n, dmx + i, mergedDMX + i, mergedPriority + i, owner + i);
+
+  return (MergeScalar(dmx + i, priority + i, index, mergedDMX + i, mergedPriority + i, owner + i, count - i) || taken);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool MergeLevelSSE2(const uint8_t *dmx, uint8_t priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  __m128i p = _mm_set1_epi8(static_cast<char>(priority));
+  __m128i n = _mm_set1_epi8(static_cast<char>(index));
+  bool taken = false;
+  size_t i = 0;
+  for (; (i + 16) <= count; i += 16)
+    taken |= MergeSSE2Block(p, n, dmx + i, mergedDMX + i, mergedPriority + i, owner + i);
+
+  return (MergeLevelScalar(dmx + i, priority, index, mergedDMX + i, mergedPriority + i, owner + i, count - i) || taken);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DMX_MERGE_AVX2_TARGET static bool MergeAVX2Block(__m256i priority, __m256i index, const uint8_t *dmx, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner)
+{
+  __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dmx));
+  __m256i md = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mergedDMX));
+  __m256i mp = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mergedPriority));
+  __m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(owner));
+  __m256i maxp = _mm256_max_epu8(priority, mp);
+  __m256i keep = _mm256_cmpeq_epi8(maxp, mp);
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(mergedDMX), _mm256_blendv_epi8(d, md, keep));
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(mergedPriority), maxp);
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(owner), _mm256_blendv_epi8(index, o, keep));
+  return (static_cast<unsigned int>(_mm256_movemask_epi8(keep)) != 0xffffffffu);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DMX_MERGE_AVX2_TARGET static bool MergeAVX2(const uint8_t *dmx, const uint8_t *priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  __m256i n = _mm256_set1_epi8(static_cast<char>(index));
+  bool taken = false;
+  size_t i = 0;
+  for (; (i + 32) <= count; i += 32)
+    taken |= MergeAVX2Block(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(priority + i)), n, dmx + i, mergedDMX + i, mergedPriority + i, owner + i);
+
+  return (MergeScalar(dmx + i, priority + i, index, mergedDMX + i, mergedPriority + i, owner + i, count - i) || taken);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DMX_MERGE_AVX2_TARGET static bool MergeLevelAVX2(const uint8_t *dmx, uint8_t priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  __m256i p = _mm256_set1_epi8(static_cast<char>(priority));
+  __m256i n = _mm256_set1_epi8(static_cast<char>(index));
+  bool taken = false;
+  size_t i = 0;
+  for (; (i + 32) <= count; i += 32)
+    taken |= MergeAVX2Block(p, n, dmx + i, mergedDMX + i, mergedPriority + i, owner + i);
+
+  return (MergeLevelScalar(dmx + i, priority, index, mergedDMX + i, mergedPriority + i, owner + i, count - i) || taken);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool HasAVX2()
+{
+#ifdef _MSC_VER
+  int info[4] = {0};
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+
+  // AVX2 also needs the OS to save ymm registers
+  __cpuid(info, 1);
+  const int osxsave = (1 << 27);
+  const int avx = (1 << 28);
+  if ((info[2] & osxsave) == 0 || (info[2] & avx) == 0 || (_xgetbv(0) & 6) != 6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  return ((info[1] & (1 << 5)) != 0);
+#else
+  return (__builtin_cpu_supports("avx2") != 0);
+#endif
+}
+
+#endif  // DMX_MERGE_X86
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef DMX_MERGE_NEON
+
+static bool MergeNEON(const uint8_t *dmx, const uint8_t *priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  uint8x16_t n = vdupq_n_u8(index);
+  uint8x16_t taken = vdupq_n_u8(0);
+  size_t i = 0;
+  for (; (i + 16) <= count; i += 16)
+  {
+    uint8x16_t p = vld1q_u8(priority + i);
+    uint8x16_t mp = vld1q_u8(mergedPriority + i);
+    uint8x16_t take = vcgtq_u8(p, mp);
+    vst1q_u8(mergedDMX + i, vbslq_u8(take, vld1q_u8(dmx + i), vld1q_u8(mergedDMX + i)));
+    vst1q_u8(mergedPriority + i, vmaxq_u8(p, mp));
+    vst1q_u8(owner + i, vbslq_u8(take, n, vld1q_u8(owner + i)));
+    taken = vorrq_u8(taken, take);
+  }
+
+  return (MergeScalar(dmx + i, priority + i, index, mergedDMX + i, mergedPriority + i, owner + i, count - i) || vmaxvq_u8(taken) != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool MergeLevelNEON(const uint8_t *dmx, uint8_t priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  uint8x16_t p = vdupq_n_u8(priority);
+  uint8x16_t n = vdupq_n_u8(index);
+  uint8x16_t taken = vdupq_n_u8(0);
+  size_t i = 0;
+  for (; (i + 16) <= count; i += 16)
+  {
+    uint8x16_t mp = vld1q_u8(mergedPriority + i);
+    uint8x16_t take = vcgtq_u8(p, mp);
+    vst1q_u8(mergedDMX + i, vbslq_u8(take, vld1q_u8(dmx + i), vld1q_u8(mergedDMX + i)));
+    vst1q_u8(mergedPriority + i, vmaxq_u8(p, mp));
+    vst1q_u8(owner + i, vbslq_u8(take, n, vld1q_u8(owner + i)));
+    taken = vorrq_u8(taken, take);
+  }
+
+  return (MergeLevelScalar(dmx + i, priority, index, mergedDMX + i, mergedPriority + i, owner + i, count - i) || vmaxvq_u8(taken) != 0);
+}
+
+#endif  // DMX_MERGE_NEON
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DMXMerge::Merge(const uint8_t *dmx, const uint8_t *priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  return GetKernel().merge(dmx, priority, index, mergedDMX, mergedPriority, owner, count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DMXMerge::Merge(const uint8_t *dmx, uint8_t priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count)
+{
+  return GetKernel().mergeLevel(dmx, priority, index, mergedDMX, mergedPriority, owner, count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DMXMerge::Copy(const uint8_t *dmx, uint8_t *outputDMX, size_t count)
+{
+  // both are vectorized by the C library, and an unchanged universe is only read
+  if (count == 0 || memcmp(outputDMX, dmx, count) == 0)
+    return false;
+
+  memcpy(outputDMX, dmx, count);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const char *DMXMerge::GetKernelName()
+{
+  return GetKernel().name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const DMXMerge::sKernel &DMXMerge::GetKernel()
+{
+  static const sKernel kernel = SelectKernel();
+  return kernel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DMXMerge::sKernel DMXMerge::SelectKernel()
+{
+  std::vector<sKernel> kernels;
+
+#ifdef DMX_MERGE_X86
+  if (HasAVX2())
+  {
+    sKernel avx2;
+    avx2.name = "avx2";
+    avx2.merge = MergeAVX2;
+    avx2.mergeLevel = MergeLevelAVX2;
+    kernels.push_back(avx2);
+  }
+
+  sKernel sse2;
+  sse2.name = "sse2";
+  sse2.merge = MergeSSE2;
+  sse2.mergeLevel = MergeLevelSSE2;
+  kernels.push_back(sse2);
+#endif
+
+#ifdef DMX_MERGE_NEON
+  sKernel neon;
+  neon.name = "neon";
+  neon.merge = MergeNEON;
+  neon.mergeLevel = MergeLevelNEON;
+  kernels.push_back(neon);
+#endif
+
+  for (size_t i = 0; i < kernels.size(); ++i)
+  {
+    if (SelfCheck(kernels[i]))
+      return kernels[i];
+  }
+
+  sKernel scalar;
+  scalar.name = "scalar";
+  scalar.merge = MergeScalar;
+  scalar.mergeLevel = MergeLevelScalar;
+  return scalar;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DMXMerge::SelfCheck(const sKernel &kernel)
+{
+  const size_t kSize = 512 + 47;  // full blocks plus every tail length
+  std::vector<uint8_t> dmx(kSize), priority(kSize), initialDMX(kSize), initialPriority(kSize), initialOwner(kSize);
+
+  // priorities from a small range, so ties and both directions are common
+  uint32_t seed = 0x2545f491u;
+  for (size_t i = 0; i < kSize; ++i)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    dmx[i] = static_cast<uint8_t>(seed >> 24);
+    priority[i] = static_cast<uint8_t>(((seed >> 8) & 3) * 85);
+    seed = seed * 1664525u + 1013904223u;
+    initialDMX[i] = static_cast<uint8_t>(seed >> 24);
+    initialPriority[i] = static_cast<uint8_t>(((seed >> 8) & 3) * 85);
+    initialOwner[i] = static_cast<uint8_t>(seed & 7);
+  }
+
+  const uint8_t index = 0xa5;
+
+  for (size_t count = 0; count <= kSize; count += ((count < 64) ? 1 : 37))
+  {
+    std::vector<uint8_t> expectedDMX(initialDMX), expectedPriority(initialPriority), expectedOwner(initialOwner);
+    std::vector<uint8_t> mergedDMX(initialDMX), mergedPriority(initialPriority), owner(initialOwner);
+    bool expected = MergeScalar(dmx.data(), priority.data(), index, expectedDMX.data(), expectedPriority.data(), expectedOwner.data(), count);
+    bool taken = kernel.merge(dmx.data(), priority.data(), index, mergedDMX.data(), mergedPriority.data(), owner.data(), count);
+    if (taken != expected || expectedDMX != mergedDMX || expectedPriority != mergedPriority || expectedOwner != owner)
+      return false;
+
+    for (unsigned int level = 0; level <= 255; level += 85)
+    {
+      expectedDMX = mergedDMX = initialDMX;
+      expectedPriority = mergedPriority = initialPriority;
+      expectedOwner = owner = initialOwner;
+      expected = MergeLevelScalar(dmx.data(), static_cast<uint8_t>(level), index, expectedDMX.data(), expectedPriority.data(), expectedOwner.data(), count);
+      taken = kernel.mergeLevel(dmx.data(), static_cast<uint8_t>(level), index, mergedDMX.data(), mergedPriority.data(), owner.data(), count);
+      if (taken != expected || expectedDMX != mergedDMX || expectedPriority != mergedPriority || expectedOwner != owner)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double DMXMerge::Benchmark(unsigned int durationMS /*= 20*/)
+{
+  const size_t kChannels = 512;
+  uint8_t dmx[2][kChannels];
+  uint8_t priority[2][kChannels];
+  uint8_t mergedDMX[kChannels];
+  uint8_t mergedPriority[kChannels];
+  uint8_t owner[kChannels];
+
+  // primary and backup source, each ahead on half the channels
+  for (size_t i = 0; i < kChannels; ++i)
+  {
+    dmx[0][i] = static_cast<uint8_t>(i);
+    dmx[1][i] = static_cast<uint8_t>(~i);
+    priority[0][i] = static_cast<uint8_t>((i & 1) ? 100 : 99);
+    priority[1][i] = static_cast<uint8_t>((i & 1) ? 99 : 100);
+  }
+
+  typedef std::chrono::steady_clock CLOCK;
+  CLOCK::time_point start = CLOCK::now();
+  CLOCK::time_point end = (start + std::chrono::milliseconds(durationMS));
+  CLOCK::time_point now = start;
+  uint64_t universes = 0;
+
+  do
+  {
+    for (unsigned int i = 0; i < 256; ++i)
+    {
+      memcpy(mergedDMX, dmx[0], kChannels);
+      memcpy(mergedPriority, priority[0], kChannels);
+      memset(owner, 0, kChannels);
+      Merge(dmx[1], priority[1], 1, mergedDMX, mergedPriority, owner, kChannels);
+    }
+
+    universes += 256;
+    now = CLOCK::now();
+  } while (now < end);
+
+  double ms = std::chrono::duration<double, std::milli>(now - start).count();
+  return ((ms > 0) ? (universes / ms) : 0);
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+#ifndef DMX_MERGE_H
+#define DMX_MERGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// highest priority takes precedence merge of one sACN source into a merged universe
+//
+// a channel is taken from the source only when its priority is strictly higher than the merged
+// priority, so on a tie the universe merged first keeps it, same as the original scalar loops
+// taken channels have their owner set to the source's index, so later level changes from a
+// source can be applied to just the channels it owns
+//
+// the kernel is picked once at runtime (AVX2, SSE2, NEON, or scalar), and only used after it
+// matches the scalar kernel bit for bit on a self-check pattern
+class DMXMerge
+{
+public:
+  // per channel priority source, returns true when any channel was taken from it
+  static bool Merge(const uint8_t *dmx, const uint8_t *priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count);
+
+  // single priority source, returns true when any channel was taken from it
+  static bool Merge(const uint8_t *dmx, uint8_t priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count);
+
+  // copies levels over an output universe, returns true when any of them changed
+  static bool Copy(const uint8_t *dmx, uint8_t *outputDMX, size_t count);
+
+  static const char *GetKernelName();
+
+  // universes of 512 channels merged per millisecond with the selected kernel
+  static double Benchmark(unsigned int durationMS = 20);
+
+private:
+  typedef bool (*MERGE_FN)(const uint8_t *dmx, const uint8_t *priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count);
+  typedef bool (*MERGE_LEVEL_FN)(const uint8_t *dmx, uint8_t priority, uint8_t index, uint8_t *mergedDMX, uint8_t *mergedPriority, uint8_t *owner, size_t count);
+
+  struct sKernel
+  {
+    const char *name = nullptr;
+    MERGE_FN merge = nullptr;
+    MERGE_LEVEL_FN mergeLevel = nullptr;
+  };
+
+  static const sKernel &GetKernel();
+  static sKernel SelectKernel();
+  static bool SelfCheck(const sKernel &kernel);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -41,6 +41,23 @@
 #define SETTING_RECONNECT_DELAY "ReconnectDelay"
 #define SETTING_DISABLE_SYSTEM_IDLE "DisableSystemIdle"
 #define SETTING_AUTO_START "AutoStart"
+#define SETTING_ROUTER_POLLING "RouterPolling"
+#define SETTING_ROUTER_LATENCY_STATS "RouterLatencyStats"
+#define SETTING_UDP_BATCH_RECV "UdpBatchRecv"
+#define SETTING_UDP_RECV_BUFFER_SIZE "UdpRecvBufferSize"
+#define SETTING_UDP_BATCH_SEND "UdpBatchSend"
+#define SETTING_ARTNET_SYNC "ArtNetSync"
+#define SETTING_ARTNET_UNICAST "ArtNetUnicast"
+#define SETTING_PSN_BUNDLE "PSNBundle"
+#define SETTING_PSN_TRACKER_MIN "PSNTrackerMin"
+#define SETTING_PSN_TRACKER_MAX "PSNTrackerMax"
+#define SETTING_PSN_OUTPUT_RATE "PSNOutputRate"
+#define SETTING_UDP_BUNDLE_SIZE "UdpBundleSize"
+#define SETTING_UDP_IN_REACTORS "UdpInReactors"
+#define SETTING_UDP_IN_REACTOR_PINNED "UdpInReactorPinned"
+#define SETTING_ROUTER_SHARDS "RouterShards"
+#define SETTING_SCRIPT_WORKERS "ScriptWorkers"
+#define SETTING_SCRIPT_TIMEOUT "ScriptTimeoutMS"
 #define ACTIVITY_TIMEOUT_MS 300
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1136,7 +1153,12 @@ SettingsWidget::SettingsWidget(QSettings& settings, QWidget* parent /*= nullptr*
   ++row;
 
   label = new QLabel(tr("JavaScript Globals"), base);
-  label->setToolTip(tr("Declare global JavaScript variables\n\nEx:\nvar gPacketCounter = 0;"));
+  label->setToolTip(
+      tr("Declare global JavaScript variables\n\nEx:\nvar gPacketCounter = 0;\n\n"
+         "When the ScriptWorkers tuning setting is above 0, route scripts run on worker threads.\n"
+         "Each worker has its own JavaScript engine with its own copy of these globals,\n"
+         "so changes made by a route script are only seen by routes on the same worker,\n"
+         "and script output is sent after the script finishes rather than in packet order."));
   grid->addWidget(label, row, 0, Qt::AlignTop);
   m_Script = new ScriptEdit(base);
   m_Script->setToolTip(label->toolTip());
@@ -2441,7 +2463,9 @@ QString RoutingWidget::GetHelpText(Col col, Protocol inProtocol, Protocol outPro
       {
         text =
             tr("Only route received OSC commands with this specific OSC command path\n"
-               "(use * for wildcard matching, ex: /eos/out/event/*)\n\n"
+               "(use * for wildcard matching, ex: /eos/out/event/*)\n"
+               "Paths with * also accept ? for any character, [abc] for any listed character\n"
+               "and {a,bc} for any listed string, ex: /eos/out/{cue,event}/*\n\n"
                "Leave blank to route received packets with any OSC command path (or non-OSC packets)");
       }
 
@@ -2464,7 +2488,7 @@ QString RoutingWidget::GetHelpText(Col col, Protocol inProtocol, Protocol outPro
 
         text +=
             tr("Incoming ArtNet:\n"
-               "  Port is the ArtNet universe\n"
+               "  Port is the ArtNet port address 0-32767 (Net * 256 + Sub-Net * 16 + Universe)\n"
                "  Path is not used"
                "  Use %1 - %512 to reference the universe levels in Outgoing path");
       }
@@ -2544,6 +2568,7 @@ QString RoutingWidget::GetHelpText(Col col, Protocol inProtocol, Protocol outPro
         {
           text =
               tr("Route recevied packets to this outgoing ArtNet universe\n"
+                 "Port address 0-32767 (Net * 256 + Sub-Net * 16 + Universe)\n"
                  "\n"
                  "Leave blank to route packets to the same universe/port they were received on");
         }
@@ -2675,7 +2700,10 @@ QString RoutingWidget::GetHelpText(Col col, Protocol inProtocol, Protocol outPro
                "Ex: OSC to PSN\n"
                "Input:  /hoist/xyz, 10(f), 20(f), 30(f)\n"
                "Path:   /psn/1/pos=%3,%4,%5\n"
-               "Output: PSN packet: tracker id 1, pos(10, 20, 30)");
+               "Output: PSN packet: tracker id 1, pos(10, 20, 30)\n"
+               "\n"
+               "Outgoing PSN keeps the last values of every tracker sent to a destination,\n"
+               "and sends them all together, one frame per tick while they change");
       }
 
       if (all || inProtocol == Protocol::kMIDI || outProtocol == Protocol::kMIDI)
@@ -3037,6 +3065,7 @@ bool MainWindow::BuildRoutes()
 
   Router::Settings settings;
   m_SettingsWidget->SaveSettings(settings);
+  LoadTuningSettings(settings);
 
   // Update web server with configuration
   if (m_WebServer)
@@ -3190,6 +3219,61 @@ void MainWindow::RestoreLastFile()
     onStartClicked(false);
 }
 
+void MainWindow::LoadTuningSettings(Router::Settings& settings)
+{
+  settings.polling = (m_Settings.value(SETTING_ROUTER_POLLING, 0).toInt() != 0);
+  m_Settings.setValue(SETTING_ROUTER_POLLING, static_cast<int>(settings.polling ? 1 : 0));
+
+  settings.latencyStats = (m_Settings.value(SETTING_ROUTER_LATENCY_STATS, 0).toInt() != 0);
+  m_Settings.setValue(SETTING_ROUTER_LATENCY_STATS, static_cast<int>(settings.latencyStats ? 1 : 0));
+
+  settings.udpBatchRecv = (m_Settings.value(SETTING_UDP_BATCH_RECV, 1).toInt() != 0);
+  m_Settings.setValue(SETTING_UDP_BATCH_RECV, static_cast<int>(settings.udpBatchRecv ? 1 : 0));
+
+  settings.udpRecvBufferSize = static_cast<unsigned int>(qMax(0, m_Settings.value(SETTING_UDP_RECV_BUFFER_SIZE, 0).toInt()));
+  m_Settings.setValue(SETTING_UDP_RECV_BUFFER_SIZE, static_cast<int>(settings.udpRecvBufferSize));
+
+  settings.udpBatchSend = (m_Settings.value(SETTING_UDP_BATCH_SEND, 1).toInt() != 0);
+  m_Settings.setValue(SETTING_UDP_BATCH_SEND, static_cast<int>(settings.udpBatchSend ? 1 : 0));
+
+  settings.artNetSync = (m_Settings.value(SETTING_ARTNET_SYNC, 0).toInt() != 0);
+  m_Settings.setValue(SETTING_ARTNET_SYNC, static_cast<int>(settings.artNetSync ? 1 : 0));
+
+  settings.artNetUnicast = (m_Settings.value(SETTING_ARTNET_UNICAST, 0).toInt() != 0);
+  m_Settings.setValue(SETTING_ARTNET_UNICAST, static_cast<int>(settings.artNetUnicast ? 1 : 0));
+
+  settings.psnBundle = (m_Settings.value(SETTING_PSN_BUNDLE, 0).toInt() != 0);
+  m_Settings.setValue(SETTING_PSN_BUNDLE, static_cast<int>(settings.psnBundle ? 1 : 0));
+
+  settings.psnTrackerMin = static_cast<unsigned int>(qBound(0, m_Settings.value(SETTING_PSN_TRACKER_MIN, 0).toInt(), 0xffff));
+  m_Settings.setValue(SETTING_PSN_TRACKER_MIN, static_cast<int>(settings.psnTrackerMin));
+
+  settings.psnTrackerMax = static_cast<unsigned int>(qBound(0, m_Settings.value(SETTING_PSN_TRACKER_MAX, 0xffff).toInt(), 0xffff));
+  m_Settings.setValue(SETTING_PSN_TRACKER_MAX, static_cast<int>(settings.psnTrackerMax));
+
+  settings.psnOutputRate = static_cast<unsigned int>(qBound(1, m_Settings.value(SETTING_PSN_OUTPUT_RATE, 60).toInt(), 1000));
+  m_Settings.setValue(SETTING_PSN_OUTPUT_RATE, static_cast<int>(settings.psnOutputRate));
+
+  // 0 for off, 1472 keeps bundles within one ethernet frame, capped at the largest IPv4 UDP payload
+  settings.udpBundleSize = static_cast<unsigned int>(qBound(0, m_Settings.value(SETTING_UDP_BUNDLE_SIZE, 0).toInt(), 65507));
+  m_Settings.setValue(SETTING_UDP_BUNDLE_SIZE, static_cast<int>(settings.udpBundleSize));
+
+  settings.udpInReactors = static_cast<unsigned int>(qBound(0, m_Settings.value(SETTING_UDP_IN_REACTORS, 0).toInt(), 64));
+  m_Settings.setValue(SETTING_UDP_IN_REACTORS, static_cast<int>(settings.udpInReactors));
+
+  settings.udpInReactorPinned = (m_Settings.value(SETTING_UDP_IN_REACTOR_PINNED, 0).toInt() != 0);
+  m_Settings.setValue(SETTING_UDP_IN_REACTOR_PINNED, static_cast<int>(settings.udpInReactorPinned ? 1 : 0));
+
+  settings.routerShards = static_cast<unsigned int>(qBound(0, m_Settings.value(SETTING_ROUTER_SHARDS, 0).toInt(), 64));
+  m_Settings.setValue(SETTING_ROUTER_SHARDS, static_cast<int>(settings.routerShards));
+
+  settings.scriptWorkers = static_cast<unsigned int>(qBound(0, m_Settings.value(SETTING_SCRIPT_WORKERS, 0).toInt(), 64));
+  m_Settings.setValue(SETTING_SCRIPT_WORKERS, static_cast<int>(settings.scriptWorkers));
+
+  settings.scriptTimeoutMS = static_cast<unsigned int>(qBound(0, m_Settings.value(SETTING_SCRIPT_TIMEOUT, 100).toInt(), 60000));
+  m_Settings.setValue(SETTING_SCRIPT_TIMEOUT, static_cast<int>(settings.scriptTimeoutMS));
+}
+
 void MainWindow::SyncRouterThread(bool logsOnly)
 {
   if (m_RouterThread)
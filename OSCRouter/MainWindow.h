@@ -630,6 +630,7 @@ private:
   void InitLogFile();
   void ShutdownLogFile();
   void SyncRouterThread(bool logsOnly);
+  void LoadTuningSettings(Router::Settings& settings);
   bool Load(const QString& path);
   bool Save(const QString& path);
   bool ResolveUnsaved();
@@ -20,13 +20,171 @@
 
 #include "NetworkUtils.h"
 
+#include <cstdint>
+#include <cstring>
+
 // must be last include
 #include "LeakWatcher.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// lock free bounded MPMC free lists of packet buffers, one per power of 2 size class
+//
+// allocated on receive threads, released on the router or out threads, so every
+// size class is a ring of sequenced cells (D. Vyukov) rather than a locked stack
+class EosPacketPool
+{
+public:
+  enum EnumConstants
+  {
+    MIN_SIZE_SHIFT = 6,       // 64 bytes
+    SIZE_CLASS_COUNT = 9,     // ...16k, larger packets use the heap directly
+    MAX_FREE_BUFFERS = 1024,  // per size class, extra buffers go back to the heap
+    INVALID_SIZE_CLASS = -1
+  };
+
+  EosPacketPool()
+  {
+    for (int i = 0; i < SIZE_CLASS_COUNT; ++i)
+    {
+      sFreeList &freeList = m_FreeLists[i];
+      for (size_t j = 0; j < MAX_FREE_BUFFERS; ++j)
+        freeList.cells[j].seq.store(j, std::memory_order_relaxed);
+      freeList.pushPos.store(0, std::memory_order_relaxed);
+      freeList.popPos.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  static EosPacketPool &Get()
+  {
+    // never destroyed, packets held by other statics or late threads may be freed after exit() runs destructors
+    static EosPacketPool *pool = new EosPacketPool();
+    return *pool;
+  }
+
+  EosPacket::sBuffer *Alloc(int size)
+  {
+    int sizeClass = GetSizeClass(size);
+    EosPacket::sBuffer *buffer = (sizeClass == INVALID_SIZE_CLASS) ? 0 : Pop(sizeClass);
+    if (!buffer)
+    {
+      buffer = new EosPacket::sBuffer;
+      buffer->sizeClass = sizeClass;
+      buffer->data = new char[(sizeClass == INVALID_SIZE_CLASS) ? size : (1 << (sizeClass + MIN_SIZE_SHIFT))];
+    }
+
+    buffer->refs.store(1, std::memory_order_relaxed);
+    return buffer;
+  }
+
+  void Free(EosPacket::sBuffer *buffer)
+  {
+    if (buffer->sizeClass == INVALID_SIZE_CLASS || !Push(buffer->sizeClass, buffer))
+      Delete(buffer);
+  }
+
+private:
+  struct sCell
+  {
+    std::atomic<size_t> seq;
+    EosPacket::sBuffer *buffer;
+  };
+
+  struct sFreeList
+  {
+    alignas(64) std::atomic<size_t> pushPos;
+    alignas(64) std::atomic<size_t> popPos;
+    sCell cells[MAX_FREE_BUFFERS];
+  };
+
+  sFreeList m_FreeLists[SIZE_CLASS_COUNT];
+
+  static int GetSizeClass(int size)
+  {
+    for (int i = 0; i < SIZE_CLASS_COUNT; ++i)
+    {
+      if (size <= (1 << (i + MIN_SIZE_SHIFT)))
+        return i;
+    }
+
+    return INVALID_SIZE_CLASS;
+  }
+
+  static void Delete(EosPacket::sBuffer *buffer)
+  {
+    delete[] buffer->data;
+    delete buffer;
+  }
+
+  bool Push(int sizeClass, EosPacket::sBuffer *buffer)
+  {
+    sFreeList &freeList = m_FreeLists[sizeClass];
+    size_t pos = freeList.pushPos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      sCell &cell = freeList.cells[pos % MAX_FREE_BUFFERS];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (freeList.pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          cell.buffer = buffer;
+          cell.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;  // full
+      else
+        pos = freeList.pushPos.load(std::memory_order_relaxed);
+    }
+  }
+
+  EosPacket::sBuffer *Pop(int sizeClass)
+  {
+    sFreeList &freeList = m_FreeLists[sizeClass];
+    size_t pos = freeList.popPos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      sCell &cell = freeList.cells[pos % MAX_FREE_BUFFERS];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0)
+      {
+        if (freeList.popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          EosPacket::sBuffer *buffer = cell.buffer;
+          cell.seq.store(pos + MAX_FREE_BUFFERS, std::memory_order_release);
+          return buffer;
+        }
+      }
+      else if (diff < 0)
+        return 0;  // empty
+      else
+        pos = freeList.popPos.load(std::memory_order_relaxed);
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+EosPacket::sBuffer *EosPacket::AllocBuffer(int size)
+{
+  return EosPacketPool::Get().Alloc(size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EosPacket::FreeBuffer(sBuffer *buffer)
+{
+  EosPacketPool::Get().Free(buffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 EosPacket::EosPacket()
-  : m_Data(0)
+  : m_Buffer(0)
   , m_Size(0)
 {
 }
@@ -34,28 +192,34 @@ EosPacket::EosPacket()
 ////////////////////////////////////////////////////////////////////////////////
 
 EosPacket::EosPacket(const EosPacket &other)
-  : m_Data(0)
-  , m_Size(0)
+  : m_Buffer(other.m_Buffer)
+  , m_Size(other.m_Size)
 {
-  if (other.m_Data && other.m_Size > 0)
-  {
-    m_Size = other.m_Size;
-    m_Data = new char[m_Size];
-    memcpy(m_Data, other.m_Data, m_Size);  // TODO: optmize, too many needless copies of packet data in queues
-  }
+  if (m_Buffer)
+    m_Buffer->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+EosPacket::EosPacket(EosPacket &&other) noexcept
+  : m_Buffer(other.m_Buffer)
+  , m_Size(other.m_Size)
+{
+  other.m_Buffer = 0;
+  other.m_Size = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 EosPacket::EosPacket(const char *data, int size)
-  : m_Data(0)
+  : m_Buffer(0)
   , m_Size(0)
 {
   if (data && size > 0)
   {
     m_Size = size;
-    m_Data = new char[m_Size];
-    memcpy(m_Data, data, m_Size);
+    m_Buffer = AllocBuffer(m_Size);
+    memcpy(m_Buffer->data, data, m_Size);
   }
 }
 
@@ -63,22 +227,30 @@ EosPacket::EosPacket(const char *data, int size)
 
 EosPacket &EosPacket::operator=(const EosPacket &other)
 {
-  if (&other != this)
+  if (other.m_Buffer != m_Buffer)
   {
-    if (m_Data)
-    {
-      delete[] m_Data;
-      m_Data = 0;
-    }
+    if (other.m_Buffer)
+      other.m_Buffer->refs.fetch_add(1, std::memory_order_relaxed);
 
-    m_Size = 0;
+    Clear();
+    m_Buffer = other.m_Buffer;
+  }
 
-    if (other.m_Data && other.m_Size > 0)
-    {
-      m_Size = other.m_Size;
-      m_Data = new char[m_Size];
-      memcpy(m_Data, other.m_Data, m_Size);
-    }
+  m_Size = other.m_Size;
+  return (*this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+EosPacket &EosPacket::operator=(EosPacket &&other) noexcept
+{
+  if (&other != this)
+  {
+    Clear();
+    m_Buffer = other.m_Buffer;
+    m_Size = other.m_Size;
+    other.m_Buffer = 0;
+    other.m_Size = 0;
   }
 
   return (*this);
@@ -88,11 +260,46 @@ EosPacket &EosPacket::operator=(const EosPacket &other)
 
 EosPacket::~EosPacket()
 {
-  if (m_Data)
+  Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+char *EosPacket::GetData()
+{
+  // copy on write
+  if (IsShared())
   {
-    delete[] m_Data;
-    m_Data = 0;
+    int size = m_Size;
+    sBuffer *buffer = AllocBuffer(size);
+    memcpy(buffer->data, m_Buffer->data, size);
+    Clear();
+    m_Buffer = buffer;
+    m_Size = size;
   }
+
+  return (m_Buffer ? m_Buffer->data : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool EosPacket::IsShared() const
+{
+  return (m_Buffer && m_Buffer->refs.load(std::memory_order_acquire) > 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EosPacket::Clear()
+{
+  if (m_Buffer)
+  {
+    if (m_Buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      FreeBuffer(m_Buffer);
+    m_Buffer = 0;
+  }
+
+  m_Size = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -28,9 +28,14 @@
 
 #include <vector>
 #include <optional>
+#include <atomic>
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// packet data is reference counted and shared between copies, so fanning out to
+// several queues does not copy it, writable access via GetData() detaches first
+//
+// buffers are recycled through per size class free lists rather than the heap
 class EosPacket
 {
 public:
@@ -38,21 +43,32 @@ public:
 
   EosPacket();
   EosPacket(const EosPacket &other);
+  EosPacket(EosPacket &&other) noexcept;
   EosPacket(const char *data, int size);
   EosPacket &operator=(const EosPacket &other);
+  EosPacket &operator=(EosPacket &&other) noexcept;
   virtual ~EosPacket();
-  char *GetData() { return m_Data; }
-  const char *GetDataConst() const { return m_Data; }
+  char *GetData();
+  const char *GetDataConst() const { return m_Buffer ? m_Buffer->data : 0; }
   int GetSize() const { return m_Size; }
-  void Release()
-  {
-    m_Data = 0;
-    m_Size = 0;
-  }
+  bool IsShared() const;
+  void Clear();  // drops this reference, the buffer goes back to the pool with the last one
 
 private:
-  char *m_Data;
+  friend class EosPacketPool;
+
+  struct sBuffer
+  {
+    std::atomic<int> refs;
+    int sizeClass;
+    char *data;
+  };
+
+  sBuffer *m_Buffer;
   int m_Size;
+
+  static sBuffer *AllocBuffer(int size);
+  static void FreeBuffer(sBuffer *buffer);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
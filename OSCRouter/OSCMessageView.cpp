@@ -0,0 +1,185 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "OSCMessageView.h"
+
+#include <cstring>
+#include <limits>
+
+// must be last include
+#include "LeakWatcher.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+OSCMessageView::~OSCMessageView()
+{
+  ReleaseArgs();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCMessageView::Clear()
+{
+  m_Path.clear();
+  m_Segments.clear();
+  ReleaseArgs();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCMessageView::ReleaseArgs()
+{
+  if (m_OwnsArgs && m_Args)
+    delete[] m_Args;
+
+  m_Args = nullptr;
+  m_ArgsCount = 0;
+  m_OwnsArgs = false;
+  m_Packet = EosPacket();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCMessageView::SetPath(const char *path, size_t len)
+{
+  m_Path.assign(path, len);
+  m_Segments.clear();
+
+  if (m_Path.empty())
+    return;
+
+  size_t start = (HasLeadingSlash() ? 1 : 0);
+  for (;;)
+  {
+    size_t end = m_Path.find('/', start);
+    if (end == std::string::npos)
+      end = m_Path.size();
+
+    sSegment segment;
+    segment.offset = static_cast<uint32_t>(start);
+    segment.length = static_cast<uint32_t>(end - start);
+    m_Segments.push_back(segment);
+
+    if (end == m_Path.size())
+      break;
+
+    start = (end + 1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCMessageView::SetArgs(OSCArgument *args, size_t argsCount)
+{
+  ReleaseArgs();
+  m_Args = args;
+  m_ArgsCount = (args ? argsCount : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCMessageView::Parse(const EosPacket &packet)
+{
+  Clear();
+
+  const char *data = packet.GetDataConst();
+  size_t size = ((packet.GetSize() > 0) ? static_cast<size_t>(packet.GetSize()) : 0);
+  if (!data || size == 0)
+    return false;
+
+  const void *end = memchr(data, 0, size);
+  if (!end)
+    return false;
+
+  SetPath(data, static_cast<size_t>(static_cast<const char *>(end) - data));
+
+  // args point into the packet, so keep a reference to it
+  m_Packet = packet;
+  size_t argsCount = 0xffffffff;
+  m_Args = OSCArgument::GetArgs(m_Packet.GetData(), size, argsCount);
+  m_ArgsCount = (m_Args ? argsCount : 0);
+  m_OwnsArgs = true;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCMessageView::SegmentEquals(size_t index, const char *str) const
+{
+  if (index >= m_Segments.size())
+    return false;
+
+  const sSegment &segment = m_Segments[index];
+  return (strlen(str) == segment.length && memcmp(&m_Path[segment.offset], str, segment.length) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCMessageView::GetSegmentInt(size_t index, int &n) const
+{
+  if (index >= m_Segments.size())
+    return false;
+
+  const sSegment &segment = m_Segments[index];
+  const char *str = &m_Path[segment.offset];
+  size_t len = segment.length;
+
+  size_t i = 0;
+  bool negative = false;
+  if (i < len && (str[i] == '-' || str[i] == '+'))
+  {
+    negative = (str[i] == '-');
+    ++i;
+  }
+
+  if (i >= len)
+    return false;
+
+  long long value = 0;
+  for (; i < len; ++i)
+  {
+    if (str[i] < '0' || str[i] > '9')
+      return false;
+
+    value = (value * 10) + (str[i] - '0');
+    if (value > (static_cast<long long>(std::numeric_limits<int>::max()) + 1))
+      return false;
+  }
+
+  if (negative)
+    value = -value;
+
+  if (value > std::numeric_limits<int>::max())
+    return false;
+
+  n = static_cast<int>(value);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string OSCMessageView::GetSegment(size_t index) const
+{
+  if (index >= m_Segments.size())
+    return std::string();
+
+  const sSegment &segment = m_Segments[index];
+  return m_Path.substr(segment.offset, segment.length);
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef OSC_MESSAGE_VIEW_H
+#define OSC_MESSAGE_VIEW_H
+
+#ifndef NETWORK_UTILS_H
+#include "NetworkUtils.h"
+#endif
+
+#ifndef OSC_PARSER_H
+#include "OSCParser.h"
+#endif
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// one OSC message as the output encoders read it: UTF-8 path, offsets of its '/' separated
+// segments, and parsed arguments
+//
+// DMX, MIDI and PSN encoders read it directly, so the incoming packet's parsed arguments are
+// shared instead of being serialized and parsed again for each destination
+class OSCMessageView
+{
+public:
+  OSCMessageView() = default;
+  OSCMessageView(const OSCMessageView &) = delete;
+  OSCMessageView &operator=(const OSCMessageView &) = delete;
+  virtual ~OSCMessageView();
+
+  virtual void Clear();
+  virtual void SetPath(const char *path, size_t len);
+  virtual void SetArgs(OSCArgument *args, size_t argsCount);  // not owned, must outlive this view
+  virtual bool Parse(const EosPacket &packet);
+
+  bool empty() const { return m_Path.empty(); }
+  const std::string &GetPath() const { return m_Path; }
+  bool HasLeadingSlash() const { return (!m_Path.empty() && m_Path[0] == '/'); }
+
+  // segments follow the leading '/', empty segments are kept
+  size_t GetSegmentCount() const { return m_Segments.size(); }
+  virtual bool SegmentEquals(size_t index, const char *str) const;
+  virtual bool GetSegmentInt(size_t index, int &n) const;
+  virtual std::string GetSegment(size_t index) const;
+
+  OSCArgument *GetArgs() const { return m_Args; }
+  size_t GetArgsCount() const { return m_ArgsCount; }
+
+private:
+  struct sSegment
+  {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+  };
+
+  typedef std::vector<sSegment> SEGMENTS;
+
+  std::string m_Path;
+  SEGMENTS m_Segments;
+  OSCArgument *m_Args = nullptr;
+  size_t m_ArgsCount = 0;
+  bool m_OwnsArgs = false;
+  EosPacket m_Packet;  // backs owned args
+
+  virtual void ReleaseArgs();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
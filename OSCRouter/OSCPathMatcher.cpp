@@ -0,0 +1,417 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "OSCPathMatcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+// must be last include
+#include "LeakWatcher.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCPathPattern::IsPattern(const std::string &path)
+{
+  // only paths that were already wildcards, so saved literal paths containing ?[]{} keep matching exactly
+  return (path.find('*') != std::string::npos);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCPathPattern::AddLiteral(const char *data, size_t len)
+{
+  if (len == 0)
+    return;
+
+  // extend previous literal if it is the last text added
+  if (!m_Tokens.empty())
+  {
+    sToken &prev = m_Tokens.back();
+    if (prev.op == EnumOp::kLiteral && (prev.index + prev.count) == m_Text.size())
+    {
+      m_Text.append(data, len);
+      prev.count += static_cast<uint32_t>(len);
+      return;
+    }
+  }
+
+  sToken token;
+  token.op = EnumOp::kLiteral;
+  token.index = static_cast<uint32_t>(m_Text.size());
+  token.count = static_cast<uint32_t>(len);
+  m_Text.append(data, len);
+  m_Tokens.push_back(token);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCPathPattern::Compile(const std::string &pattern)
+{
+  m_Prefix.clear();
+  m_Text.clear();
+  m_Tokens.clear();
+  m_CharSets.clear();
+  m_Alternatives.clear();
+
+  size_t i = 0;
+  while (i < pattern.size())
+  {
+    char c = pattern[i];
+    if (c == '*')
+    {
+      // consecutive stars are the same as one
+      if (m_Tokens.empty() || m_Tokens.back().op != EnumOp::kAnySequence)
+      {
+        sToken token;
+        token.op = EnumOp::kAnySequence;
+        m_Tokens.push_back(token);
+      }
+      ++i;
+    }
+    else if (c == '?')
+    {
+      sToken token;
+      token.op = EnumOp::kAnyChar;
+      m_Tokens.push_back(token);
+      ++i;
+    }
+    else if (c == '[')
+    {
+      size_t start = (i + 1);
+      bool negate = (start < pattern.size() && pattern[start] == '!');
+      if (negate)
+        ++start;
+
+      // a ']' directly after the opening bracket is a member, not the end
+      size_t end = pattern.find(']', (start < pattern.size() && pattern[start] == ']') ? (start + 1) : start);
+      if (end == std::string::npos)
+        return false;  // unbalanced '['
+
+      CHAR_SET charSet;
+      charSet.fill(0);
+      for (size_t j = start; j < end; ++j)
+      {
+        unsigned char first = static_cast<unsigned char>(pattern[j]);
+        unsigned char last = first;
+        if ((j + 2) < end && pattern[j + 1] == '-')
+        {
+          last = static_cast<unsigned char>(pattern[j + 2]);
+          j += 2;
+        }
+
+        if (last < first)
+          std::swap(first, last);
+
+        for (unsigned int n = first; n <= last; ++n)
+          charSet[n >> 6] |= (static_cast<uint64_t>(1) << (n & 63));
+      }
+
+      if (negate)
+      {
+        for (size_t j = 0; j < charSet.size(); ++j)
+          charSet[j] = ~charSet[j];
+      }
+
+      sToken token;
+      token.op = EnumOp::kCharSet;
+      token.index = static_cast<uint32_t>(m_CharSets.size());
+      m_CharSets.push_back(charSet);
+      m_Tokens.push_back(token);
+      i = (end + 1);
+    }
+    else if (c == '{')
+    {
+      size_t end = pattern.find('}', i + 1);
+      if (end == std::string::npos)
+        return false;  // unbalanced '{'
+
+      // alternatives are plain strings, no nesting or wildcards
+      size_t special = pattern.find_first_of("*?[]{", i + 1);
+      if (special != std::string::npos && special < end)
+        return false;
+
+      sToken token;
+      token.op = EnumOp::kAlternatives;
+      token.index = static_cast<uint32_t>(m_Alternatives.size());
+
+      size_t start = (i + 1);
+      for (;;)
+      {
+        size_t comma = pattern.find(',', start);
+        if (comma == std::string::npos || comma > end)
+          comma = end;
+
+        sSpan alternative;
+        alternative.offset = static_cast<uint32_t>(m_Text.size());
+        alternative.length = static_cast<uint32_t>(comma - start);
+        m_Text.append(pattern, start, comma - start);
+        m_Alternatives.push_back(alternative);
+        ++token.count;
+
+        if (comma == end)
+          break;
+
+        start = (comma + 1);
+      }
+
+      m_Tokens.push_back(token);
+      i = (end + 1);
+    }
+    else
+    {
+      // a ']' or '}' without its opening bracket is literal, as it was for the previous wildcard routes
+      size_t end = pattern.find_first_of("*?[{", i);
+      if (end == std::string::npos)
+        end = pattern.size();
+      AddLiteral(&pattern[i], end - i);
+      i = end;
+    }
+  }
+
+  if (!m_Tokens.empty() && m_Tokens.front().op == EnumOp::kLiteral)
+    m_Prefix = m_Text.substr(m_Tokens.front().index, m_Tokens.front().count);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCPathPattern::Match(const char *path, size_t len) const
+{
+  if (len < m_Prefix.size() || memcmp(path, m_Prefix.data(), m_Prefix.size()) != 0)
+    return false;
+
+  return MatchAfterPrefix(path, len);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCPathPattern::MatchAfterPrefix(const char *path, size_t len) const
+{
+  return MatchTokens(m_Prefix.empty() ? 0 : 1, path, len, m_Prefix.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCPathPattern::SkipToLiteral(size_t tokenIndex, const char *path, size_t len, size_t &pos) const
+{
+  // only try positions where the literal following a star occurs
+  const sToken &token = m_Tokens[tokenIndex];
+  if (token.op != EnumOp::kLiteral)
+    return true;
+
+  if ((len - pos) < token.count)
+    return false;
+
+  const void *found = memchr(&path[pos], m_Text[token.index], (len - pos) - token.count + 1);
+  if (!found)
+    return false;
+
+  pos = static_cast<size_t>(static_cast<const char *>(found) - path);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCPathPattern::MatchTokens(size_t tokenIndex, const char *path, size_t len, size_t pos) const
+{
+  // two pointer greedy match: on a mismatch only the most recent star grows, by one character
+  // everything between two stars has a fixed length, so earlier stars never need revisiting
+  bool star = false;
+  size_t starToken = 0;
+  size_t starPos = 0;
+
+  for (;;)
+  {
+    bool matched = false;
+    if (tokenIndex < m_Tokens.size())
+    {
+      const sToken &token = m_Tokens[tokenIndex];
+      switch (token.op)
+      {
+        case EnumOp::kLiteral:
+          matched = ((len - pos) >= token.count && memcmp(&path[pos], &m_Text[token.index], token.count) == 0);
+          if (matched)
+            pos += token.count;
+          break;
+
+        case EnumOp::kAnyChar:
+          matched = (pos < len);
+          if (matched)
+            ++pos;
+          break;
+
+        case EnumOp::kCharSet:
+          if (pos < len)
+          {
+            unsigned char c = static_cast<unsigned char>(path[pos]);
+            matched = ((m_CharSets[token.index][c >> 6] & (static_cast<uint64_t>(1) << (c & 63))) != 0);
+            if (matched)
+              ++pos;
+          }
+          break;
+
+        case EnumOp::kAnySequence:
+          if ((tokenIndex + 1) >= m_Tokens.size())
+            return true;  // trailing star matches the rest
+
+          // start out as short as possible, grown below on each mismatch
+          star = true;
+          starToken = (tokenIndex + 1);
+          starPos = pos;
+          if (!SkipToLiteral(starToken, path, len, starPos))
+            return false;
+          pos = starPos;
+          matched = true;
+          break;
+
+        case EnumOp::kAlternatives:
+          // alternatives differ in length, so each one checks the rest of the pattern itself
+          for (uint32_t i = 0; i < token.count; ++i)
+          {
+            const sSpan &alternative = m_Alternatives[token.index + i];
+            if ((len - pos) >= alternative.length && memcmp(&path[pos], &m_Text[alternative.offset], alternative.length) == 0 &&
+                MatchTokens(tokenIndex + 1, path, len, pos + alternative.length))
+            {
+              return true;
+            }
+          }
+          break;
+      }
+    }
+    else if (pos == len)
+    {
+      return true;
+    }
+
+    if (matched)
+    {
+      ++tokenIndex;
+      continue;
+    }
+
+    if (!star || starPos >= len)
+      return false;
+
+    ++starPos;
+    if (!SkipToLiteral(starToken, path, len, starPos))
+      return false;
+
+    tokenIndex = starToken;
+    pos = starPos;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+OSCPathMatcher::OSCPathMatcher()
+{
+  Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCPathMatcher::Clear()
+{
+  m_Nodes.clear();
+  m_Nodes.resize(1);  // root
+  m_Entries.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCPathMatcher::Add(const std::string &pattern, ID id)
+{
+  sEntry entry;
+  if (!entry.pattern.Compile(pattern))
+    return false;
+
+  entry.id = id;
+
+  // walk/extend the prefix trie
+  uint32_t nodeIndex = 0;
+  const std::string &prefix = entry.pattern.GetPrefix();
+  for (size_t i = 0; i < prefix.size(); ++i)
+  {
+    uint32_t childIndex = 0;
+    std::vector<std::pair<char, uint32_t>> &children = m_Nodes[nodeIndex].children;
+    for (size_t j = 0; j < children.size(); ++j)
+    {
+      if (children[j].first == prefix[i])
+      {
+        childIndex = children[j].second;
+        break;
+      }
+    }
+
+    if (childIndex == 0)
+    {
+      childIndex = static_cast<uint32_t>(m_Nodes.size());
+      m_Nodes[nodeIndex].children.push_back(std::make_pair(prefix[i], childIndex));
+      m_Nodes.push_back(sNode());
+    }
+
+    nodeIndex = childIndex;
+  }
+
+  m_Nodes[nodeIndex].entries.push_back(static_cast<uint32_t>(m_Entries.size()));
+  m_Entries.push_back(entry);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCPathMatcher::Match(const char *path, size_t len, IDS &ids) const
+{
+  size_t first = ids.size();
+
+  uint32_t nodeIndex = 0;
+  for (size_t i = 0;; ++i)
+  {
+    const sNode &node = m_Nodes[nodeIndex];
+    for (size_t j = 0; j < node.entries.size(); ++j)
+    {
+      const sEntry &entry = m_Entries[node.entries[j]];
+      if (entry.pattern.MatchAfterPrefix(path, len))
+        ids.push_back(entry.id);
+    }
+
+    if (i >= len)
+      break;
+
+    nodeIndex = 0;
+    for (size_t j = 0; j < node.children.size(); ++j)
+    {
+      if (node.children[j].first == path[i])
+      {
+        nodeIndex = node.children[j].second;
+        break;
+      }
+    }
+
+    if (nodeIndex == 0)
+      break;
+  }
+
+  // results in id order, independent of prefix layout
+  if ((ids.size() - first) > 1)
+    std::sort(ids.begin() + first, ids.end());
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef OSC_PATH_MATCHER_H
+#define OSC_PATH_MATCHER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// OSC 1.0 address pattern, compiled once and matched against UTF-8 paths
+//
+// *      any sequence of characters, including '/' (same as the previous wildcard routes)
+// ?      any single character
+// [abc]  any character in the set, ranges allowed: [a-z], negated with [!abc]
+// {a,bc} any of the comma separated strings
+//
+// route paths are only treated as patterns when they contain '*' (see IsPattern), so the rest
+// of the syntax applies within those, Compile fails on an unbalanced '[' or '{' or wildcards inside '{}'
+class OSCPathPattern
+{
+public:
+  OSCPathPattern() = default;
+
+  virtual bool Compile(const std::string &pattern);
+  virtual bool Match(const char *path, size_t len) const;
+  virtual bool MatchAfterPrefix(const char *path, size_t len) const;
+  const std::string &GetPrefix() const { return m_Prefix; }
+
+  static bool IsPattern(const std::string &path);
+
+private:
+  enum class EnumOp : uint8_t
+  {
+    kLiteral = 0,
+    kAnyChar,
+    kAnySequence,
+    kCharSet,
+    kAlternatives
+  };
+
+  struct sToken
+  {
+    EnumOp op = EnumOp::kLiteral;
+    uint32_t index = 0;  // literal offset, char set index, or first alternative
+    uint32_t count = 0;  // literal length, or alternative count
+  };
+
+  struct sSpan
+  {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+  };
+
+  typedef std::array<uint64_t, 4> CHAR_SET;
+
+  std::string m_Prefix;
+  std::string m_Text;
+  std::vector<sToken> m_Tokens;
+  std::vector<CHAR_SET> m_CharSets;
+  std::vector<sSpan> m_Alternatives;
+
+  virtual bool MatchTokens(size_t tokenIndex, const char *path, size_t len, size_t pos) const;
+  virtual bool SkipToLiteral(size_t tokenIndex, const char *path, size_t len, size_t &pos) const;
+  virtual void AddLiteral(const char *data, size_t len);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// set of patterns indexed by their literal prefix, so an incoming path is
+// walked once to find candidates and only those run the full pattern match
+class OSCPathMatcher
+{
+public:
+  typedef size_t ID;
+  typedef std::vector<ID> IDS;
+
+  OSCPathMatcher();
+
+  virtual void Clear();
+  virtual bool Add(const std::string &pattern, ID id);
+  virtual void Match(const char *path, size_t len, IDS &ids) const;
+  bool empty() const { return m_Entries.empty(); }
+
+private:
+  struct sNode
+  {
+    std::vector<std::pair<char, uint32_t>> children;
+    std::vector<uint32_t> entries;
+  };
+
+  struct sEntry
+  {
+    OSCPathPattern pattern;
+    ID id = 0;
+  };
+
+  std::vector<sNode> m_Nodes;
+  std::vector<sEntry> m_Entries;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
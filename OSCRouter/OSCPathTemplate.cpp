@@ -0,0 +1,149 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "OSCPathTemplate.h"
+
+#include <limits>
+
+// must be last include
+#include "LeakWatcher.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCPathTemplate::AddLiteral(const char *data, size_t len)
+{
+  if (len == 0)
+    return;
+
+  // extend previous literal if it is the last text added
+  if (!m_Tokens.empty())
+  {
+    sToken &prev = m_Tokens.back();
+    if (prev.type == EnumToken::kLiteral && (prev.offset + prev.length) == m_Text.size())
+    {
+      m_Text.append(data, len);
+      prev.length += static_cast<uint32_t>(len);
+      return;
+    }
+  }
+
+  sToken token;
+  token.type = EnumToken::kLiteral;
+  token.offset = static_cast<uint32_t>(m_Text.size());
+  token.length = static_cast<uint32_t>(len);
+  m_Text.append(data, len);
+  m_Tokens.push_back(token);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OSCPathTemplate::Compile(const std::string &path)
+{
+  m_Path = path;
+  m_Text.clear();
+  m_Tokens.clear();
+  m_HasReplacements = false;
+
+  // look for all instances of '%' followed by a number
+  size_t literalStart = 0;
+  size_t digitCount = 0;
+  for (size_t i = 0; i <= path.size(); ++i)
+  {
+    if (i < path.size() && path[i] >= '0' && path[i] <= '9')
+    {
+      ++digitCount;
+      continue;
+    }
+
+    if (digitCount == 0)
+      continue;
+
+    // is number preceeded by a '%', other than at the start of the path?
+    size_t count = digitCount;
+    digitCount = 0;
+    if ((i - count) < 2 || path[i - count - 1] != '%')
+      continue;
+
+    size_t percentIndex = (i - count - 1);
+    if (percentIndex > 1 && path[percentIndex - 1] == '%')
+    {
+      // %%xxx => %xxx
+      AddLiteral(&path[literalStart], percentIndex - literalStart);
+      literalStart = (percentIndex + 1);
+      continue;
+    }
+
+    AddLiteral(&path[literalStart], percentIndex - literalStart);
+    literalStart = i;
+
+    // out of range numbers are 0, same as QString::toInt
+    long long number = 0;
+    for (size_t j = (percentIndex + 1); j < i && number <= std::numeric_limits<int>::max(); ++j)
+      number = (number * 10) + (path[j] - '0');
+
+    sToken token;
+    token.type = EnumToken::kReplacement;
+    token.number = ((number <= std::numeric_limits<int>::max()) ? static_cast<int>(number) : 0);
+    m_Tokens.push_back(token);
+    m_HasReplacements = true;
+  }
+
+  if (literalStart < path.size())
+    AddLiteral(&path[literalStart], path.size() - literalStart);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t OSCPathTemplate::GetPartCount(const char *path, size_t len)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < len; ++i)
+  {
+    if (path[i] != '/' && (i == 0 || path[i - 1] == '/'))
+      ++count;
+  }
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool OSCPathTemplate::GetPart(const char *path, size_t len, size_t index, size_t &offset, size_t &partLen)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < len; ++i)
+  {
+    if (path[i] == '/' || (i != 0 && path[i - 1] != '/'))
+      continue;
+
+    if (count++ == index)
+    {
+      size_t end = i;
+      while (end < len && path[end] != '/')
+        ++end;
+
+      offset = i;
+      partLen = (end - i);
+      return true;
+    }
+  }
+
+  return false;
+}
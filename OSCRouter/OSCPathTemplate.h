@@ -0,0 +1,83 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef OSC_PATH_TEMPLATE_H
+#define OSC_PATH_TEMPLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// destination path with in-line replacements, compiled once when routes are built
+//
+// %1  => 1st source path part (or the whole path when it has no parts)
+// %N  => past the last part: a DMX slot for sACN/ArtNet input, otherwise an argument
+// %%1 => %1
+//
+// a '%' at the start of the path is never a replacement, and replaced text is not scanned again
+class OSCPathTemplate
+{
+public:
+  enum class EnumToken : uint8_t
+  {
+    kLiteral = 0,
+    kReplacement
+  };
+
+  struct sToken
+  {
+    EnumToken type = EnumToken::kLiteral;
+    uint32_t offset = 0;  // literal text
+    uint32_t length = 0;
+    int number = 0;  // replacement, as written after the '%'
+  };
+
+  typedef std::vector<sToken> TOKENS;
+
+  OSCPathTemplate() = default;
+
+  virtual void Compile(const std::string &path);
+  bool empty() const { return m_Path.empty(); }
+  bool HasReplacements() const { return m_HasReplacements; }
+  const std::string &GetPath() const { return m_Path; }
+  const std::string &GetLiteralText() const { return m_Text; }  // the whole result when there are no replacements
+  const TOKENS &GetTokens() const { return m_Tokens; }
+  const char *GetText(const sToken &token) const { return (m_Text.data() + token.offset); }
+
+  // source path parts split on '/', skipping empty parts
+  static size_t GetPartCount(const char *path, size_t len);
+  static bool GetPart(const char *path, size_t len, size_t index, size_t &offset, size_t &partLen);
+
+private:
+  std::string m_Path;
+  std::string m_Text;
+  TOKENS m_Tokens;
+  bool m_HasReplacements = false;
+
+  virtual void AddLiteral(const char *data, size_t len);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
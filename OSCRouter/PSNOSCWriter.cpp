@@ -0,0 +1,304 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "PSNOSCWriter.h"
+
+#include <algorithm>
+#include <cstring>
+
+// must be last include
+#include "LeakWatcher.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// "#bundle", then the immediate time tag
+static const char BUNDLE_HEADER[16] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void SetFloat3(PSNOSCWriter::EnumField id, const char *name, const psn::float3 &f3, PSNOSCWriter::sField &field)
+{
+  field.id = id;
+  field.name = name;
+  field.type = 'f';
+  field.count = 3;
+  field.f[0] = f3.x;
+  field.f[1] = f3.y;
+  field.f[2] = f3.z;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PSNOSCWriter::SetFilter(const std::vector<std::string> &paths, uint16_t minTracker, uint16_t maxTracker)
+{
+  m_MinTracker = minTracker;
+  m_MaxTracker = maxTracker;
+
+  m_Matcher.Clear();
+  m_FilterPaths = !paths.empty();
+  for (std::vector<std::string>::const_iterator i = paths.begin(); i != paths.end(); ++i)
+  {
+    if (i->empty())
+    {
+      m_FilterPaths = false;  // route without a path takes every message
+      break;
+    }
+
+    m_Matcher.Add(*i, 0);
+  }
+
+  // decide again on next sight of each tracker
+  for (TRACKERS::iterator i = m_Trackers.begin(); i != m_Trackers.end(); ++i)
+    i->second.fields = NO_FIELDS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PSNOSCWriter::Write(const psn::tracker_map &trackers, bool bundle)
+{
+  m_Size = 0;
+  m_Packets.clear();
+
+  if (bundle)
+    memcpy(Reserve(sizeof(BUNDLE_HEADER)), BUNDLE_HEADER, sizeof(BUNDLE_HEADER));
+
+  for (psn::tracker_map::const_iterator trackerIter = trackers.begin(); trackerIter != trackers.end(); ++trackerIter)
+  {
+    const psn::tracker &tracker = trackerIter->second;
+    uint16_t id = tracker.get_id();
+    if (id < m_MinTracker || id > m_MaxTracker)
+      continue;
+
+    TRACKERS::iterator cached = m_Trackers.find(id);
+    if (cached == m_Trackers.end())
+    {
+      cached = m_Trackers.insert(std::make_pair(id, sTracker())).first;
+      cached->second.prefix = ("/psn/" + std::to_string(id));
+    }
+    sTracker &cache = cached->second;
+
+    sField fields[FIELD_COUNT];
+    size_t fieldCount = 0;
+
+    if (tracker.is_pos_set())
+      SetFloat3(FIELD_POS, "/pos", tracker.get_pos(), fields[fieldCount++]);
+
+    if (tracker.is_speed_set())
+      SetFloat3(FIELD_SPEED, "/speed", tracker.get_speed(), fields[fieldCount++]);
+
+    if (tracker.is_ori_set())
+      SetFloat3(FIELD_ORIENTATION, "/orientation", tracker.get_ori(), fields[fieldCount++]);
+
+    if (tracker.is_accel_set())
+      SetFloat3(FIELD_ACCELERATION, "/acceleration", tracker.get_accel(), fields[fieldCount++]);
+
+    if (tracker.is_target_pos_set())
+      SetFloat3(FIELD_TARGET, "/target", tracker.get_target_pos(), fields[fieldCount++]);
+
+    if (tracker.is_status_set())
+    {
+      sField &field = fields[fieldCount++];
+      field.id = FIELD_STATUS;
+      field.name = "/status";
+      field.count = 1;
+      field.f[0] = tracker.get_status();
+
+      sField &timestamp = fields[fieldCount++];
+      timestamp.id = FIELD_TIMESTAMP;
+      timestamp.name = "/timestamp";
+      timestamp.type = 'h';
+      timestamp.count = 1;
+      timestamp.u = tracker.get_timestamp();
+    }
+
+    if (fieldCount == 0)
+      continue;
+
+    uint32_t present = 0;
+    for (size_t i = 0; i < fieldCount; ++i)
+      present |= (1u << fields[i].id);
+
+    if (present != cache.fields)
+    {
+      cache.fields = present;
+      cache.wanted = GetWanted(cache.prefix, fields, fieldCount);
+    }
+
+    for (size_t i = 0; i < fieldCount; ++i)
+    {
+      if ((cache.wanted & (1u << fields[i].id)) != 0)
+        WriteMessage(cache.prefix, &fields[i], 1, bundle);
+    }
+
+    if ((cache.wanted & WANT_COMBINED) != 0)
+      WriteMessage(cache.prefix, fields, fieldCount, bundle);
+  }
+
+  if (bundle && m_Size > sizeof(BUNDLE_HEADER))
+  {
+    sPacket packet;
+    packet.size = m_Size;
+    m_Packets.push_back(packet);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t PSNOSCWriter::GetWanted(const std::string &prefix, const sField *fields, size_t fieldCount)
+{
+  if (!m_FilterPaths)
+    return WANT_ALL;
+
+  uint32_t wanted = 0;
+  for (size_t i = 0; i < fieldCount; ++i)
+  {
+    if (IsRouted(prefix, &fields[i], 1))
+      wanted |= (1u << fields[i].id);
+  }
+
+  if (IsRouted(prefix, fields, fieldCount))
+    wanted |= WANT_COMBINED;
+
+  return wanted;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool PSNOSCWriter::IsRouted(const std::string &prefix, const sField *fields, size_t fieldCount)
+{
+  std::string path = prefix;
+  for (size_t i = 0; i < fieldCount; ++i)
+    path.append(fields[i].name);
+
+  m_Matches.clear();
+  m_Matcher.Match(path.data(), path.size(), m_Matches);
+  return !m_Matches.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PSNOSCWriter::WriteMessage(const std::string &prefix, const sField *fields, size_t fieldCount, bool bundle)
+{
+  if (bundle)
+    Reserve(4);  // element size, set below
+
+  size_t start = m_Size;
+
+  // path
+  WriteText(prefix.data(), prefix.size());
+  for (size_t i = 0; i < fieldCount; ++i)
+    WriteText(fields[i].name, strlen(fields[i].name));
+  WritePadding(start);
+
+  // type tags
+  size_t tagsStart = m_Size;
+  WriteText(",", 1);
+  for (size_t i = 0; i < fieldCount; ++i)
+  {
+    for (size_t j = 0; j < fields[i].count; ++j)
+      WriteText(&fields[i].type, 1);
+  }
+  WritePadding(tagsStart);
+
+  // args
+  for (size_t i = 0; i < fieldCount; ++i)
+  {
+    const sField &field = fields[i];
+    if (field.type == 'h')
+      WriteUInt64(field.u);
+    else
+    {
+      for (size_t j = 0; j < field.count; ++j)
+      {
+        uint32_t n = 0;
+        memcpy(&n, &field.f[j], sizeof(n));
+        WriteUInt32(n);
+      }
+    }
+  }
+
+  size_t size = (m_Size - start);
+  if (bundle)
+  {
+    char *dst = &m_Data[start - 4];
+    dst[0] = static_cast<char>((size >> 24) & 0xff);
+    dst[1] = static_cast<char>((size >> 16) & 0xff);
+    dst[2] = static_cast<char>((size >> 8) & 0xff);
+    dst[3] = static_cast<char>(size & 0xff);
+  }
+  else
+  {
+    sPacket packet;
+    packet.offset = start;
+    packet.size = size;
+    m_Packets.push_back(packet);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+char *PSNOSCWriter::Reserve(size_t size)
+{
+  // only grows, so steady frames reuse the same buffer
+  if ((m_Size + size) > m_Data.size())
+    m_Data.resize(std::max(m_Data.size() * 2, std::max(m_Size + size, static_cast<size_t>(4096))));
+
+  char *dst = &m_Data[m_Size];
+  m_Size += size;
+  return dst;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PSNOSCWriter::WriteText(const char *text, size_t len)
+{
+  if (len != 0)
+    memcpy(Reserve(len), text, len);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PSNOSCWriter::WritePadding(size_t start)
+{
+  // null terminated, then padded to 4 bytes
+  size_t len = (m_Size - start);
+  size_t padding = (4 - (len & 3));
+  memset(Reserve(padding), 0, padding);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PSNOSCWriter::WriteUInt32(uint32_t n)
+{
+  char *dst = Reserve(4);
+  dst[0] = static_cast<char>((n >> 24) & 0xff);
+  dst[1] = static_cast<char>((n >> 16) & 0xff);
+  dst[2] = static_cast<char>((n >> 8) & 0xff);
+  dst[3] = static_cast<char>(n & 0xff);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PSNOSCWriter::WriteUInt64(uint64_t n)
+{
+  WriteUInt32(static_cast<uint32_t>(n >> 32));
+  WriteUInt32(static_cast<uint32_t>(n & 0xffffffff));
+}
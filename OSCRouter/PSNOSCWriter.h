@@ -0,0 +1,127 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+#ifndef PSN_OSC_WRITER_H
+#define PSN_OSC_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "psn_defs.hpp"
+
+#ifndef OSC_PATH_MATCHER_H
+#include "OSCPathMatcher.h"
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// encodes the trackers of a decoded PSN frame as OSC, all packets written back to back in one reused buffer
+//
+// per tracker: /psn/<id>/pos, /speed, ... one message per field, then /psn/<id>/pos/speed/... carrying every field
+// with bundle set the whole frame is a single #bundle packet instead
+//
+// a filter limits output to tracker ids in range and to messages some route path matches, decided once per
+// tracker and set of fields present, so unrouted messages are never encoded
+class PSNOSCWriter
+{
+public:
+  struct sPacket
+  {
+    size_t offset = 0;
+    size_t size = 0;
+  };
+
+  typedef std::vector<sPacket> PACKETS;
+
+  enum EnumField
+  {
+    FIELD_POS = 0,
+    FIELD_SPEED,
+    FIELD_ORIENTATION,
+    FIELD_ACCELERATION,
+    FIELD_TARGET,
+    FIELD_STATUS,
+    FIELD_TIMESTAMP,
+
+    FIELD_COUNT
+  };
+
+  struct sField
+  {
+    EnumField id = FIELD_POS;
+    const char *name = nullptr;  // path suffix, "/pos"
+    char type = 'f';
+    size_t count = 0;
+    float f[3] = {0, 0, 0};
+    uint64_t u = 0;
+  };
+
+  PSNOSCWriter() = default;
+
+  virtual void SetFilter(const std::vector<std::string> &paths, uint16_t minTracker, uint16_t maxTracker);  // an empty path, or no paths, passes every message
+  virtual void Write(const psn::tracker_map &trackers, bool bundle);
+  const char *GetData() const { return m_Data.data(); }
+  const PACKETS &GetPackets() const { return m_Packets; }
+
+private:
+  enum EnumConstants
+  {
+    WANT_COMBINED = (1 << FIELD_COUNT),
+    WANT_ALL = ((WANT_COMBINED << 1) - 1),
+    NO_FIELDS = 0xffffffff
+  };
+
+  struct sTracker
+  {
+    std::string prefix;           // "/psn/<id>"
+    uint32_t fields = NO_FIELDS;  // fields present when wanted was decided
+    uint32_t wanted = WANT_ALL;   // bit per EnumField message, then WANT_COMBINED
+  };
+
+  typedef std::unordered_map<uint16_t, sTracker> TRACKERS;
+
+  std::vector<char> m_Data;
+  size_t m_Size = 0;
+  PACKETS m_Packets;
+  TRACKERS m_Trackers;
+  bool m_FilterPaths = false;
+  OSCPathMatcher m_Matcher;
+  OSCPathMatcher::IDS m_Matches;
+  uint16_t m_MinTracker = 0;
+  uint16_t m_MaxTracker = 0xffff;
+
+  virtual uint32_t GetWanted(const std::string &prefix, const sField *fields, size_t fieldCount);
+  virtual bool IsRouted(const std::string &prefix, const sField *fields, size_t fieldCount);
+  virtual void WriteMessage(const std::string &prefix, const sField *fields, size_t fieldCount, bool bundle);
+  virtual char *Reserve(size_t size);
+  virtual void WriteText(const char *text, size_t len);
+  virtual void WritePadding(size_t start);
+  virtual void WriteUInt32(uint32_t n);
+  virtual void WriteUInt64(uint64_t n);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
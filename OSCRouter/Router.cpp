@@ -19,6 +19,7 @@
 // THE SOFTWARE.
 
 #include "Router.h"
+#include "DMXMerge.h"
 #include "EosTimer.h"
 #include "EosUdp.h"
 #include "EosTcp.h"
@@ -34,8 +35,18 @@
 #include <arpa/inet.h>
 #endif
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <sstream>
 #include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
 
 // must be last include
 #include "LeakWatcher.h"
@@ -94,6 +105,102 @@ void PacketLogger::PrintPacket(OSCParser &oscParser, const char *packet, size_t
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void RouterWakeup::Signal()
+{
+  // release, so whatever was queued before signaling is visible to the waiter that clears m_Pending
+  if (m_Pending.exchange(true, std::memory_order_acq_rel))
+    return;
+
+  m_Mutex.lock();
+  m_Signaled = true;
+  m_Cond.wakeAll();
+  m_Mutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterWakeup::Wait(unsigned long timeoutMS)
+{
+  m_Mutex.lock();
+  if (!m_Signaled && timeoutMS != 0)
+    m_Cond.wait(&m_Mutex, timeoutMS);
+  m_Signaled = false;
+  m_Mutex.unlock();
+
+  // producers that skipped locking above queued their work before this, so the caller drains it next
+  m_Pending.exchange(false, std::memory_order_acq_rel);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+qint64 LatencyStats::Now()
+{
+  return static_cast<qint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LatencyStats::Add(qint64 recvTime)
+{
+  if (recvTime == 0)
+    return;
+
+  qint64 latency = (Now() - recvTime);
+
+  // keep the most recent samples once full
+  if (m_Samples.size() < MAX_SAMPLES)
+    m_Samples.push_back(latency);
+  else
+    m_Samples[m_Count % MAX_SAMPLES] = latency;
+
+  ++m_Count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool LatencyStats::Report(qint64 intervalMS, QString &report)
+{
+  if (!m_Timer.isValid())
+  {
+    m_Timer.start();
+    return false;
+  }
+
+  if (m_Timer.elapsed() < intervalMS)
+    return false;
+
+  m_Timer.start();
+
+  if (m_Samples.empty())
+    return false;
+
+  size_t p50 = (m_Samples.size() / 2);
+  std::nth_element(m_Samples.begin(), m_Samples.begin() + p50, m_Samples.end());
+  qint64 p50Latency = m_Samples[p50];
+
+  size_t p99 = ((m_Samples.size() * 99) / 100);
+  std::nth_element(m_Samples.begin(), m_Samples.begin() + p99, m_Samples.end());
+  qint64 p99Latency = m_Samples[p99];
+
+  report = QStringLiteral("routing latency p50: %1us, p99: %2us, packets: %3").arg(p50Latency / 1000.0, 0, 'f', 1).arg(p99Latency / 1000.0, 0, 'f', 1).arg(m_Count);
+
+  m_Samples.clear();
+  m_Count = 0;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void LogDroppedPackets(SPSCQueue<T> &q, const char *name, const EosAddr &addr, EosLog &log)
+{
+  uint64_t dropped = q.TakeDropped();
+  if (dropped != 0)
+    log.AddWarning(QString("%1 %2:%3 queue full, dropped %4 packets").arg(name).arg(addr.ip).arg(addr.port).arg(static_cast<qulonglong>(dropped)).toUtf8().constData());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 EosUdpInThread::EosUdpInThread()
   : m_Run(false)
   , m_Mutex()
@@ -113,7 +220,8 @@ EosUdpInThread::~EosUdpInThread()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosUdpInThread::Start(const EosAddr &addr, QString multicastIP, Protocol protocol, ItemStateTable::ID itemStateTableId, unsigned int reconnectDelayMS, bool mute)
+void EosUdpInThread::Start(const EosAddr &addr, QString multicastIP, Protocol protocol, ItemStateTable::ID itemStateTableId, unsigned int reconnectDelayMS, bool mute, RouterWakeup *wakeup,
+                           bool batchRecv, unsigned int recvBufferSize, UdpInReactorThread *reactor)
 {
   Stop();
 
@@ -125,8 +233,19 @@ void EosUdpInThread::Start(const EosAddr &addr, QString multicastIP, Protocol pr
   m_ItemStateTableId = itemStateTableId;
   m_ReconnectDelay = reconnectDelayMS;
   m_Mute = mute;
+  m_Wakeup = wakeup;
+  m_BatchRecv = batchRecv;
+  m_RecvBufferSize = recvBufferSize;
+  m_Reactor = reactor;
   m_Run = true;
-  start();
+
+  if (m_Reactor)
+  {
+    m_ReactorActive = true;
+    m_Reactor->AddInput(this);
+  }
+  else
+    start();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -134,48 +253,81 @@ void EosUdpInThread::Start(const EosAddr &addr, QString multicastIP, Protocol pr
 void EosUdpInThread::Stop()
 {
   m_Run = false;
-  wait();
+
+  // the reactor holds a pointer to this input, so it must let go before the router deletes it
+  // once it has (m_ReactorActive cleared), the reactor itself may already be deleted
+  if (m_Reactor)
+  {
+    if (m_ReactorActive)
+      m_Reactor->RemoveInput(this);
+  }
+  else
+    wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool EosUdpInThread::IsActive() const
+{
+  return (m_Reactor ? m_ReactorActive.load() : isRunning());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void EosUdpInThread::Flush(EosLog::LOG_Q &logQ, RECV_Q &recvQ)
 {
-  recvQ.clear();
+  PopPackets(recvQ);
+  FlushLog(logQ);
+}
 
-  m_Mutex.lock();
-  m_Log.Flush(logQ);
-  m_Q.swap(recvQ);
-  m_Mutex.unlock();
+////////////////////////////////////////////////////////////////////////////////
+
+void EosUdpInThread::FlushLog(EosLog::LOG_Q &logQ)
+{
+  if (m_LogPending.exchange(false))
+  {
+    m_Mutex.lock();
+    m_Log.Flush(logQ);
+    m_Mutex.unlock();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EosUdpInThread::PopPackets(RECV_Q &recvQ)
+{
+  recvQ.clear();
+  m_Q.PopAll(recvQ);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 ItemState::EnumState EosUdpInThread::GetState()
 {
-  ItemState::EnumState state;
-  m_Mutex.lock();
-  state = m_State;
-  m_Mutex.unlock();
-  return state;
+  return m_State;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void EosUdpInThread::SetState(ItemState::EnumState state)
 {
-  m_Mutex.lock();
   m_State = state;
-  m_Mutex.unlock();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosUdpInThread::RecvPacket(const QHostAddress &host, const char *data, int len, OSCParser &logParser, PacketLogger &packetLogger)
+void EosUdpInThread::SetPSNFilter(const std::vector<std::string> &paths, uint16_t minTracker, uint16_t maxTracker)
+{
+  m_PSNWriter.SetFilter(paths, minTracker, maxTracker);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EosUdpInThread::RecvPacket(const QHostAddress &host, const char *data, int len, qint64 recvTime, OSCParser &logParser, PacketLogger &packetLogger)
 {
   if (m_Protocol != Protocol::kPSN)
   {
-    QueuePacket(host, data, len, logParser, packetLogger);
+    QueuePacket(host, data, len, recvTime, logParser, packetLogger);
     return;
   }
 
@@ -187,173 +339,40 @@ void EosUdpInThread::RecvPacket(const QHostAddress &host, const char *data, int
 
   m_PSNFrame = m_PSNDecoder->get_data().header.frame_id;
 
-  const psn::tracker_map &trackers = m_PSNDecoder->get_data().trackers;
-  for (psn::tracker_map::const_iterator trackerIter = trackers.begin(); trackerIter != trackers.end(); ++trackerIter)
-  {
-    const psn::tracker &tracker = trackerIter->second;
-    std::string path = "/psn/" + std::to_string(tracker.get_id());
-
-    std::string completePath = path;
-    OSCPacketWriter completeOSC;
-
-    if (tracker.is_pos_set())
-    {
-      OSCPacketWriter osc(path + "/pos");
-      completePath += "/pos";
-      osc.AddFloat32(tracker.get_pos().x);
-      osc.AddFloat32(tracker.get_pos().y);
-      osc.AddFloat32(tracker.get_pos().z);
-      completeOSC.AddFloat32(tracker.get_pos().x);
-      completeOSC.AddFloat32(tracker.get_pos().y);
-      completeOSC.AddFloat32(tracker.get_pos().z);
-      size_t size = 0;
-      char *packet = osc.Create(size);
-      if (packet)
-      {
-        if (size > 0)
-          QueuePacket(host, packet, static_cast<int>(size), logParser, packetLogger);
-        delete[] packet;
-      }
-    }
-
-    if (tracker.is_speed_set())
-    {
-      OSCPacketWriter osc(path + "/speed");
-      completePath += "/speed";
-      osc.AddFloat32(tracker.get_speed().x);
-      osc.AddFloat32(tracker.get_speed().y);
-      osc.AddFloat32(tracker.get_speed().z);
-      completeOSC.AddFloat32(tracker.get_speed().x);
-      completeOSC.AddFloat32(tracker.get_speed().y);
-      completeOSC.AddFloat32(tracker.get_speed().z);
-      size_t size = 0;
-      char *packet = osc.Create(size);
-      if (packet)
-      {
-        if (size > 0)
-          QueuePacket(host, packet, static_cast<int>(size), logParser, packetLogger);
-        delete[] packet;
-      }
-    }
-
-    if (tracker.is_ori_set())
-    {
-      OSCPacketWriter osc(path + "/orientation");
-      completePath += "/orientation";
-      osc.AddFloat32(tracker.get_ori().x);
-      osc.AddFloat32(tracker.get_ori().y);
-      osc.AddFloat32(tracker.get_ori().z);
-      completeOSC.AddFloat32(tracker.get_ori().x);
-      completeOSC.AddFloat32(tracker.get_ori().y);
-      completeOSC.AddFloat32(tracker.get_ori().z);
-      size_t size = 0;
-      char *packet = osc.Create(size);
-      if (packet)
-      {
-        if (size > 0)
-          QueuePacket(host, packet, static_cast<int>(size), logParser, packetLogger);
-        delete[] packet;
-      }
-    }
-
-    if (tracker.is_accel_set())
-    {
-      OSCPacketWriter osc(path + "/acceleration");
-      completePath += "/acceleration";
-      osc.AddFloat32(tracker.get_accel().x);
-      osc.AddFloat32(tracker.get_accel().y);
-      osc.AddFloat32(tracker.get_accel().z);
-      completeOSC.AddFloat32(tracker.get_accel().x);
-      completeOSC.AddFloat32(tracker.get_accel().y);
-      completeOSC.AddFloat32(tracker.get_accel().z);
-      size_t size = 0;
-      char *packet = osc.Create(size);
-      if (packet)
-      {
-        if (size > 0)
-          QueuePacket(host, packet, static_cast<int>(size), logParser, packetLogger);
-        delete[] packet;
-      }
-    }
-
-    if (tracker.is_target_pos_set())
-    {
-      OSCPacketWriter osc(path + "/target");
-      completePath += "/target";
-      osc.AddFloat32(tracker.get_target_pos().x);
-      osc.AddFloat32(tracker.get_target_pos().y);
-      osc.AddFloat32(tracker.get_target_pos().z);
-      completeOSC.AddFloat32(tracker.get_target_pos().x);
-      completeOSC.AddFloat32(tracker.get_target_pos().y);
-      completeOSC.AddFloat32(tracker.get_target_pos().z);
-      size_t size = 0;
-      char *packet = osc.Create(size);
-      if (packet)
-      {
-        if (size > 0)
-          QueuePacket(host, packet, static_cast<int>(size), logParser, packetLogger);
-        delete[] packet;
-      }
-    }
-
-    if (tracker.is_status_set())
-    {
-      OSCPacketWriter osc(path + "/status");
-      completePath += "/status";
-      osc.AddFloat32(tracker.get_status());
-      completeOSC.AddFloat32(tracker.get_status());
-      size_t size = 0;
-      char *packet = osc.Create(size);
-      if (packet)
-      {
-        if (size > 0)
-          QueuePacket(host, packet, static_cast<int>(size), logParser, packetLogger);
-        delete[] packet;
-      }
-    }
-
-    if (tracker.is_status_set())
-    {
-      OSCPacketWriter osc(path + "/timestamp");
-      completePath += "/timestamp";
-      osc.AddUInt64(tracker.get_timestamp());
-      completeOSC.AddUInt64(tracker.get_timestamp());
-      size_t size = 0;
-      char *packet = osc.Create(size);
-      if (packet)
-      {
-        if (size > 0)
-          QueuePacket(host, packet, static_cast<int>(size), logParser, packetLogger);
-        delete[] packet;
-      }
-    }
+  // every message of the frame is encoded into one reused buffer, then copied once into the queue
+  m_PSNWriter.Write(m_PSNDecoder->get_data().trackers, m_PSNBundle);
+  const PSNOSCWriter::PACKETS &packets = m_PSNWriter.GetPackets();
+  if (packets.empty())
+    return;
 
-    if (!completeOSC.empty())
-    {
-      completeOSC.SetPath(completePath);
-      size_t size = 0;
-      char *packet = completeOSC.Create(size);
-      if (packet)
-      {
-        if (size > 0)
-          QueuePacket(host, packet, static_cast<int>(size), logParser, packetLogger);
-        delete[] packet;
-      }
-    }
-  }
+  std::string logPrefix = QString("UDP IN   [%1:%2] ").arg(host.toString()).arg(m_Addr.port).toUtf8().constData();
+  packetLogger.SetPrefix(logPrefix);
+  unsigned int ip = static_cast<unsigned int>(host.toIPv4Address());
+  for (PSNOSCWriter::PACKETS::const_iterator i = packets.begin(); i != packets.end(); ++i)
+    PushPacket(ip, m_PSNWriter.GetData() + i->offset, static_cast<int>(i->size), recvTime, logParser, packetLogger);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosUdpInThread::QueuePacket(const QHostAddress &host, const char *data, int len, OSCParser &logParser, PacketLogger &packetLogger)
+void EosUdpInThread::QueuePacket(const QHostAddress &host, const char *data, int len, qint64 recvTime, OSCParser &logParser, PacketLogger &packetLogger)
 {
   std::string logPrefix = QString("UDP IN   [%1:%2] ").arg(host.toString()).arg(m_Addr.port).toUtf8().constData();
   packetLogger.SetPrefix(logPrefix);
+  PushPacket(static_cast<unsigned int>(host.toIPv4Address()), data, len, recvTime, logParser, packetLogger);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EosUdpInThread::PushPacket(unsigned int ip, const char *data, int len, qint64 recvTime, OSCParser &logParser, PacketLogger &packetLogger)
+{
   packetLogger.PrintPacket(logParser, data, static_cast<size_t>(len));
-  unsigned int ip = static_cast<unsigned int>(host.toIPv4Address());
-  m_Mutex.lock();
-  m_Q.push_back(sRecvPacket(data, len, ip));
-  m_Mutex.unlock();
+  sRecvPacket recvPacket(data, len, ip);
+  recvPacket.recvTime = recvTime;
+  if (!m_Q.Push(std::move(recvPacket)))
+    return;  // router thread is behind, counted and logged as dropped
+
+  if (m_Wakeup)
+    m_Wakeup->Signal();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -374,32 +393,50 @@ void EosUdpInThread::run()
   {
     SetState(ItemState::STATE_CONNECTING);
 
-    EosUdpIn *udpIn = EosUdpIn::Create();
-    if (udpIn->Initialize(m_PrivateLog, m_Addr.ip.toUtf8().constData(), m_Addr.port, m_MulticastIP.isEmpty() ? nullptr : m_MulticastIP.toUtf8().constData()))
+    if (m_BatchRecv && UdpBatchIn::IsSupported())
     {
-      SetState(ItemState::STATE_CONNECTED);
+      RunBatchRecv();
+    }
+    else
+    {
+      EosUdpIn *udpIn = EosUdpIn::Create();
+      if (udpIn->Initialize(m_PrivateLog, m_Addr.ip.toUtf8().constData(), m_Addr.port, m_MulticastIP.isEmpty() ? nullptr : m_MulticastIP.toUtf8().constData()))
+      {
+        SetState(ItemState::STATE_CONNECTED);
 
-      OSCParser logParser;
-      logParser.SetRoot(new OSCMethod());
-      PacketLogger packetLogger(EosLog::LOG_MSG_TYPE_RECV, m_PrivateLog);
-      sockaddr_in addr;
+        OSCParser logParser;
+        logParser.SetRoot(new OSCMethod());
+        PacketLogger packetLogger(EosLog::LOG_MSG_TYPE_RECV, m_PrivateLog);
+        sockaddr_in addr;
+        EosTimer droppedTimer;
+        droppedTimer.Start();
 
-      // run
-      while (m_Run)
-      {
-        int len = 0;
-        int addrSize = static_cast<int>(sizeof(addr));
-        const char *data = udpIn->RecvPacket(m_PrivateLog, 100, 0, len, &addr, &addrSize);
-        if (!m_Mute && data && len > 0)
-          RecvPacket(QHostAddress(reinterpret_cast<const sockaddr *>(&addr)), data, len, logParser, packetLogger);
+        // run
+        while (m_Run)
+        {
+          int len = 0;
+          int addrSize = static_cast<int>(sizeof(addr));
+          const char *data = udpIn->RecvPacket(m_PrivateLog, 100, 0, len, &addr, &addrSize);
+          bool received = (data && len > 0);
+          if (!m_Mute && received)
+            RecvPacket(QHostAddress(reinterpret_cast<const sockaddr *>(&addr)), data, len, LatencyStats::Now(), logParser, packetLogger);
+
+          if (droppedTimer.GetExpired(1000))
+          {
+            LogDroppedPackets(m_Q, "udp in", m_Addr, m_PrivateLog);
+            droppedTimer.Start();
+          }
 
-        UpdateLog();
+          UpdateLog();
 
-        msleep(1);
+          // keep reading while data is available
+          if (!received)
+            msleep(1);
+        }
       }
-    }
 
-    delete udpIn;
+      delete udpIn;
+    }
 
     SetState(ItemState::STATE_NOT_CONNECTED);
 
@@ -424,88 +461,558 @@ void EosUdpInThread::run()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void EosUdpInThread::RunBatchRecv()
+{
+  UdpBatchIn udpIn;
+  if (!udpIn.Initialize(m_PrivateLog, m_Addr.ip.toUtf8().constData(), m_Addr.port, m_MulticastIP.isEmpty() ? nullptr : m_MulticastIP.toUtf8().constData(), m_RecvBufferSize))
+    return;
+
+  SetState(ItemState::STATE_CONNECTED);
+
+  OSCParser logParser;
+  logParser.SetRoot(new OSCMethod());
+  PacketLogger packetLogger(EosLog::LOG_MSG_TYPE_RECV, m_PrivateLog);
+  UdpBatchIn::PACKETS packets;
+  packets.reserve(UdpBatchIn::MAX_BATCH);
+  EosTimer droppedTimer;
+  droppedTimer.Start();
+
+  // run, a full batch means more may be waiting so there is no sleep between reads
+  while (m_Run)
+  {
+    if (!udpIn.Recv(m_PrivateLog, 100, packets))
+      break;
+
+    if (!m_Mute)
+    {
+      for (UdpBatchIn::PACKETS::const_iterator i = packets.begin(); i != packets.end(); ++i)
+      {
+        if (i->len > 0)
+          RecvPacket(QHostAddress(static_cast<quint32>(i->ip)), i->data, i->len, static_cast<qint64>(i->recvTime), logParser, packetLogger);
+      }
+    }
+
+    if (droppedTimer.GetExpired(1000))
+    {
+      LogDroppedPackets(m_Q, "udp in", m_Addr, m_PrivateLog);
+      droppedTimer.Start();
+    }
+
+    UpdateLog();
+  }
+
+  UpdateLog();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void EosUdpInThread::UpdateLog()
 {
+  m_PrivateLog.Flush(m_PrivateLogQ);
+  if (m_PrivateLogQ.empty())
+    return;
+
   m_Mutex.lock();
-  m_Log.AddLog(m_PrivateLog);
+  m_Log.AddQ(m_PrivateLogQ);
   m_Mutex.unlock();
 
-  m_PrivateLog.Clear();
+  m_PrivateLogQ.clear();
+  m_LogPending = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-EosUdpOutThread::EosUdpOutThread()
-  : m_Run(false)
-  , m_ItemStateTableId(ItemStateTable::sm_Invalid_Id)
-  , m_State(ItemState::STATE_UNINITIALIZED)
-  , m_ReconnectDelay(0)
-  , m_QEnabled(false)
+UdpInReactorThread::UdpInReactorThread()
 {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-EosUdpOutThread::~EosUdpOutThread()
+UdpInReactorThread::~UdpInReactorThread()
 {
   Stop();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosUdpOutThread::Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, unsigned int reconnectDelayMS)
+bool UdpInReactorThread::IsSupported()
 {
-  Stop();
-
-  m_Addr = addr;
-  m_ItemStateTableId = itemStateTableId;
-  m_ReconnectDelay = reconnectDelayMS;
-  m_Run = true;
-  m_QEnabled = true;  // q commands while on-demand thread is first starting
-  start();
+  return (UdpPoller::IsSupported() && UdpBatchIn::IsSupported());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosUdpOutThread::Stop()
+void UdpInReactorThread::AddInput(EosUdpInThread *input)
 {
-  m_Run = false;
-  wait();
+  // inputs are only added before Start, so the reactor thread never shares m_Inputs
+  sInput newInput;
+  newInput.input = input;
+  m_Inputs.push_back(newInput);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-bool EosUdpOutThread::Send(const EosPacket &packet)
+void UdpInReactorThread::RemoveInput(EosUdpInThread *input)
 {
-  m_Mutex.lock();
-  if (m_QEnabled)
+  m_RemoveMutex.lock();
+  if (isRunning())
   {
-    m_Q.push_back(packet);
-    m_Mutex.unlock();
-    return true;
+    // ended on the reactor thread, which owns m_Inputs while running
+    m_Remove.push_back(input);
+    m_HasRemove = true;
+    while (input->m_ReactorActive && isRunning())
+      m_Removed.wait(&m_RemoveMutex, 100);
   }
-  m_Mutex.unlock();
-  return false;
+  else
+  {
+    // not started yet, or already ended every input
+    for (INPUTS::iterator i = m_Inputs.begin(); i != m_Inputs.end(); ++i)
+    {
+      if (i->input == input)
+        i->input = nullptr;
+    }
+    input->m_ReactorActive = false;
+  }
+  m_RemoveMutex.unlock();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosUdpOutThread::Flush(EosLog::LOG_Q &logQ)
+void UdpInReactorThread::EndRemoved()
 {
-  m_Mutex.lock();
-  m_Log.Flush(logQ);
-  m_Mutex.unlock();
+  m_RemoveMutex.lock();
+  for (std::vector<EosUdpInThread *>::const_iterator i = m_Remove.begin(); i != m_Remove.end(); ++i)
+  {
+    for (size_t j = 0; j < m_Inputs.size(); ++j)
+    {
+      if (m_Inputs[j].input == *i)
+        End(j);
+    }
+  }
+  m_Remove.clear();
+  m_HasRemove = false;
+  m_Removed.wakeAll();
+  m_RemoveMutex.unlock();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-ItemState::EnumState EosUdpOutThread::GetState()
+void UdpInReactorThread::Start(int cpu)
 {
-  ItemState::EnumState state;
-  m_Mutex.lock();
-  state = m_State;
-  m_Mutex.unlock();
-  return state;
+  Stop();
+
+  m_Cpu = cpu;
+  m_Run = true;
+  start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpInReactorThread::Stop()
+{
+  m_Run = false;
+  wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpInReactorThread::Open(size_t index)
+{
+  sInput &s = m_Inputs[index];
+  EosUdpInThread *input = s.input;
+  input->SetState(ItemState::STATE_CONNECTING);
+
+  s.udpIn = new UdpBatchIn();
+  if (s.udpIn->Initialize(input->m_PrivateLog, input->m_Addr.ip.toUtf8().constData(), input->m_Addr.port,
+                          input->m_MulticastIP.isEmpty() ? nullptr : input->m_MulticastIP.toUtf8().constData(), input->m_RecvBufferSize) &&
+      m_Poller.Add(input->m_PrivateLog, s.udpIn->GetSocket(), index))
+  {
+    input->SetState(ItemState::STATE_CONNECTED);
+    return;
+  }
+
+  Reconnect(index);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpInReactorThread::Reconnect(size_t index)
+{
+  sInput &s = m_Inputs[index];
+  EosUdpInThread *input = s.input;
+  if (!input)
+    return;
+
+  Close(index);
+
+  if (input->m_ReconnectDelay == 0)
+  {
+    End(index);
+    return;
+  }
+
+  QString msg = QString("udp in %1:%2 reconnecting in %3...").arg(input->m_Addr.ip).arg(input->m_Addr.port).arg(input->m_ReconnectDelay / 1000);
+  input->m_PrivateLog.AddInfo(msg.toUtf8().constData());
+  s.reconnectTimer.Start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpInReactorThread::Close(size_t index)
+{
+  sInput &s = m_Inputs[index];
+  if (s.udpIn)
+  {
+    m_Poller.Remove(s.udpIn->GetSocket());
+    delete s.udpIn;
+    s.udpIn = nullptr;
+  }
+
+  if (s.input)
+    s.input->SetState(ItemState::STATE_NOT_CONNECTED);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpInReactorThread::End(size_t index)
+{
+  sInput &s = m_Inputs[index];
+  EosUdpInThread *input = s.input;
+  if (!input)
+    return;
+
+  Close(index);
+
+  delete s.packetLogger;
+  s.packetLogger = nullptr;
+  delete input->m_PSNDecoder;
+  input->m_PSNDecoder = nullptr;
+
+  QString msg = QString("udp in %1:%2 ended").arg(input->m_Addr.ip).arg(input->m_Addr.port);
+  input->m_PrivateLog.AddInfo(msg.toUtf8().constData());
+  input->UpdateLog();
+
+  // router may delete the input from here on
+  s.input = nullptr;
+  input->m_ReactorActive = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpInReactorThread::run()
+{
+#ifdef __linux__
+  if (m_Cpu >= 0)
+  {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(m_Cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+  }
+#endif
+
+  // errors from the shared poller are copied to every input they affect
+  EosLog reactorLog;
+  EosLog::LOG_Q reactorLogQ;
+
+  unsigned int pollerRetryDelay = 0;
+  for (size_t i = 0; i < m_Inputs.size(); ++i)
+  {
+    sInput &s = m_Inputs[i];
+    EosUdpInThread *input = s.input;
+    if (!input)
+      continue;  // stopped before the reactor started
+
+    // a poller that fails is retried after the same delay as a socket reconnect
+    pollerRetryDelay = input->m_ReconnectDelay;
+    input->m_PSNDecoder = new psn::psn_decoder();
+    input->m_PSNFrame.reset();
+    s.packetLogger = new PacketLogger(EosLog::LOG_MSG_TYPE_RECV, input->m_PrivateLog);
+
+    QString msg = QString("udp in %1:%2 started on shared reactor").arg(input->m_Addr.ip).arg(input->m_Addr.port);
+    input->m_PrivateLog.AddInfo(msg.toUtf8().constData());
+  }
+
+  EosTimer pollerTimer;
+  bool pollerReady = m_Poller.Initialize(reactorLog);
+  if (pollerReady)
+  {
+    for (size_t i = 0; i < m_Inputs.size(); ++i)
+    {
+      if (m_Inputs[i].input)
+        Open(i);
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < m_Inputs.size(); ++i)
+      Reconnect(i);
+    pollerTimer.Start();
+  }
+
+  OSCParser logParser;
+  logParser.SetRoot(new OSCMethod());
+  UdpBatchIn::PACKETS packets;
+  packets.reserve(UdpBatchIn::MAX_BATCH);
+  UdpPoller::IDS ready;
+  ready.reserve(UdpPoller::MAX_EVENTS);
+  EosTimer droppedTimer;
+  droppedTimer.Start();
+
+  while (m_Run)
+  {
+    if (m_HasRemove)
+      EndRemoved();
+
+    if (!pollerReady && pollerTimer.GetExpired(pollerRetryDelay))
+    {
+      pollerReady = m_Poller.Initialize(reactorLog);
+      if (!pollerReady)
+        pollerTimer.Start();
+    }
+
+    if (pollerReady)
+    {
+      for (size_t i = 0; i < m_Inputs.size(); ++i)
+      {
+        sInput &s = m_Inputs[i];
+        if (s.input && !s.udpIn && s.reconnectTimer.GetExpired(s.input->m_ReconnectDelay))
+          Open(i);
+      }
+
+      if (!m_Poller.Wait(reactorLog, 100, ready))
+      {
+        // poller is unusable, drop every socket and reconnect through a new one once the delay has passed
+        for (size_t i = 0; i < m_Inputs.size(); ++i)
+        {
+          if (m_Inputs[i].udpIn)
+            Reconnect(i);
+        }
+
+        m_Poller.Shutdown();
+        pollerReady = false;
+        pollerTimer.Start();
+      }
+    }
+    else
+    {
+      // nothing to wait on until the poller is back
+      ready.clear();
+      msleep(100);
+    }
+
+    for (UdpPoller::IDS::const_iterator i = ready.begin(); i != ready.end(); ++i)
+    {
+      size_t index = *i;
+      sInput &s = m_Inputs[index];
+      if (!s.udpIn)
+        continue;  // closed earlier in this pass
+
+      EosUdpInThread *input = s.input;
+      if (!s.udpIn->RecvAvailable(input->m_PrivateLog, packets))
+      {
+        Reconnect(index);
+        continue;
+      }
+
+      if (input->m_Mute)
+        continue;
+
+      for (UdpBatchIn::PACKETS::const_iterator j = packets.begin(); j != packets.end(); ++j)
+      {
+        if (j->len > 0)
+          input->RecvPacket(QHostAddress(static_cast<quint32>(j->ip)), j->data, j->len, static_cast<qint64>(j->recvTime), logParser, *s.packetLogger);
+      }
+    }
+
+    bool logDropped = droppedTimer.GetExpired(1000);
+    if (logDropped)
+      droppedTimer.Start();
+
+    reactorLog.Flush(reactorLogQ);
+    for (size_t i = 0; i < m_Inputs.size(); ++i)
+    {
+      EosUdpInThread *input = m_Inputs[i].input;
+      if (!input)
+        continue;
+
+      if (!reactorLogQ.empty())
+        input->m_PrivateLog.AddQ(reactorLogQ);
+
+      if (logDropped)
+        LogDroppedPackets(input->m_Q, "udp in", input->m_Addr, input->m_PrivateLog);
+
+      input->UpdateLog();
+    }
+    reactorLogQ.clear();
+  }
+
+  for (size_t i = 0; i < m_Inputs.size(); ++i)
+    End(i);
+
+  // releases any RemoveInput still waiting, its input was just ended with the rest
+  EndRemoved();
+
+  m_Poller.Shutdown();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ArtNetWakeThread::~ArtNetWakeThread()
+{
+  Stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ArtNetWakeThread::Start(artnet_node server, RouterWakeup &wakeup)
+{
+  Stop();
+
+  m_Server = server;
+  m_Wakeup = &wakeup;
+  m_Rearmed = false;
+  m_Run = true;
+  start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ArtNetWakeThread::Stop()
+{
+  m_Run = false;
+  Rearm();
+  wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ArtNetWakeThread::Rearm()
+{
+  m_Mutex.lock();
+  m_Rearmed = true;
+  m_Cond.wakeAll();
+  m_Mutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ArtNetWakeThread::run()
+{
+  artnet_socket_t sd = artnet_get_sd(m_Server);
+
+  while (m_Run)
+  {
+    // bounded, so Stop is noticed
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(sd, &readable);
+    timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 100000;
+    int result = select(static_cast<int>(sd) + 1, &readable, nullptr, nullptr, &timeout);
+    if (result == 0)
+      continue;
+
+    if (result < 0)
+    {
+      msleep(100);
+      continue;
+    }
+
+    m_Wakeup->Signal();
+
+    // the socket stays readable until the router reads it
+    m_Mutex.lock();
+    if (!m_Rearmed && m_Run)
+      m_Cond.wait(&m_Mutex, 100);
+    m_Rearmed = false;
+    m_Mutex.unlock();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+EosUdpOutThread::EosUdpOutThread()
+  : m_Run(false)
+  , m_ItemStateTableId(ItemStateTable::sm_Invalid_Id)
+  , m_State(ItemState::STATE_UNINITIALIZED)
+  , m_ReconnectDelay(0)
+  , m_QEnabled(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+EosUdpOutThread::~EosUdpOutThread()
+{
+  Stop();
+
+  for (size_t i = 0; i < m_Qs.size(); ++i)
+    delete m_Qs[i];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EosUdpOutThread::Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, unsigned int reconnectDelayMS, bool batchSend, unsigned int bundleSize, size_t producerCount)
+{
+  Stop();
+
+  // producers are fixed while running, each keeps its own order
+  if (producerCount < 1)
+    producerCount = 1;
+  while (m_Qs.size() < producerCount)
+    m_Qs.push_back(new SPSCQueue<EosPacket>());
+
+  m_Addr = addr;
+  m_ItemStateTableId = itemStateTableId;
+  m_ReconnectDelay = reconnectDelayMS;
+  m_BatchSend = batchSend;
+  m_BundleSize = bundleSize;
+  m_Run = true;
+  m_QEnabled = true;  // q commands while on-demand thread is first starting
+  start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EosUdpOutThread::Stop()
+{
+  m_Run = false;
+  wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool EosUdpOutThread::Send(const EosPacket &packet)
+{
+  return Send(packet, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool EosUdpOutThread::Send(const EosPacket &packet, size_t producer)
+{
+  return (m_QEnabled && producer < m_Qs.size() && m_Qs[producer]->Push(packet));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EosUdpOutThread::Flush(EosLog::LOG_Q &logQ)
+{
+  if (m_LogPending.exchange(false))
+  {
+    m_Mutex.lock();
+    m_Log.Flush(logQ);
+    m_Mutex.unlock();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ItemState::EnumState EosUdpOutThread::GetState()
+{
+  return m_State;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -541,8 +1048,21 @@ void EosUdpOutThread::run()
   {
     SetState(ItemState::STATE_CONNECTING);
 
-    EosUdpOut *udpOut = EosUdpOut::Create();
-    if (udpOut->Initialize(m_PrivateLog, m_Addr.ip.toUtf8().constData(), m_Addr.port, QHostAddress(m_Addr.ip).isMulticast()))
+    EosUdpOut *udpOut = 0;
+    UdpBatchOut *batchOut = 0;
+    bool initialized = false;
+    if (m_BatchSend && UdpBatchOut::IsSupported())
+    {
+      batchOut = new UdpBatchOut();
+      initialized = batchOut->Initialize(m_PrivateLog, m_Addr.ip.toUtf8().constData(), m_Addr.port, QHostAddress(m_Addr.ip).isMulticast());
+    }
+    else
+    {
+      udpOut = EosUdpOut::Create();
+      initialized = udpOut->Initialize(m_PrivateLog, m_Addr.ip.toUtf8().constData(), m_Addr.port, QHostAddress(m_Addr.ip).isMulticast());
+    }
+
+    if (initialized)
     {
       SetState(ItemState::STATE_CONNECTED);
 
@@ -553,28 +1073,76 @@ void EosUdpOutThread::run()
 
       // run
       EosPacket::Q q;
+      EosPacket::Q bundled;
+      UdpBatchOut::INDICES bundleEnds;
+      UdpBatchOut::INDICES failed;
+      EosTimer droppedTimer;
+      droppedTimer.Start();
       while (m_Run)
       {
-        m_Mutex.lock();
-        m_Q.swap(q);
-        m_Mutex.unlock();
+        for (size_t i = 0; i < m_Qs.size(); ++i)
+          m_Qs[i]->PopAll(q);
+
+        if (!q.empty())
+        {
+          const EosPacket::Q *sendQ = &q;
+          if (m_BundleSize != 0)
+          {
+            UdpBatchOut::Coalesce(q, m_BundleSize, bundled, bundleEnds);
+            sendQ = &bundled;
+          }
+
+          if (batchOut)
+            batchOut->Send(m_PrivateLog, sendQ->data(), sendQ->size(), failed);
+          UdpBatchOut::INDICES::const_iterator nextFailed = failed.begin();
+
+          // log the original messages, not the bundles they went out in
+          size_t logIndex = 0;
+          for (size_t i = 0; m_Run && i < sendQ->size(); i++)
+          {
+            size_t logEnd = (sendQ == &bundled) ? bundleEnds[i] : (i + 1);
+            bool success = false;
+            if (batchOut)
+            {
+              success = (nextFailed == failed.end() || *nextFailed != i);
+              if (!success)
+                ++nextFailed;
+            }
+            else
+              success = udpOut->SendPacket(m_PrivateLog, (*sendQ)[i].GetDataConst(), (*sendQ)[i].GetSize());
+
+            for (; success && logIndex < logEnd; logIndex++)
+              packetLogger.PrintPacket(logParser, q[logIndex].GetDataConst(), static_cast<size_t>(q[logIndex].GetSize()));
+            logIndex = logEnd;
+          }
+
+          q.clear();
+          bundled.clear();
+          bundleEnds.clear();
+        }
 
-        for (EosPacket::Q::iterator i = q.begin(); m_Run && i != q.end(); i++)
+        if (droppedTimer.GetExpired(1000))
         {
-          const char *buf = i->GetData();
-          int len = i->GetSize();
-          if (udpOut->SendPacket(m_PrivateLog, buf, len))
-            packetLogger.PrintPacket(logParser, buf, static_cast<size_t>(len));
+          for (size_t i = 0; i < m_Qs.size(); ++i)
+            LogDroppedPackets(*m_Qs[i], "udp out", m_Addr, m_PrivateLog);
+          droppedTimer.Start();
         }
-        q.clear();
 
         UpdateLog();
 
-        msleep(1);
+        // keep draining while busy, only idle when there was nothing to send
+        bool idle = true;
+        for (size_t i = 0; idle && i < m_Qs.size(); ++i)
+          idle = m_Qs[i]->empty();
+        if (idle)
+          msleep(1);
       }
     }
 
-    delete udpOut;
+    if (udpOut)
+      delete udpOut;
+    if (batchOut)
+      delete batchOut;
 
     SetState(ItemState::STATE_NOT_CONNECTED);
 
@@ -599,11 +1167,16 @@ void EosUdpOutThread::run()
 
 void EosUdpOutThread::UpdateLog()
 {
+  m_PrivateLog.Flush(m_PrivateLogQ);
+  if (m_PrivateLogQ.empty())
+    return;
+
   m_Mutex.lock();
-  m_Log.AddLog(m_PrivateLog);
+  m_Log.AddQ(m_PrivateLogQ);
   m_Mutex.unlock();
 
-  m_PrivateLog.Clear();
+  m_PrivateLogQ.clear();
+  m_LogPending = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -628,14 +1201,15 @@ EosTcpClientThread::~EosTcpClientThread()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosTcpClientThread::Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, bool mute)
+void EosTcpClientThread::Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, bool mute, RouterWakeup *wakeup)
 {
-  Start(0, addr, itemStateTableId, frameMode, reconnectDelayMS, mute);
+  Start(0, addr, itemStateTableId, frameMode, reconnectDelayMS, mute, wakeup);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosTcpClientThread::Start(EosTcp *tcp, const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, bool mute)
+void EosTcpClientThread::Start(EosTcp *tcp, const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, bool mute,
+                               RouterWakeup *wakeup)
 {
   Stop();
 
@@ -645,6 +1219,7 @@ void EosTcpClientThread::Start(EosTcp *tcp, const EosAddr &addr, ItemStateTable:
   m_FrameMode = frameMode;
   m_ReconnectDelay = reconnectDelayMS;
   m_Mute = mute;
+  m_Wakeup = wakeup;
   m_Run = true;
   start();
 }
@@ -667,35 +1242,24 @@ void EosTcpClientThread::Stop()
 
 bool EosTcpClientThread::Send(const EosPacket &packet)
 {
-  m_Mutex.lock();
-  if (GetState() == ItemState::STATE_CONNECTED)
-  {
-    m_SendQ.push_back(packet);
-    m_Mutex.unlock();
-    return true;
-  }
-  m_Mutex.unlock();
-  return false;
+  return (GetState() == ItemState::STATE_CONNECTED && m_SendQ.Push(packet));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 bool EosTcpClientThread::SendFramed(const EosPacket &packet)
 {
-  m_Mutex.lock();
   if (GetState() == ItemState::STATE_CONNECTED)
   {
     size_t frameSize = packet.GetSize();
     char *frame = OSCStream::CreateFrame(m_FrameMode, packet.GetDataConst(), frameSize);
     if (frame)
     {
-      m_SendQ.push_back(EosPacket(frame, static_cast<int>(frameSize)));
-      m_Mutex.unlock();
+      bool queued = m_SendQ.Push(EosPacket(frame, static_cast<int>(frameSize)));
       delete[] frame;
-      return true;
+      return queued;
     }
   }
-  m_Mutex.unlock();
   return false;
 }
 
@@ -704,31 +1268,28 @@ bool EosTcpClientThread::SendFramed(const EosPacket &packet)
 void EosTcpClientThread::Flush(EosLog::LOG_Q &logQ, EosUdpInThread::RECV_Q &recvQ)
 {
   recvQ.clear();
+  m_RecvQ.PopAll(recvQ);
 
-  m_Mutex.lock();
-  m_Log.Flush(logQ);
-  m_RecvQ.swap(recvQ);
-  m_Mutex.unlock();
+  if (m_LogPending.exchange(false))
+  {
+    m_Mutex.lock();
+    m_Log.Flush(logQ);
+    m_Mutex.unlock();
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 ItemState::EnumState EosTcpClientThread::GetState()
 {
-  ItemState::EnumState state;
-  m_Mutex.lock();
-  state = m_State;
-  m_Mutex.unlock();
-  return state;
+  return m_State;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void EosTcpClientThread::SetState(ItemState::EnumState state)
 {
-  m_Mutex.lock();
   m_State = state;
-  m_Mutex.unlock();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -780,6 +1341,8 @@ void EosTcpClientThread::run()
 
       // send/recv while connected
       EosPacket::Q sendQ;
+      EosTimer droppedTimer;
+      droppedTimer.Start();
       unsigned int ip = m_Addr.toUInt();
       OSCStream recvStream(m_FrameMode);
       OSCStream sendStream(m_FrameMode);
@@ -799,9 +1362,10 @@ void EosTcpClientThread::run()
             if (!m_Mute && frameSize != 0)
             {
               inPacketLogger.PrintPacket(logParser, frame, frameSize);
-              m_Mutex.lock();
-              m_RecvQ.push_back(EosUdpInThread::sRecvPacket(frame, static_cast<int>(frameSize), ip));
-              m_Mutex.unlock();
+              EosUdpInThread::sRecvPacket recvPacket(frame, static_cast<int>(frameSize), ip);
+              recvPacket.recvTime = LatencyStats::Now();
+              if (m_RecvQ.Push(std::move(recvPacket)) && m_Wakeup)
+                m_Wakeup->Signal();
             }
 
             delete[] frame;
@@ -812,13 +1376,11 @@ void EosTcpClientThread::run()
 
         msleep(1);
 
-        m_Mutex.lock();
-        m_SendQ.swap(sendQ);
-        m_Mutex.unlock();
+        m_SendQ.PopAll(sendQ);
 
         for (EosPacket::Q::iterator i = sendQ.begin(); m_Run && i != sendQ.end(); i++)
         {
-          data = i->GetData();
+          data = i->GetDataConst();
           len = static_cast<size_t>(i->GetSize());
           if (tcp->Send(m_PrivateLog, data, len))
           {
@@ -841,6 +1403,13 @@ void EosTcpClientThread::run()
         }
         sendQ.clear();
 
+        if (droppedTimer.GetExpired(1000))
+        {
+          LogDroppedPackets(m_RecvQ, "tcp client recv", m_Addr, m_PrivateLog);
+          LogDroppedPackets(m_SendQ, "tcp client send", m_Addr, m_PrivateLog);
+          droppedTimer.Start();
+        }
+
         UpdateLog();
 
         msleep(1);
@@ -872,11 +1441,16 @@ void EosTcpClientThread::run()
 
 void EosTcpClientThread::UpdateLog()
 {
+  m_PrivateLog.Flush(m_PrivateLogQ);
+  if (m_PrivateLogQ.empty())
+    return;
+
   m_Mutex.lock();
-  m_Log.AddLog(m_PrivateLog);
+  m_Log.AddQ(m_PrivateLogQ);
   m_Mutex.unlock();
 
-  m_PrivateLog.Clear();
+  m_PrivateLogQ.clear();
+  m_LogPending = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -898,7 +1472,7 @@ EosTcpServerThread::~EosTcpServerThread()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void EosTcpServerThread::Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS)
+void EosTcpServerThread::Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, RouterWakeup *wakeup)
 {
   Stop();
 
@@ -908,6 +1482,7 @@ void EosTcpServerThread::Start(const EosAddr &addr, ItemStateTable::ID itemState
   m_ItemStateTableId = itemStateTableId;
   m_FrameMode = frameMode;
   m_ReconnectDelay = reconnectDelayMS;
+  m_Wakeup = wakeup;
   m_Run = true;
   start();
 }
@@ -995,6 +1570,9 @@ void EosTcpServerThread::run()
           m_Q.push_back(connection);
           m_Mutex.unlock();
 
+          if (m_Wakeup)
+            m_Wakeup->Signal();
+
           UpdateLog();
           msleep(1);
         }
@@ -1043,7 +1621,7 @@ void EosTcpServerThread::UpdateLog()
 bool OSCBundleMethod::ProcessPacket(OSCParserClient & /*client*/, char *buf, size_t size)
 {
   EosUdpInThread::sRecvPacket packet(buf, static_cast<int>(size), m_IP);
-  m_Q.push_back(packet);
+  m_Q.push_back(std::move(packet));
   return true;
 }
 
@@ -1080,6 +1658,7 @@ RouterThread::~RouterThread()
 void RouterThread::Stop()
 {
   m_Run = false;
+  m_Wakeup.Signal();
   wait();
 }
 
@@ -1097,12 +1676,25 @@ void RouterThread::Sync(EosLog::LOG_Q &logQ, ItemStateTable &itemStateTable)
 ////////////////////////////////////////////////////////////////////////////////
 
 void RouterThread::BuildRoutes(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &routesBysACNUniverse, ROUTES_BY_PORT &routesByArtNetUniverse, ROUTES_BY_PORT &routesByMIDI, UDP_IN_THREADS &udpInThreads,
-                               UDP_OUT_THREADS &udpOutThreads, TCP_CLIENT_THREADS &tcpClientThreads, TCP_SERVER_THREADS &tcpServerThreads)
+                               UDP_IN_REACTORS &udpInReactors, ROUTE_SHARDS &routeShards, UDP_OUT_THREADS &udpOutThreads, TCP_CLIENT_THREADS &tcpClientThreads,
+                               TCP_SERVER_THREADS &tcpServerThreads)
 {
   m_PrivateLog.AddInfo("Building Routing Table...");
 
   bool mute = GetMuteAll().incoming;
 
+  // shared poller threads for udp input, assigned round robin below
+  if (m_Settings.udpInReactors != 0 && UdpInReactorThread::IsSupported())
+  {
+    for (unsigned int i = 0; i < m_Settings.udpInReactors; ++i)
+      udpInReactors.push_back(new UdpInReactorThread());
+  }
+
+  // routing shards, known before any udp out thread is created so each output has a producer queue per shard
+  for (unsigned int i = 0; i < m_Settings.routerShards; ++i)
+    routeShards.push_back(new RouteShardThread(*this, routeShards.size() + 1));
+  m_RouteShardCount = routeShards.size();
+
   // create TCP threads
   for (Router::CONNECTIONS::const_iterator i = m_TcpConnections.begin(); i != m_TcpConnections.end(); i++)
   {
@@ -1114,17 +1706,18 @@ void RouterThread::BuildRoutes(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &rou
       {
         EosTcpServerThread *thread = new EosTcpServerThread();
         tcpServerThreads[tcpConnection.addr] = thread;
-        thread->Start(tcpConnection.addr, tcpConnection.itemStateTableId, tcpConnection.frameMode, m_ReconnectDelay);
+        thread->Start(tcpConnection.addr, tcpConnection.itemStateTableId, tcpConnection.frameMode, m_ReconnectDelay, &m_Wakeup);
       }
     }
     else if (QHostAddress(tcpConnection.addr.ip).toIPv4Address() != 0 && tcpClientThreads.find(tcpConnection.addr) == tcpClientThreads.end())
     {
       EosTcpClientThread *thread = new EosTcpClientThread();
       tcpClientThreads[tcpConnection.addr] = thread;
-      thread->Start(tcpConnection.addr, tcpConnection.itemStateTableId, tcpConnection.frameMode, m_ReconnectDelay, mute);
+      thread->Start(tcpConnection.addr, tcpConnection.itemStateTableId, tcpConnection.frameMode, m_ReconnectDelay, mute, &m_Wakeup);
     }
   }
 
+  Router::ROUTES udpInRoutes;
   QHostAddress localHost(QHostAddress::LocalHost);
   for (Router::ROUTES::const_iterator i = m_Routes.begin(); i != m_Routes.end(); i++)
   {
@@ -1132,6 +1725,13 @@ void RouterThread::BuildRoutes(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &rou
     if (!route.enable)
       continue;
 
+    std::string srcPath(route.src.path.toStdString());
+    if (OSCPathPattern::IsPattern(srcPath) && !OSCPathPattern().Compile(srcPath))
+    {
+      m_PrivateLog.AddWarning(QString("route %1 skipped, invalid wildcard path \"%2\"").arg(route.label).arg(route.src.path).toUtf8().constData());
+      continue;
+    }
+
     QHostAddress srcAddr(route.src.addr.ip);
 
     ROUTES_BY_PORT *routes = &routesByPort;
@@ -1154,9 +1754,9 @@ void RouterThread::BuildRoutes(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &rou
     }
     else if (udpInThreads.find(route.src.addr) == udpInThreads.end())
     {
-      EosUdpInThread *thread = new EosUdpInThread();
-      udpInThreads[route.src.addr] = thread;
-      thread->Start(route.src.addr, route.src.multicastIP, route.src.protocol, route.srcItemStateTableId, m_ReconnectDelay, mute);
+      // started below, once every route from its port is known
+      udpInThreads[route.src.addr] = new EosUdpInThread();
+      udpInRoutes.push_back(route);
     }
 
     // create udp out thread if known dst, and not an explicit tcp client
@@ -1184,7 +1784,7 @@ void RouterThread::BuildRoutes(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &rou
     }
 
     // sorted 3rd by path
-    ROUTES_BY_PATH &routesByPath = (route.src.path.contains('*') ? ipIter->second.routesByWildcardPath : ipIter->second.routesByPath);
+    ROUTES_BY_PATH &routesByPath = (OSCPathPattern::IsPattern(srcPath) ? ipIter->second.routesByWildcardPath : ipIter->second.routesByPath);
     ROUTES_BY_PATH::iterator pathIter = routesByPath.find(route.src.path);
     if (pathIter == routesByPath.end())
     {
@@ -1197,10 +1797,173 @@ void RouterThread::BuildRoutes(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &rou
     sRouteDst routeDst;
     routeDst.label = route.label;
     routeDst.dst = route.dst;
+    routeDst.path.Compile(route.dst.path.toStdString());
+    if (route.dst.script)
+    {
+      // compiled here when scripts run on the router thread, otherwise by each script worker
+      sScriptSource source;
+      source.script = route.dst.scriptText;
+      source.label = route.label;
+      routeDst.script = static_cast<ScriptEngine::ID>(m_ScriptSources.size());
+      m_ScriptSources.push_back(source);
+      if (m_Settings.scriptWorkers == 0)
+        m_ScriptEngine->compile(source.script, source.label, &m_PrivateLog);
+    }
+    routeDst.staticDMXOptions = InitDMXOptions(route.src.protocol, routeDst);
+    routeDst.oscPassThrough = InitOSCPassThrough(route.src.protocol, srcPath, routeDst);
     routeDst.srcItemStateTableId = route.srcItemStateTableId;
     routeDst.dstItemStateTableId = route.dstItemStateTableId;
     destinations.push_back(routeDst);
   }
+
+  // start udp input threads, on a routing shard when nothing routed from their port needs the router thread
+  std::map<unsigned short, RouteShardThread *> shardsByPort;
+  size_t nextShard = 0;
+  for (size_t i = 0; i < udpInRoutes.size(); ++i)
+  {
+    const Router::sRoute &route = udpInRoutes[i];
+
+    RouteShardThread *shard = nullptr;
+    if (!routeShards.empty())
+    {
+      std::map<unsigned short, RouteShardThread *>::const_iterator shardIter = shardsByPort.find(route.src.addr.port);
+      if (shardIter == shardsByPort.end())
+      {
+        UDP_OUT_THREADS outputs;
+        ROUTES_BY_PORT::const_iterator portIter = routesByPort.find(route.src.addr.port);
+        if (portIter != routesByPort.end() && IsShardable(portIter->second, udpOutThreads, tcpClientThreads, tcpServerThreads, outputs))
+        {
+          shard = routeShards[(nextShard++) % routeShards.size()];
+          for (UDP_OUT_THREADS::const_iterator j = outputs.begin(); j != outputs.end(); ++j)
+          {
+            j->second->SetSharded(true);
+            shard->AddOutput(j->second);
+          }
+        }
+
+        shardIter = shardsByPort.insert(std::make_pair(route.src.addr.port, shard)).first;
+      }
+
+      shard = shardIter->second;
+    }
+
+    UdpInReactorThread *reactor = udpInReactors.empty() ? nullptr : udpInReactors[i % udpInReactors.size()];
+    EosUdpInThread *thread = udpInThreads[route.src.addr];
+    thread->SetPSNBundle(m_Settings.psnBundle);
+    if (route.src.protocol == Protocol::kPSN)
+    {
+      // only encode the PSN messages some route from this port takes
+      std::vector<std::string> paths;
+      ROUTES_BY_PORT::const_iterator portIter = routesByPort.find(route.src.addr.port);
+      if (portIter != routesByPort.end())
+      {
+        for (ROUTES_BY_IP::const_iterator ipIter = portIter->second.begin(); ipIter != portIter->second.end(); ++ipIter)
+        {
+          for (ROUTES_BY_PATH::const_iterator pathIter = ipIter->second.routesByPath.begin(); pathIter != ipIter->second.routesByPath.end(); ++pathIter)
+            paths.push_back(pathIter->first.toUtf8().toStdString());
+          for (ROUTES_BY_PATH::const_iterator pathIter = ipIter->second.routesByWildcardPath.begin(); pathIter != ipIter->second.routesByWildcardPath.end(); ++pathIter)
+            paths.push_back(pathIter->first.toUtf8().toStdString());
+        }
+      }
+      thread->SetPSNFilter(paths, static_cast<uint16_t>(m_Settings.psnTrackerMin), static_cast<uint16_t>(m_Settings.psnTrackerMax));
+    }
+    thread->Start(route.src.addr, route.src.multicastIP, route.src.protocol, route.srcItemStateTableId, m_ReconnectDelay, mute, shard ? &shard->GetWakeup() : &m_Wakeup, m_Settings.udpBatchRecv,
+                  m_Settings.udpRecvBufferSize, reactor);
+
+    if (shard)
+    {
+      thread->SetSharded(true);
+      shard->AddInput(thread);
+    }
+  }
+
+  // discard routing shards left without inputs, the rest are started once the route tables are built
+  for (ROUTE_SHARDS::iterator i = routeShards.begin(); i != routeShards.end();)
+  {
+    if ((*i)->empty())
+    {
+      delete *i;
+      i = routeShards.erase(i);
+    }
+    else
+      i++;
+  }
+
+  if (!routeShards.empty())
+    m_PrivateLog.AddInfo(QString("udp routing sharded across %1 threads").arg(static_cast<qulonglong>(routeShards.size())).toUtf8().constData());
+
+  // start shared udp input threads, discarding any left without inputs
+  int cpuCount = QThread::idealThreadCount();
+  for (UDP_IN_REACTORS::iterator i = udpInReactors.begin(); i != udpInReactors.end();)
+  {
+    UdpInReactorThread *reactor = *i;
+    if (reactor->empty())
+    {
+      delete reactor;
+      i = udpInReactors.erase(i);
+      continue;
+    }
+
+    int cpu = -1;
+    if (m_Settings.udpInReactorPinned && cpuCount > 0)
+      cpu = static_cast<int>((i - udpInReactors.begin()) % cpuCount);
+    reactor->Start(cpu);
+    i++;
+  }
+
+  if (!udpInReactors.empty())
+    m_PrivateLog.AddInfo(QString("udp input shared by %1 reactor threads").arg(static_cast<qulonglong>(udpInReactors.size())).toUtf8().constData());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::IsShardable(const ROUTES_BY_IP &routesByIp, const UDP_OUT_THREADS &udpOutThreads, const TCP_CLIENT_THREADS &tcpClientThreads, const TCP_SERVER_THREADS &tcpServerThreads,
+                               UDP_OUT_THREADS &outputs)
+{
+  for (ROUTES_BY_IP::const_iterator ipIter = routesByIp.begin(); ipIter != routesByIp.end(); ++ipIter)
+  {
+    if (!IsShardable(ipIter->second.routesByPath, udpOutThreads, tcpClientThreads, tcpServerThreads, outputs) ||
+        !IsShardable(ipIter->second.routesByWildcardPath, udpOutThreads, tcpClientThreads, tcpServerThreads, outputs))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::IsShardable(const ROUTES_BY_PATH &routesByPath, const UDP_OUT_THREADS &udpOutThreads, const TCP_CLIENT_THREADS &tcpClientThreads, const TCP_SERVER_THREADS &tcpServerThreads,
+                               UDP_OUT_THREADS &outputs)
+{
+  for (ROUTES_BY_PATH::const_iterator pathIter = routesByPath.begin(); pathIter != routesByPath.end(); ++pathIter)
+  {
+    const ROUTE_DESTINATIONS &destinations = pathIter->second;
+    for (ROUTE_DESTINATIONS::const_iterator dstIter = destinations.begin(); dstIter != destinations.end(); ++dstIter)
+    {
+      const EosRouteDst &dst = dstIter->dst;
+
+      // scripts and non-OSC outputs share router thread state, RouteShardThread::ProcessRecvPacket relies on this to call MakeOSCPacket
+      if (dst.script || dst.protocol == Protocol::kPSN || dst.protocol == Protocol::ksACN || dst.protocol == Protocol::kArtNet || dst.protocol == Protocol::kMIDI)
+        return false;
+
+      // replies to the sender create udp out threads on demand
+      if (dst.addr.ip.isEmpty() || dst.addr.port == 0)
+        return false;
+
+      if (tcpClientThreads.find(dst.addr) != tcpClientThreads.end() || tcpServerThreads.find(dst.addr) != tcpServerThreads.end())
+        return false;
+
+      UDP_OUT_THREADS::const_iterator outIter = udpOutThreads.find(dst.addr);
+      if (outIter == udpOutThreads.end())
+        return false;
+
+      outputs[dst.addr] = outIter->second;
+    }
+  }
+
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1239,6 +2002,108 @@ bool RouterThread::HasProtocolOutput(const ROUTES_BY_PATH &routesByPath, Protoco
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void RouterThread::GetDMXPathOptions(const OSCMessageView &osc, sDMXPathOptions &options)
+{
+  options = sDMXPathOptions();
+  options.priority = static_cast<uint8_t>(DEFAULT_PRIORITY);
+
+  for (size_t part = 0; part < osc.GetSegmentCount(); ++part)
+  {
+    int n = 0;
+    if (osc.SegmentEquals(part, "offset"))
+    {
+      if (osc.GetSegmentInt(part + 1, n))
+      {
+        options.offset = std::max(0, n - 1);
+        ++part;
+      }
+    }
+    else if (osc.SegmentEquals(part, "priority"))
+    {
+      if (osc.GetSegmentInt(part + 1, n) && n >= 0)
+      {
+        options.priority = static_cast<uint8_t>(std::min(n, 255));
+        options.hasPriority = true;
+        ++part;
+      }
+    }
+    else if (osc.SegmentEquals(part, "perChannelPriority"))
+    {
+      if (osc.GetSegmentInt(part + 1, n) && n >= 0)
+      {
+        options.priority = static_cast<uint8_t>(std::min(n, 255));
+        options.hasPriority = true;
+        options.perChannelPriority = true;
+        ++part;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::InitDMXOptions(Protocol srcProtocol, sRouteDst &routeDst)
+{
+  if (routeDst.dst.protocol != Protocol::ksACN && routeDst.dst.protocol != Protocol::kArtNet)
+    return false;
+
+  if (routeDst.dst.script)
+    return false;
+
+  // DMX input is copied straight across, other input is written as is so transformed arguments still need the message
+  bool dmxInput = (srcProtocol == Protocol::ksACN || srcProtocol == Protocol::kArtNet);
+  if (!dmxInput && routeDst.dst.hasAnyTransforms())
+    return false;
+
+  // same path MakeOSCMessage renders, replacements and arguments from the path still need it per packet
+  OSCMessageView osc;
+  if (routeDst.path.empty())
+  {
+    // OSC input is forwarded with its own path
+    if (!dmxInput)
+      return false;
+  }
+  else
+  {
+    if (routeDst.path.HasReplacements())
+      return false;
+
+    const std::string &path = routeDst.path.GetLiteralText();
+    size_t index = path.find('=');
+    if (index != std::string::npos && index > 0)
+      return false;
+
+    osc.SetPath(path.data(), path.size());
+  }
+
+  GetDMXPathOptions(osc, routeDst.dmxOptions);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::InitOSCPassThrough(Protocol srcProtocol, const std::string &srcPath, const sRouteDst &routeDst)
+{
+  if (srcProtocol != Protocol::kOSC || routeDst.dst.script || routeDst.dst.hasAnyTransforms())
+    return false;
+
+  if (routeDst.dst.protocol == Protocol::kPSN || routeDst.dst.protocol == Protocol::ksACN || routeDst.dst.protocol == Protocol::kArtNet || routeDst.dst.protocol == Protocol::kMIDI)
+    return false;
+
+  // no path, or the exact path it was routed from, renders the input path unchanged
+  if (routeDst.path.empty())
+    return true;
+
+  if (routeDst.path.HasReplacements() || OSCPathPattern::IsPattern(srcPath))
+    return false;
+
+  const std::string &path = routeDst.path.GetLiteralText();
+  size_t index = path.find('=');
+  return (path == srcPath && (index == std::string::npos || index == 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void RouterThread::DestroysACN(sACN &sacn)
 {
   if (sacn.server)
@@ -1270,12 +2135,12 @@ void RouterThread::DestroysACN(sACN &sacn)
 
 void RouterThread::DestroyArtNet(ArtNet &artnet)
 {
-  for (ARTNET_RECV_UNIVERSE_LIST::iterator i = artnet.inputs.begin(); i != artnet.inputs.end(); ++i)
+  if (artnet.wakeThread)
   {
-    artnet_stop(i->second.node);
-    artnet_destroy(i->second.node);
+    artnet.wakeThread->Stop();
+    delete artnet.wakeThread;
+    artnet.wakeThread = nullptr;
   }
-  artnet.inputs.clear();
 
   if (artnet.server)
   {
@@ -1283,6 +2148,11 @@ void RouterThread::DestroyArtNet(ArtNet &artnet)
     artnet_destroy(artnet.server);
     artnet.server = nullptr;
   }
+
+  std::fill(artnet.inputIndex.begin(), artnet.inputIndex.end(), 0);
+  artnet.inputs.clear();
+  artnet.dirty.clear();
+  artnet.pollReplyPages.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1348,6 +2218,11 @@ void RouterThread::BuildsACN(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &route
       {
         m_PrivateLog.AddInfo(QLatin1String("sACN client started").toUtf8().constData());
 
+        if (m_Settings.latencyStats)
+          m_PrivateLog.AddInfo(QStringLiteral("sACN merge kernel %1, %2 universes/ms").arg(QLatin1String(DMXMerge::GetKernelName())).arg(DMXMerge::Benchmark(), 0, 'f', 0).toUtf8().constData());
+        else
+          m_PrivateLog.AddInfo(QStringLiteral("sACN merge kernel %1").arg(QLatin1String(DMXMerge::GetKernelName())).toUtf8().constData());
+
         for (ROUTES_BY_PORT::const_iterator universeIter = routesBysACNUniverse.begin(); universeIter != routesBysACNUniverse.end(); ++universeIter)
         {
           uint16_t universeNumber = universeIter->first;
@@ -1413,225 +2288,1145 @@ void RouterThread::BuildsACN(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &route
 
 ////////////////////////////////////////////////////////////////////////////////
 
-int ArtNetRecv(artnet_node n, void *pp, void *d)
-{
-  artnet_packet p = reinterpret_cast<artnet_packet>(pp);
-  if (!p)
-    return 0;
+int ArtNetRecv(artnet_node /*n*/, void *pp, void *d)
+{
+  artnet_packet p = reinterpret_cast<artnet_packet>(pp);
+  if (!p)
+    return 0;
+
+  RouterThread::ArtNet *artnet = reinterpret_cast<RouterThread::ArtNet *>(d);
+  if (!artnet)
+    return 0;
+
+  if (p->type == ARTNET_REPLY)
+  {
+    // output ports of each node, one reply per bind index, so not libartnet's node list which keeps one entry per ip
+    if (p->length < static_cast<int>(offsetof(artnet_reply_t, swvideo)))
+      return 1;
+
+    const artnet_reply_t &reply = p->data.ar;
+    unsigned int ip = ((static_cast<unsigned int>(reply.ip[0]) << 24) | (static_cast<unsigned int>(reply.ip[1]) << 16) | (static_cast<unsigned int>(reply.ip[2]) << 8) | reply.ip[3]);
+    if (ip == 0)
+      ip = static_cast<unsigned int>(htonl(p->from.s_addr));
+
+    int portCount = std::min(static_cast<int>(reply.numbports), static_cast<int>(ARTNET_MAX_PORTS));
+    for (int i = 0; i < portCount; ++i)
+    {
+      if ((reply.porttypes[i] & 0x80) == 0)
+        continue;  // no ArtNet to DMX output on this port
+
+      uint16_t universeNumber = static_cast<uint16_t>(((reply.subH & 0x7f) << 8) | ((reply.sub & 0xf) << 4) | (reply.swout[i] & 0xf));
+      artnet->AddSubscriber(universeNumber, ip);
+    }
+    return 1;
+  }
+
+  if (p->type != ARTNET_DMX)
+    return 0;
+
+  // every ArtDmx arrives here on the one shared socket, consumed here so libartnet does not also merge it
+  const uint8_t *universe = reinterpret_cast<const uint8_t *>(&p->data.admx.universe);
+  uint16_t universeNumber = static_cast<uint16_t>((universe[0] | (universe[1] << 8)) & 0x7fff);
+  RouterThread::ArtNetRecvUniverse *input = artnet->FindInput(universeNumber);
+  if (!input)
+    return 1;
+
+  size_t header = (sizeof(artnet_dmx_t) - ARTNET_DMX_LENGTH);
+  if (p->length <= static_cast<int>(header))
+    return 1;
+
+  size_t length = ((static_cast<size_t>(p->data.admx.lengthHi) << 8) | p->data.admx.length);
+  length = std::min(length, std::min(static_cast<size_t>(p->length) - header, input->dmx.size()));
+  memcpy(input->dmx.data(), p->data.admx.data, length);
+  input->length = length;
+  input->ip = static_cast<unsigned int>(htonl(p->from.s_addr));
+  if (!input->dirty)
+  {
+    input->dirty = true;
+    artnet->dirty.push_back(static_cast<uint16_t>(input - artnet->inputs.data()));
+  }
+  return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int ArtNetPoll(artnet_node n, void * /*pp*/, void *d)
+{
+  RouterThread::ArtNet *artnet = reinterpret_cast<RouterThread::ArtNet *>(d);
+  if (!artnet)
+    return 0;
+
+  // the raw node has no ports of its own for libartnet to reply with, so controllers find the input universes from these pages
+  for (ArtNetPollReply::PAGES::const_iterator i = artnet->pollReplyPages.begin(); i != artnet->pollReplyPages.end(); ++i)
+    artnet_raw_send_poll_reply(n, i->bindIndex, i->net, i->subNet, i->portCount, i->universes.data());
+  return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::BuildArtNet(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &routesBysACNUniverse, ROUTES_BY_PORT &routesByArtNetUniverse, ROUTES_BY_PORT &routesByMIDI, ArtNet &artnet)
+{
+  bool hasInput = !routesByArtNetUniverse.empty();
+  bool hasOutput = HasProtocolOutput(routesByPort, Protocol::kArtNet) || HasProtocolOutput(routesBysACNUniverse, Protocol::kArtNet) || HasProtocolOutput(routesByArtNetUniverse, Protocol::kArtNet) ||
+                   HasProtocolOutput(routesByMIDI, Protocol::kArtNet);
+  if (!hasInput && !hasOutput)
+    return;
+
+  // one raw node sends every output universe and receives every input universe
+  artnet.server = artnet_new(m_Settings.artNetIP.isEmpty() ? nullptr : m_Settings.artNetIP.toLatin1().constData(), 0);
+  if (artnet.server)
+  {
+    m_PrivateLog.AddInfo(QLatin1String("ArtNet server created").toUtf8().constData());
+
+    artnet_set_node_type(artnet.server, ARTNET_RAW);
+    artnet_set_short_name(artnet.server, VER_PRODUCTNAME_STR);
+    artnet_set_long_name(artnet.server, VER_PRODUCTNAME_STR);
+    artnet_set_handler(artnet.server, ARTNET_RECV_HANDLER, ArtNetRecv, &artnet);
+    artnet_set_handler(artnet.server, ARTNET_POLL_HANDLER, ArtNetPoll, &artnet);
+
+    if (artnet_start(artnet.server) != ARTNET_EOK)
+    {
+      m_PrivateLog.AddInfo(QLatin1String("ArtNet server startup failed").toUtf8().constData());
+      artnet_destroy(artnet.server);
+      artnet.server = nullptr;
+    }
+    else
+      m_PrivateLog.AddInfo(QLatin1String("ArtNet server started").toUtf8().constData());
+  }
+  else
+    m_PrivateLog.AddError(QLatin1String("ArtNet server creation failed").toUtf8().constData());
+
+  if (hasInput)
+  {
+    for (ROUTES_BY_PORT::const_iterator universeIter = routesByArtNetUniverse.begin(); universeIter != routesByArtNetUniverse.end(); ++universeIter)
+    {
+      const ROUTES_BY_IP &routesByIp = universeIter->second;
+      if (!artnet.server)
+      {
+        SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_NOT_CONNECTED);
+        continue;
+      }
+
+      if (universeIter->first >= ARTNET_PORT_ADDRESS_COUNT)
+      {
+        SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_NOT_CONNECTED);
+        m_PrivateLog.AddError(QStringLiteral("ArtNet universe %1 is not a valid port address (0-%2)").arg(universeIter->first).arg(ARTNET_PORT_ADDRESS_COUNT - 1).toUtf8().constData());
+        continue;
+      }
+
+      uint16_t universeNumber = static_cast<uint16_t>(universeIter->first);
+      if (!artnet.FindInput(universeNumber))
+      {
+        ArtNetRecvUniverse input;
+        input.number = universeNumber;
+        artnet.inputs.push_back(input);
+        artnet.inputIndex[universeNumber] = static_cast<uint16_t>(artnet.inputs.size());
+        m_PrivateLog.AddInfo(QStringLiteral("ArtNet started listening on universe %1").arg(universeNumber).toUtf8().constData());
+      }
+
+      SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_CONNECTED);
+    }
+
+    artnet.dirty.reserve(artnet.inputs.size());
+
+    ArtNetPollReply::PORT_ADDRESSES portAddresses;
+    portAddresses.reserve(artnet.inputs.size());
+    for (ARTNET_RECV_UNIVERSE_LIST::const_iterator i = artnet.inputs.begin(); i != artnet.inputs.end(); ++i)
+      portAddresses.push_back(i->number);
+
+    size_t advertised = ArtNetPollReply::BuildPages(portAddresses, artnet.pollReplyPages);
+    if (advertised < portAddresses.size())
+    {
+      m_PrivateLog.AddWarning(QStringLiteral("ArtPollReply advertises %1 of %2 input universes, %3 bind indexes at most")
+                                  .arg(static_cast<qulonglong>(advertised))
+                                  .arg(static_cast<qulonglong>(portAddresses.size()))
+                                  .arg(static_cast<int>(ArtNetPollReply::MAX_PAGES))
+                                  .toUtf8()
+                                  .constData());
+    }
+  }
+
+  // ArtDmx, and ArtPollReply from nodes found for unicast output, wake the router instead of waiting for its next pass
+  if (artnet.server && (!artnet.inputs.empty() || (hasOutput && m_Settings.artNetUnicast)))
+  {
+    artnet.wakeThread = new ArtNetWakeThread();
+    artnet.wakeThread->Start(artnet.server, m_Wakeup);
+  }
+
+  if (hasOutput)
+  {
+    ItemState::EnumState state = artnet.server ? ItemState::STATE_CONNECTED : ItemState::STATE_NOT_CONNECTED;
+    SetItemState(routesByPort, Protocol::kArtNet, state);
+    SetItemState(routesBysACNUniverse, Protocol::kArtNet, state);
+    SetItemState(routesByArtNetUniverse, Protocol::kArtNet, state);
+    SetItemState(routesByMIDI, Protocol::kArtNet, state);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::BuildMIDI(ROUTES_BY_PORT &routesByMIDI, MIDI &midi)
+{
+  if (routesByMIDI.empty())
+    return;
+
+  for (ROUTES_BY_PORT::const_iterator portIter = routesByMIDI.begin(); portIter != routesByMIDI.end(); ++portIter)
+  {
+    unsigned int port = portIter->first;
+    const ROUTES_BY_IP &routesByIp = portIter->second;
+
+    MIDI_INPUT_LIST::const_iterator inputIter = midi.inputs.find(port);
+    if (inputIter != midi.inputs.end())
+      continue;  // already listening on this port
+
+    MIDIIn midiIn;
+
+    try
+    {
+      std::shared_ptr<MIDIInQueue> queue = std::make_shared<MIDIInQueue>();
+      queue->wakeup = &m_Wakeup;
+      std::shared_ptr<RtMidiIn> input = std::make_shared<RtMidiIn>();
+      input->openPort(port, VER_PRODUCTNAME_STR);
+      input->ignoreTypes(/*midiSysex*/ false, /*midiTime*/ false, /*midiSense*/ false);
+      input->setCallback(MIDIInCallback, queue.get());  // wakes the router instead of it polling getMessage
+      midiIn.name = input->getPortName(port);
+      midiIn.queue = queue;
+      midiIn.midi = input;
+    }
+    catch (RtMidiError &error)
+    {
+      m_PrivateLog.AddError("RtMidiIn openPort error: " + error.getMessage());
+    }
+
+    if (!midiIn.midi)
+    {
+      SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_NOT_CONNECTED);
+      continue;
+    }
+
+    SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_CONNECTED);
+    m_PrivateLog.AddInfo(QStringLiteral("MIDI started listening on port %1").arg(port).toUtf8().constData());
+    midi.inputs[port] = midiIn;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::MIDIInCallback(double /*timeStamp*/, std::vector<unsigned char> *message, void *userData)
+{
+  MIDIInQueue *queue = static_cast<MIDIInQueue *>(userData);
+  if (!queue || !message || message->empty())
+    return;
+
+  MIDIInMessage item;
+  if (message->size() <= item.bytes.size())
+  {
+    std::copy(message->begin(), message->end(), item.bytes.begin());
+    item.size = static_cast<uint8_t>(message->size());
+  }
+  else
+  {
+    item.sysEx = queue->sysExSpare;
+    queue->sysExSpare = nullptr;
+    if (!item.sysEx && !queue->sysExFree.Pop(item.sysEx))
+    {
+      // every SysEx buffer is still waiting for the router thread
+      queue->sysExDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    item.sysEx->assign(message->begin(), message->end());
+  }
+
+  if (queue->messages.Push(std::move(item)))
+    queue->wakeup->Signal();
+  else if (item.sysEx)
+    queue->sysExSpare = item.sysEx;  // a failed push leaves the item untouched, reuse its buffer next time
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+EosUdpOutThread *RouterThread::CreateUdpOutThread(const EosAddr &addr, ItemStateTable::ID itemStateTableId, UDP_OUT_THREADS &udpOutThreads)
+{
+  if (!addr.ip.isEmpty() && addr.port != 0)
+  {
+    UDP_OUT_THREADS::iterator i = udpOutThreads.find(addr);
+    if (i == udpOutThreads.end())
+    {
+      EosUdpOutThread *thread = new EosUdpOutThread();
+      udpOutThreads[addr] = thread;
+      thread->Start(addr, itemStateTableId, m_ReconnectDelay, m_Settings.udpBatchSend, m_Settings.udpBundleSize, 1 + m_RouteShardCount);
+      return thread;
+    }
+    else
+      return i->second;
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteTable::Clear()
+{
+  m_Entries.clear();
+  m_EntrySlots.clear();
+  m_Groups.clear();
+  m_GroupSlots.clear();
+  m_Paths.clear();
+  m_Destinations.clear();
+  m_Matches.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteTable::Build(const ROUTES_BY_PORT &routesByPort)
+{
+  Clear();
+
+  // size destination array up front, so ranges into it stay valid
+  size_t destinationCount = 0;
+  for (ROUTES_BY_PORT::const_iterator portIter = routesByPort.begin(); portIter != routesByPort.end(); ++portIter)
+  {
+    for (ROUTES_BY_IP::const_iterator ipIter = portIter->second.begin(); ipIter != portIter->second.end(); ++ipIter)
+    {
+      for (ROUTES_BY_PATH::const_iterator pathIter = ipIter->second.routesByPath.begin(); pathIter != ipIter->second.routesByPath.end(); ++pathIter)
+        destinationCount += pathIter->second.size();
+      for (ROUTES_BY_PATH::const_iterator pathIter = ipIter->second.routesByWildcardPath.begin(); pathIter != ipIter->second.routesByWildcardPath.end(); ++pathIter)
+        destinationCount += pathIter->second.size();
+    }
+  }
+  m_Destinations.reserve(destinationCount);
+
+  for (ROUTES_BY_PORT::const_iterator portIter = routesByPort.begin(); portIter != routesByPort.end(); ++portIter)
+  {
+    for (ROUTES_BY_IP::const_iterator ipIter = portIter->second.begin(); ipIter != portIter->second.end(); ++ipIter)
+    {
+      AddDestinations(portIter->first, ipIter->first, ipIter->second.routesByPath, /*wildcard*/ false);
+      AddDestinations(portIter->first, ipIter->first, ipIter->second.routesByWildcardPath, /*wildcard*/ true);
+    }
+  }
+
+  InitSlots(m_Entries.size(), m_EntrySlots);
+  size_t mask = (m_EntrySlots.size() - 1);
+  for (size_t i = 0; i < m_Entries.size(); ++i)
+  {
+    size_t slot = (static_cast<size_t>(m_Entries[i].hash) & mask);
+    while (m_EntrySlots[slot] != INVALID_INDEX)
+      slot = ((slot + 1) & mask);
+    m_EntrySlots[slot] = static_cast<uint32_t>(i);
+  }
+
+  InitSlots(m_Groups.size(), m_GroupSlots);
+  mask = (m_GroupSlots.size() - 1);
+  for (size_t i = 0; i < m_Groups.size(); ++i)
+  {
+    size_t slot = (static_cast<size_t>(Hash(m_Groups[i].port, m_Groups[i].ip, HashPath(nullptr, 0))) & mask);
+    while (m_GroupSlots[slot] != INVALID_INDEX)
+      slot = ((slot + 1) & mask);
+    m_GroupSlots[slot] = static_cast<uint32_t>(i);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteTable::AddDestinations(unsigned short port, unsigned int ip, const ROUTES_BY_PATH &routesByPath, bool wildcard)
+{
+  if (routesByPath.empty())
+    return;
+
+  sGroup *group = nullptr;
+  if (wildcard)
+  {
+    m_Groups.push_back(sGroup());
+    group = &m_Groups.back();
+    group->ip = ip;
+    group->port = port;
+    group->wildcards.reserve(routesByPath.size());
+  }
+
+  for (ROUTES_BY_PATH::const_iterator pathIter = routesByPath.begin(); pathIter != routesByPath.end(); ++pathIter)
+  {
+    sRouteDstRange range;
+    range.first = (m_Destinations.data() + m_Destinations.size());
+    range.count = pathIter->second.size();
+    m_Destinations.insert(m_Destinations.end(), pathIter->second.begin(), pathIter->second.end());
+
+    std::string path = pathIter->first.toUtf8().toStdString();
+    if (group)
+    {
+      if (group->matcher.Add(path, group->wildcards.size()))
+        group->wildcards.push_back(range);
+    }
+    else
+    {
+      sEntry entry;
+      entry.hash = Hash(port, ip, HashPath(path.data(), path.size()));
+      entry.ip = ip;
+      entry.port = port;
+      entry.pathOffset = static_cast<uint32_t>(m_Paths.size());
+      entry.pathLen = static_cast<uint32_t>(path.size());
+      entry.destinations = range;
+      m_Paths.append(path);
+      m_Entries.push_back(entry);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteTable::Find(unsigned short port, unsigned int ip, bool isOSC, const char *path, size_t pathLen, DESTINATIONS_LIST &destinations) const
+{
+  if (empty())
+    return;
+
+  // the path is hashed once, then combined with each (port, ip) looked up
+  if (!isOSC)
+    pathLen = 0;
+  uint64_t pathHash = HashPath(path, pathLen);
+
+  // send to matching ips
+  FindAll(port, ip, pathHash, path, pathLen, destinations);
+
+  // send to unspecified ips
+  if (ip != 0)
+    FindAll(port, 0, pathHash, path, pathLen, destinations);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteTable::FindAll(unsigned short port, unsigned int ip, uint64_t pathHash, const char *path, size_t pathLen, DESTINATIONS_LIST &destinations) const
+{
+  // send to any routes with an explicit path specified
+  if (pathLen != 0)
+  {
+    // exact matches
+    const sEntry *entry = FindEntry(port, ip, pathHash, path, pathLen);
+    if (entry)
+      destinations.push_back(entry->destinations);
+
+    // wildcard matches, in the same order as routesByWildcardPath
+    const sGroup *group = FindGroup(port, ip);
+    if (group)
+    {
+      m_Matches.clear();
+      group->matcher.Match(path, pathLen, m_Matches);
+      for (OSCPathMatcher::IDS::const_iterator i = m_Matches.begin(); i != m_Matches.end(); i++)
+        destinations.push_back(group->wildcards[*i]);
+    }
+  }
+
+  // send to any routes without an explicit path specified
+  const sEntry *entry = FindEntry(port, ip, HashPath(nullptr, 0), nullptr, 0);
+  if (entry)
+    destinations.push_back(entry->destinations);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const RouterThread::RouteTable::sEntry *RouterThread::RouteTable::FindEntry(unsigned short port, unsigned int ip, uint64_t pathHash, const char *path, size_t pathLen) const
+{
+  if (m_EntrySlots.empty())
+    return nullptr;
+
+  uint64_t hash = Hash(port, ip, pathHash);
+  size_t mask = (m_EntrySlots.size() - 1);
+  for (size_t slot = (static_cast<size_t>(hash) & mask); m_EntrySlots[slot] != INVALID_INDEX; slot = ((slot + 1) & mask))
+  {
+    const sEntry &entry = m_Entries[m_EntrySlots[slot]];
+    if (entry.hash == hash && entry.ip == ip && entry.port == port && entry.pathLen == pathLen && (pathLen == 0 || memcmp(&m_Paths[entry.pathOffset], path, pathLen) == 0))
+      return &entry;
+  }
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const RouterThread::RouteTable::sGroup *RouterThread::RouteTable::FindGroup(unsigned short port, unsigned int ip) const
+{
+  if (m_GroupSlots.empty())
+    return nullptr;
+
+  size_t mask = (m_GroupSlots.size() - 1);
+  for (size_t slot = (static_cast<size_t>(Hash(port, ip, HashPath(nullptr, 0))) & mask); m_GroupSlots[slot] != INVALID_INDEX; slot = ((slot + 1) & mask))
+  {
+    const sGroup &group = m_Groups[m_GroupSlots[slot]];
+    if (group.ip == ip && group.port == port)
+      return &group;
+  }
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteTable::InitSlots(size_t count, SLOTS &slots)
+{
+  slots.clear();
+  if (count == 0)
+    return;
+
+  // power of 2, at most half full
+  size_t size = 8;
+  while (size < (count * 2))
+    size <<= 1;
+
+  slots.resize(size, INVALID_INDEX);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t RouterThread::RouteTable::HashPath(const char *path, size_t pathLen)
+{
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < pathLen; ++i)
+  {
+    hash ^= static_cast<unsigned char>(path[i]);
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t RouterThread::RouteTable::Hash(unsigned short port, unsigned int ip, uint64_t pathHash)
+{
+  // mix port and ip into the path hash
+  uint64_t hash = pathHash;
+  hash ^= ((static_cast<uint64_t>(port) << 32) | ip) * 0x9e3779b97f4a7c15ull;
+  hash ^= (hash >> 29);
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::RouteShardThread::RouteShardThread(RouterThread &router, size_t producer)
+  : m_Router(router)
+  , m_Producer(producer)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::RouteShardThread::~RouteShardThread()
+{
+  Stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::AddInput(EosUdpInThread *input)
+{
+  m_Inputs.push_back(input);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::AddOutput(EosUdpOutThread *output)
+{
+  m_Outputs[output->GetAddr()] = output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::Start(const ROUTES_BY_PORT &routesByPort)
+{
+  Stop();
+
+  // only the routes from this shard's ports
+  ROUTES_BY_PORT shardRoutesByPort;
+  for (INPUTS::const_iterator i = m_Inputs.begin(); i != m_Inputs.end(); ++i)
+  {
+    ROUTES_BY_PORT::const_iterator portIter = routesByPort.find((*i)->GetAddr().port);
+    if (portIter != routesByPort.end())
+      shardRoutesByPort.insert(*portIter);
+  }
+
+  m_RouteTable.Build(shardRoutesByPort);
+
+  m_Run = true;
+  start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::Stop()
+{
+  m_Run = false;
+  m_Wakeup.Signal();
+  wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::Flush(EosLog::LOG_Q &logQ)
+{
+  m_Mutex.lock();
+  m_Log.Flush(logQ);
+  m_Mutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::run()
+{
+  m_PrivateLog.AddInfo(QString("routing shard %1 started with %2 inputs").arg(static_cast<qulonglong>(m_Producer)).arg(static_cast<qulonglong>(m_Inputs.size())).toUtf8().constData());
+  UpdateLog();
+
+  OSCParser oscBundleParser;
+  oscBundleParser.SetRoot(new OSCBundleMethod());
+  OSCBundleMethod *bundleHandler = static_cast<OSCBundleMethod *>(oscBundleParser.GetRoot());
+  DESTINATIONS_LIST routingDestinationList;
+  EosUdpInThread::RECV_Q recvQ;
+  EosUdpInThread::RECV_Q bundleQ;
+  MuteAll muteAll;
+
+  while (m_Run)
+  {
+    // one snapshot of mutes per pass, instead of a router lock per destination
+    m_Router.GetMutes(muteAll, m_Muted);
+    m_Activity.assign(m_Muted.size(), false);
+    m_HasActivity = false;
+
+    for (INPUTS::const_iterator i = m_Inputs.begin(); i != m_Inputs.end(); ++i)
+    {
+      EosUdpInThread *input = *i;
+      input->PopPackets(recvQ);
+
+      for (EosUdpInThread::RECV_Q::iterator j = recvQ.begin(); j != recvQ.end(); j++)
+      {
+        EosUdpInThread::sRecvPacket &recvPacket = *j;
+
+        char *buf = recvPacket.packet.GetData();
+        size_t packetSize = static_cast<size_t>(std::max(0, recvPacket.packet.GetSize()));
+        if (OSCParser::IsOSCPacket(buf, packetSize))
+        {
+          bundleHandler->SetIP(recvPacket.ip);
+          oscBundleParser.ProcessPacket(*this, buf, packetSize);
+          bundleHandler->Flush(bundleQ);
+          if (!bundleQ.empty())
+          {
+            for (EosUdpInThread::RECV_Q::iterator k = bundleQ.begin(); k != bundleQ.end(); k++)
+            {
+              k->recvTime = recvPacket.recvTime;
+              ProcessRecvPacket(muteAll.outgoing, input->GetAddr(), Protocol::kOSC, routingDestinationList, *k);
+            }
+
+            bundleQ.clear();
+            continue;
+          }
+        }
+
+        ProcessRecvPacket(muteAll.outgoing, input->GetAddr(), Protocol::kInvalid, routingDestinationList, recvPacket);
+      }
+
+      recvQ.clear();
+    }
+
+    if (m_HasActivity)
+      m_Router.SetItemActivity(m_Activity);
+
+    if (m_Router.m_Settings.latencyStats)
+    {
+      QString report;
+      if (m_LatencyStats.Report(10000, report))
+        m_PrivateLog.AddInfo(QStringLiteral("%1 (shard %2)").arg(report).arg(static_cast<qulonglong>(m_Producer)).toUtf8().constData());
+    }
+
+    UpdateLog();
+
+    // inputs signal this wakeup instead of the router's
+    m_Wakeup.Wait(100);
+  }
+
+  m_PrivateLog.AddInfo(QString("routing shard %1 ended").arg(static_cast<qulonglong>(m_Producer)).toUtf8().constData());
+  UpdateLog();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::ProcessRecvPacket(bool muteAllOutgoing, const EosAddr &addr, Protocol protocol, DESTINATIONS_LIST &routingDestinationList,
+                                                       EosUdpInThread::sRecvPacket &recvPacket)
+{
+  routingDestinationList.clear();
+
+  // find osc path null terminator
+  char *buf = recvPacket.packet.GetData();
+  size_t packetSize = ((recvPacket.packet.GetSize() > 0) ? static_cast<size_t>(recvPacket.packet.GetSize()) : 0);
+  size_t pathLen = 0;
+
+  if (protocol == Protocol::kOSC)
+  {
+    const void *end = memchr(buf, 0, packetSize);
+    if (end)
+      pathLen = static_cast<size_t>(static_cast<const char *>(end) - buf);
+  }
+
+  m_RouteTable.Find(addr.port, recvPacket.ip, protocol == Protocol::kOSC, buf, pathLen, routingDestinationList);
+
+  if (routingDestinationList.empty())
+    return;
+
+  size_t argsCount = 0;
+  OSCArgument *args = 0;
+  if (protocol == Protocol::kOSC)
+  {
+    argsCount = 0xffffffff;
+    args = OSCArgument::GetArgs(buf, packetSize, argsCount);
+  }
+
+  // every destination here is a known UDP address, checked when the shard was built
+  for (DESTINATIONS_LIST::const_iterator i = routingDestinationList.begin(); i != routingDestinationList.end(); i++)
+  {
+    for (const sRouteDst *j = i->first; j != (i->first + i->count); j++)
+    {
+      const sRouteDst &routeDst = *j;
+      SetActivity(routeDst.srcItemStateTableId);
+
+      if (muteAllOutgoing || (routeDst.dstItemStateTableId < m_Muted.size() && m_Muted[routeDst.dstItemStateTableId]))
+        continue;
+
+      UDP_OUT_THREADS::const_iterator outIter = m_Outputs.find(routeDst.dst.addr);
+      if (outIter == m_Outputs.end())
+        continue;
+
+      EosUdpOutThread *thread = outIter->second;
+      if (protocol == Protocol::kOSC && !routeDst.oscPassThrough)
+      {
+        // only safe off the router thread because IsShardable excludes routes with scripts, which run on the router's
+        // ScriptEngine, and shards never get sACN or ArtNet input, whose universes MakeSendPath would read
+        EosPacket oscPacket;
+        m_Router.MakeOSCPacket(m_PrivateLog, /*artnet*/ nullptr, addr, protocol, buf, pathLen, routeDst, args, argsCount, oscPacket);
+        if (oscPacket.GetDataConst() && oscPacket.GetSize() > 0 && thread->Send(oscPacket, m_Producer))
+          SetActivity(routeDst.dstItemStateTableId);
+      }
+      else if (thread->Send(recvPacket.packet, m_Producer))  // shares the received buffer
+        SetActivity(routeDst.dstItemStateTableId);
+    }
+  }
+
+  if (args)
+    delete[] args;
+
+  if (m_Router.m_Settings.latencyStats)
+    m_LatencyStats.Add(recvPacket.recvTime);
+
+  routingDestinationList.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::SetActivity(ItemStateTable::ID id)
+{
+  if (id < m_Activity.size() && !m_Activity[id])
+  {
+    m_Activity[id] = true;
+    m_HasActivity = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::UpdateLog()
+{
+  m_Mutex.lock();
+  m_Log.AddLog(m_PrivateLog);
+  m_Mutex.unlock();
+  m_PrivateLog.Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::OSCParserClient_Log(const std::string &message)
+{
+  m_PrivateLog.AddWarning(message);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::RouteShardThread::OSCParserClient_Send(const char * /*buf*/, size_t /*size*/) {}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::ScriptWorker::ScriptWorker(RouterThread &router, size_t index)
+  : m_Router(router)
+  , m_Index(index)
+  , m_Jobs(1024)
+  , m_Results(1024)
+  , m_Universes(UNIVERSE_BUFFER_COUNT)
+  , m_UniverseFree(UNIVERSE_BUFFER_COUNT)
+{
+  for (size_t i = 0; i < m_Universes.size(); ++i)
+    m_UniverseFree.Push(&m_Universes[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::ScriptWorker::~ScriptWorker()
+{
+  Stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::ScriptWorker::Start(const SCRIPT_SOURCES &scripts, const QString &showScript)
+{
+  Stop();
+
+  m_Scripts = scripts;
+  m_ShowScript = showScript;
+
+  m_Run = true;
+  start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::ScriptWorker::Stop()
+{
+  m_Run = false;
+  m_Wakeup.Signal();
+
+  // don't wait out a runaway script
+  m_Mutex.lock();
+  if (m_Engine)
+    m_Engine->js().setInterrupted(true);
+  m_Mutex.unlock();
+
+  wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::ScriptWorker::Push(sScriptJob &job)
+{
+  if (!m_Jobs.Push(std::move(job)))
+  {
+    // job was not moved, keep its buffer for the next one
+    if (job.universe)
+    {
+      m_UniverseSpare = job.universe;
+      job.universe = nullptr;
+    }
+    return false;
+  }
+
+  m_Wakeup.Signal();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::ScriptWorker::PopResults(SCRIPT_JOBS &results)
+{
+  m_Results.PopAll(results);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::SCRIPT_UNIVERSE *RouterThread::ScriptWorker::PopUniverse()
+{
+  SCRIPT_UNIVERSE *universe = m_UniverseSpare;
+  m_UniverseSpare = nullptr;
+  if (!universe && !m_UniverseFree.Pop(universe))
+  {
+    ++m_UniverseDropped;
+    return nullptr;
+  }
+
+  return universe;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::ScriptWorker::Watchdog(qint64 budgetMS)
+{
+  m_Mutex.lock();
+  if (m_Engine && !m_Interrupted && m_CallTimer.isValid() && m_CallTimer.elapsed() > budgetMS)
+  {
+    m_Engine->js().setInterrupted(true);
+    m_Interrupted = true;
+  }
+  m_Mutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+qint64 RouterThread::ScriptWorker::GetWatchdogTimeout(qint64 budgetMS)
+{
+  qint64 timeout = -1;
+  m_Mutex.lock();
+  if (m_Engine && !m_Interrupted && m_CallTimer.isValid())
+    timeout = std::max(budgetMS + 1 - m_CallTimer.elapsed(), static_cast<qint64>(0));  // Watchdog interrupts once elapsed exceeds the budget
+  m_Mutex.unlock();
+  return timeout;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::ScriptWorker::Flush(EosLog::LOG_Q &logQ)
+{
+  m_Mutex.lock();
+  m_Log.Flush(logQ);
+  m_Mutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::ScriptWorker::run()
+{
+  m_PrivateLog.AddInfo(QString("script worker %1 started").arg(static_cast<qulonglong>(m_Index)).toUtf8().constData());
+  UpdateLog();
+
+  ScriptEngine *engine = new ScriptEngine();
+
+  if (!m_ShowScript.isEmpty())
+  {
+    QString error = engine->evaluate(m_ShowScript, &m_PrivateLog);
+    if (!error.isEmpty())
+      m_PrivateLog.AddWarning(error.toStdString());
+  }
+
+  // same order as the router, so ids match
+  for (SCRIPT_SOURCES::const_iterator i = m_Scripts.begin(); i != m_Scripts.end(); ++i)
+    engine->compile(i->script, i->label, (m_Index == 0) ? &m_PrivateLog : nullptr);
+
+  m_Mutex.lock();
+  m_Engine = engine;
+  m_Mutex.unlock();
+
+  EosTimer reportTimer;
+  reportTimer.Start();
+  sScriptJob job;
+
+  while (m_Run)
+  {
+    while (m_Run && m_Jobs.Pop(job))
+      RunJob(*engine, job);
+
+    uint64_t dropped = m_Results.TakeDropped();
+    if (dropped != 0)
+      m_PrivateLog.AddWarning(QString("script worker %1 dropped %2 results").arg(static_cast<qulonglong>(m_Index)).arg(static_cast<qulonglong>(dropped)).toUtf8().constData());
 
-  if (p->type != ARTNET_DMX)
-    return 0;
+    if (reportTimer.GetExpired(m_Router.m_Settings.latencyStats ? 10000 : ScriptEngine::TIMING_REPORT_MS))
+    {
+      engine->reportTimings(m_PrivateLog);
+      reportTimer.Start();
+    }
 
-  RouterThread::ArtNet *artnet = reinterpret_cast<RouterThread::ArtNet *>(d);
-  if (!artnet)
-    return 0;
+    UpdateLog();
 
-  artnet->inputIPs[n] = static_cast<unsigned int>(htonl(p->from.s_addr));
-  return 0;
-}
+    m_Wakeup.Wait(100);
+  }
 
-int ArtNetUniverseData(artnet_node n, int port, void *d)
-{
-  if (!n || port != 0)
-    return 0;
+  m_Mutex.lock();
+  m_Engine = nullptr;
+  m_Mutex.unlock();
 
-  RouterThread::ArtNet *artnet = reinterpret_cast<RouterThread::ArtNet *>(d);
-  if (!artnet)
-    return 0;
+  delete engine;
 
-  artnet->dirty.insert(n);
-  return 0;
+  m_PrivateLog.AddInfo(QString("script worker %1 ended").arg(static_cast<qulonglong>(m_Index)).toUtf8().constData());
+  UpdateLog();
 }
 
-void RouterThread::BuildArtNet(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &routesBysACNUniverse, ROUTES_BY_PORT &routesByArtNetUniverse, ROUTES_BY_PORT &routesByMIDI, ArtNet &artnet)
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::ScriptWorker::RunJob(ScriptEngine &engine, sScriptJob &job)
 {
-  bool hasInput = !routesByArtNetUniverse.empty();
-  bool hasOutput = HasProtocolOutput(routesByPort, Protocol::kArtNet) || HasProtocolOutput(routesBysACNUniverse, Protocol::kArtNet) || HasProtocolOutput(routesByArtNetUniverse, Protocol::kArtNet) ||
-                   HasProtocolOutput(routesByMIDI, Protocol::kArtNet);
-  if (!hasInput && !hasOutput)
-    return;
+  const sRouteDst &routeDst = *job.routeDst;
 
-  if (hasInput)
+  // OSC input starts with its null terminated path
+  const char *path = job.input.GetDataConst();
+  size_t pathLen = 0;
+  size_t argsCount = 0;
+  OSCArgument *args = nullptr;
+  if (job.protocol == Protocol::kOSC)
   {
-    for (ROUTES_BY_PORT::const_iterator universeIter = routesByArtNetUniverse.begin(); universeIter != routesByArtNetUniverse.end(); ++universeIter)
-    {
-      uint8_t universeNumber = static_cast<uint8_t>(universeIter->first);
-      const ROUTES_BY_IP &routesByIp = universeIter->second;
-
-      ARTNET_RECV_UNIVERSE_LIST::const_iterator inputIter = artnet.inputs.find(universeNumber);
-      if (inputIter != artnet.inputs.end())
-        continue;  // already listening on this universe
-
-      artnet_node client = artnet_new(m_Settings.artNetIP.isEmpty() ? nullptr : m_Settings.artNetIP.toLatin1().constData(), 0);
-      if (!client)
-      {
-        SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_NOT_CONNECTED);
-        m_PrivateLog.AddError(QStringLiteral("ArtNet client listen on universe %1 creation failed").arg(universeNumber).toUtf8().constData());
-        continue;
-      }
+    size_t inputSize = static_cast<size_t>(std::max(0, job.input.GetSize()));
+    const void *end = (path ? memchr(path, 0, inputSize) : nullptr);
+    if (end)
+      pathLen = static_cast<size_t>(static_cast<const char *>(end) - path);
 
-      artnet_set_short_name(client, VER_PRODUCTNAME_STR);
-      artnet_set_long_name(client, VER_PRODUCTNAME_STR);
-      artnet_set_port_type(client, 0, ARTNET_ENABLE_OUTPUT, ARTNET_PORT_DMX);
-      if (universeNumber > 16)
-      {
-        artnet_set_subnet_addr(client, (universeNumber >> 4) & 0xf);
-        artnet_set_port_addr(client, 0, ARTNET_OUTPUT_PORT, universeNumber & 0xf);
-      }
-      else
-        artnet_set_port_addr(client, 0, ARTNET_OUTPUT_PORT, universeNumber);
-      artnet_set_handler(client, ARTNET_RECV_HANDLER, ArtNetRecv, &artnet);
+    argsCount = 0xffffffff;
+    args = OSCArgument::GetArgs(job.input.GetData(), inputSize, argsCount);
+  }
 
-      if (artnet_set_dmx_handler(client, ArtNetUniverseData, &artnet) != ARTNET_EOK)
-      {
-        SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_NOT_CONNECTED);
-        m_PrivateLog.AddError(QStringLiteral("ArtNet register listen on universe %1 failed").arg(universeNumber).toUtf8().constData());
-        artnet_destroy(client);
-        continue;
-      }
+  m_Mutex.lock();
+  m_CallTimer.start();
+  m_Mutex.unlock();
 
-      if (artnet_start(client) != ARTNET_EOK)
-      {
-        SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_NOT_CONNECTED);
-        m_PrivateLog.AddError(QStringLiteral("ArtNet start listen on universe %1 failed").arg(universeNumber).toUtf8().constData());
-        artnet_destroy(client);
-        continue;
-      }
+  // otherwise the router could sleep up to 100ms past the deadline before its watchdog sees this call
+  if (m_Router.m_Settings.scriptTimeoutMS != 0)
+    m_Router.m_Wakeup.Signal();
 
-      SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_CONNECTED);
-      m_PrivateLog.AddInfo(QStringLiteral("ArtNet started listening on universe %1").arg(universeNumber).toUtf8().constData());
-      artnet.inputs[universeNumber].node = client;
-    }
-  }
+  QString error = engine.call(routeDst.script, &m_PrivateLog, QString::fromUtf8(path, static_cast<int>(pathLen)), args, argsCount, job.universe ? job.universe->data() : nullptr, job.universeCount,
+                              &job.packet);
 
-  if (hasOutput)
+  if (job.universe)
   {
-    artnet.server = artnet_new(m_Settings.artNetIP.isEmpty() ? nullptr : m_Settings.artNetIP.toLatin1().constData(), 0);
-    if (artnet.server)
-    {
-      m_PrivateLog.AddInfo(QLatin1String("ArtNet server created").toUtf8().constData());
+    m_UniverseFree.Push(job.universe);
+    job.universe = nullptr;
+  }
 
-      artnet_set_node_type(artnet.server, ARTNET_RAW);
-      artnet_set_short_name(artnet.server, VER_PRODUCTNAME_STR);
-      artnet_set_long_name(artnet.server, VER_PRODUCTNAME_STR);
+  m_Mutex.lock();
+  qint64 elapsed = m_CallTimer.elapsed();
+  m_CallTimer.invalidate();
+  bool interrupted = m_Interrupted;
+  m_Interrupted = false;
+  engine.js().setInterrupted(false);
+  m_Mutex.unlock();
 
-      if (artnet_start(artnet.server) != ARTNET_EOK)
-      {
-        m_PrivateLog.AddInfo(QLatin1String("ArtNet server startup failed").toUtf8().constData());
-        artnet_destroy(artnet.server);
-        artnet.server = nullptr;
-      }
-      else
-        m_PrivateLog.AddInfo(QLatin1String("ArtNet server started").toUtf8().constData());
-    }
-    else
-      m_PrivateLog.AddError(QLatin1String("ArtNet server creation failed").toUtf8().constData());
+  if (args)
+    delete[] args;
 
-    ItemState::EnumState state = artnet.server ? ItemState::STATE_CONNECTED : ItemState::STATE_NOT_CONNECTED;
-    SetItemState(routesByPort, Protocol::kArtNet, state);
-    SetItemState(routesBysACNUniverse, Protocol::kArtNet, state);
-    SetItemState(routesByArtNetUniverse, Protocol::kArtNet, state);
-    SetItemState(routesByMIDI, Protocol::kArtNet, state);
+  if (interrupted)
+    m_PrivateLog.AddWarning(QString("script %1 interrupted after %2ms").arg(routeDst.label).arg(elapsed).toUtf8().constData());
+  else if (!error.isEmpty())
+    m_PrivateLog.AddWarning(error.toStdString());
+  else if (job.packet.GetDataConst() && job.packet.GetSize() > 0)
+  {
+    job.input = EosPacket();
+    if (m_Results.Push(std::move(job)))
+      m_Router.m_Wakeup.Signal();
   }
+
+  job = sScriptJob();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void RouterThread::BuildMIDI(ROUTES_BY_PORT &routesByMIDI, MIDI &midi)
+void RouterThread::ScriptWorker::UpdateLog()
 {
-  if (routesByMIDI.empty())
-    return;
-
-  for (ROUTES_BY_PORT::const_iterator portIter = routesByMIDI.begin(); portIter != routesByMIDI.end(); ++portIter)
-  {
-    unsigned int port = portIter->first;
-    const ROUTES_BY_IP &routesByIp = portIter->second;
+  m_Mutex.lock();
+  m_Log.AddLog(m_PrivateLog);
+  m_Mutex.unlock();
+  m_PrivateLog.Clear();
+}
 
-    MIDI_INPUT_LIST::const_iterator inputIter = midi.inputs.find(port);
-    if (inputIter != midi.inputs.end())
-      continue;  // already listening on this port
+////////////////////////////////////////////////////////////////////////////////
 
-    MIDIIn midiIn;
+void RouterThread::StartScriptWorkers()
+{
+  // route scripts are pinned to workers by id, extra workers would sit idle
+  size_t count = std::min(static_cast<size_t>(m_Settings.scriptWorkers), m_ScriptSources.size());
+  for (size_t i = 0; i < count; ++i)
+  {
+    ScriptWorker *worker = new ScriptWorker(*this, i);
+    worker->Start(m_ScriptSources, m_Settings.script);
+    m_ScriptWorkers.push_back(worker);
+  }
 
-    try
-    {
-      std::shared_ptr<RtMidiIn> input = std::make_shared<RtMidiIn>();
-      input->openPort(port, VER_PRODUCTNAME_STR);
-      input->ignoreTypes(/*midiSysex*/ false, /*midiTime*/ false, /*midiSense*/ false);
-      midiIn.name = input->getPortName(port);
-      midiIn.midi = input;
-    }
-    catch (RtMidiError &error)
-    {
-      m_PrivateLog.AddError("RtMidiIn openPort error: " + error.getMessage());
-    }
+  if (!m_ScriptWorkers.empty())
+  {
+    m_PrivateLog.AddWarning(QString("route scripts running on %1 script workers, each with its own engine, JavaScript globals are not shared between workers or with the router")
+                                .arg(static_cast<qulonglong>(m_ScriptWorkers.size()))
+                                .toUtf8()
+                                .constData());
+  }
+}
 
-    if (!midiIn.midi)
-    {
-      SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_NOT_CONNECTED);
-      continue;
-    }
+////////////////////////////////////////////////////////////////////////////////
 
-    SetItemState(routesByIp, Protocol::kInvalid, ItemState::STATE_CONNECTED);
-    m_PrivateLog.AddInfo(QStringLiteral("MIDI started listening on port %1").arg(port).toUtf8().constData());
-    midi.inputs[port] = midiIn;
+void RouterThread::StopScriptWorkers()
+{
+  EosLog::LOG_Q logQ;
+  for (SCRIPT_WORKERS::const_iterator i = m_ScriptWorkers.begin(); i != m_ScriptWorkers.end(); ++i)
+  {
+    ScriptWorker *worker = *i;
+    worker->Stop();
+    worker->Flush(logQ);
+    m_PrivateLog.AddQ(logQ);
+    logQ.clear();
+    delete worker;
   }
+
+  m_ScriptWorkers.clear();
+  m_ScriptResults.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-EosUdpOutThread *RouterThread::CreateUdpOutThread(const EosAddr &addr, ItemStateTable::ID itemStateTableId, UDP_OUT_THREADS &udpOutThreads)
+bool RouterThread::QueueScript(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, const EosAddr &dstAddr, bool tcp, const EosPacket &input)
 {
-  if (!addr.ip.isEmpty() && addr.port != 0)
+  sScriptJob job;
+  job.routeDst = &routeDst;
+  job.addr = addr;
+  job.protocol = protocol;
+  job.dstAddr = dstAddr;
+  job.tcp = tcp;
+
+  ScriptWorker *worker = m_ScriptWorkers[routeDst.script % m_ScriptWorkers.size()];
+
+  if (protocol == Protocol::kOSC)
+    job.input = input;
+  else
   {
-    UDP_OUT_THREADS::iterator i = udpOutThreads.find(addr);
-    if (i == udpOutThreads.end())
-    {
-      EosUdpOutThread *thread = new EosUdpOutThread();
-      udpOutThreads[addr] = thread;
-      thread->Start(addr, itemStateTableId, m_ReconnectDelay);
-      return thread;
-    }
-    else
-      return i->second;
+    // levels as of this message, not whenever the worker gets to it
+    job.universe = worker->PopUniverse();
+    if (!job.universe)
+      return false;
+
+    job.universeCount = GetScriptUniverse(&artnet, addr, protocol, *job.universe);
   }
 
-  return 0;
+  return worker->Push(job);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void RouterThread::AddRoutingDestinations(bool isOSC, const QString &path, const sRoutesByIp &routesByIp, DESTINATIONS_LIST &destinations)
+void RouterThread::ProcessScriptResults(sACN &sacn, ArtNet &artnet, MIDI &midi, UDP_OUT_THREADS &udpOutThreads, TCP_CLIENT_THREADS &tcpClientThreads)
 {
-  // send to any routes with an explicit path specified
-  if (isOSC && !path.isEmpty())
+  EosLog::LOG_Q logQ;
+  for (size_t i = 0; i < m_ScriptWorkers.size(); ++i)
   {
-    // exact matches
-    ROUTES_BY_PATH::const_iterator pathIter = routesByIp.routesByPath.find(path);
-    if (pathIter != routesByIp.routesByPath.end())
-      destinations.push_back(&(pathIter->second));
+    ScriptWorker *worker = m_ScriptWorkers[i];
+
+    if (m_Settings.scriptTimeoutMS != 0)
+      worker->Watchdog(static_cast<qint64>(m_Settings.scriptTimeoutMS));
+
+    worker->Flush(logQ);
+    m_PrivateLog.AddQ(logQ);
+    logQ.clear();
+
+    uint64_t dropped = worker->TakeDropped();
+    if (dropped != 0)
+      m_PrivateLog.AddWarning(QString("script worker %1 busy, dropped %2 messages").arg(static_cast<qulonglong>(i)).arg(static_cast<qulonglong>(dropped)).toUtf8().constData());
+
+    worker->PopResults(m_ScriptResults);
+  }
 
-    // wildcard matches
-    if (!routesByIp.routesByWildcardPath.empty())
+  OSCMessageView oscMessage;
+  for (SCRIPT_JOBS::const_iterator i = m_ScriptResults.begin(); i != m_ScriptResults.end(); ++i)
+  {
+    const sRouteDst &routeDst = *i->routeDst;
+
+    if (i->tcp)
     {
-      for (ROUTES_BY_PATH::const_iterator i = routesByIp.routesByWildcardPath.begin(); i != routesByIp.routesByWildcardPath.end(); i++)
+      TCP_CLIENT_THREADS::const_iterator j = tcpClientThreads.find(i->dstAddr);
+      if (j != tcpClientThreads.end() && j->second->SendFramed(i->packet))
       {
-        if (QRegularExpression::fromWildcard(i->first, Qt::CaseSensitive, QRegularExpression::NonPathWildcardConversion).match(path).hasMatch())
-          destinations.push_back(&(i->second));
+        SetItemActivity(routeDst.dstItemStateTableId);
+        SetItemActivity(j->second->GetItemStateTableId());
       }
+      continue;
     }
+
+    oscMessage.Clear();
+    if (routeDst.dst.protocol == Protocol::kPSN || routeDst.dst.protocol == Protocol::ksACN || routeDst.dst.protocol == Protocol::kArtNet || routeDst.dst.protocol == Protocol::kMIDI)
+      oscMessage.Parse(i->packet);
+
+    SendOSC(sacn, artnet, midi, udpOutThreads, i->addr, i->protocol, routeDst, i->dstAddr, i->packet, oscMessage);
   }
 
-  // send to any routes without an explicit path specified
-  QString noPath;
-  ROUTES_BY_PATH::const_iterator pathIter = routesByIp.routesByPath.find(noPath);
-  if (pathIter != routesByIp.routesByPath.end())
-    destinations.push_back(&(pathIter->second));
+  m_ScriptResults.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void RouterThread::ProcessRecvQ(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, OSCParser &oscBundleParser, ROUTES_BY_PORT &routesByPort, DESTINATIONS_LIST &routingDestinationList,
+void RouterThread::ProcessRecvQ(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, OSCParser &oscBundleParser, const RouteTable &routeTable, DESTINATIONS_LIST &routingDestinationList,
                                 UDP_OUT_THREADS &udpOutThreads, TCP_SERVER_THREADS &tcpServerThreads, TCP_CLIENT_THREADS &tcpClientThreads, const EosAddr &addr, EosUdpInThread::RECV_Q &recvQ)
 {
   for (EosUdpInThread::RECV_Q::iterator i = recvQ.begin(); i != recvQ.end(); i++)
@@ -1650,20 +3445,23 @@ void RouterThread::ProcessRecvQ(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet
       if (!bundleQ.empty())
       {
         for (EosUdpInThread::RECV_Q::iterator j = bundleQ.begin(); j != bundleQ.end(); j++)
-          ProcessRecvPacket(muteAllOutgoing, sacn, artnet, midi, routesByPort, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, addr, Protocol::kOSC, *j);
+        {
+          j->recvTime = recvPacket.recvTime;
+          ProcessRecvPacket(muteAllOutgoing, sacn, artnet, midi, routeTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, addr, Protocol::kOSC, *j);
+        }
 
         continue;
       }
     }
 
-    ProcessRecvPacket(muteAllOutgoing, sacn, artnet, midi, routesByPort, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, addr, Protocol::kInvalid, recvPacket);
+    ProcessRecvPacket(muteAllOutgoing, sacn, artnet, midi, routeTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, addr, Protocol::kInvalid, recvPacket);
   }
   recvQ.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void RouterThread::ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, ROUTES_BY_PORT &routesByPort, DESTINATIONS_LIST &routingDestinationList,
+void RouterThread::ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, const RouteTable &routeTable, DESTINATIONS_LIST &routingDestinationList,
                                      UDP_OUT_THREADS &udpOutThreads, TCP_SERVER_THREADS &tcpServerThreads, TCP_CLIENT_THREADS &tcpClientThreads, const EosAddr &addr, Protocol protocol,
                                      EosUdpInThread::sRecvPacket &recvPacket)
 {
@@ -1672,41 +3470,18 @@ void RouterThread::ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &a
   // find osc path null terminator
   char *buf = recvPacket.packet.GetData();
   size_t packetSize = ((recvPacket.packet.GetSize() > 0) ? static_cast<size_t>(recvPacket.packet.GetSize()) : 0);
-  QString path;
+  size_t pathLen = 0;
 
   if (protocol == Protocol::kOSC)
   {
     // get OSC path
-    for (size_t i = 0; i < packetSize; i++)
-    {
-      if (buf[i] == 0)
-      {
-        if (i != 0)
-          path = QString::fromUtf8(buf);
-        break;
-      }
-    }
+    const void *end = memchr(buf, 0, packetSize);
+    if (end)
+      pathLen = static_cast<size_t>(static_cast<const char *>(end) - buf);
   }
 
-  // send to matching ports
-  ROUTES_BY_PORT::const_iterator portsIter = routesByPort.find(addr.port);
-  if (portsIter != routesByPort.end())
-  {
-    const ROUTES_BY_IP &routesByIp = portsIter->second;
-
-    // send to matching ips
-    ROUTES_BY_IP::const_iterator ipIter = routesByIp.find(recvPacket.ip);
-    if (ipIter != routesByIp.end())
-      AddRoutingDestinations(protocol == Protocol::kOSC, path, ipIter->second, routingDestinationList);
-
-    // send to unspecified ips
-    if (recvPacket.ip != 0)
-    {
-      ipIter = routesByIp.find(0);
-      if (ipIter != routesByIp.end())
-        AddRoutingDestinations(protocol == Protocol::kOSC, path, ipIter->second, routingDestinationList);
-    }
-  }
+  // send to matching ports and ips
+  routeTable.Find(addr.port, recvPacket.ip, protocol == Protocol::kOSC, buf, pathLen, routingDestinationList);
 
   if (!routingDestinationList.empty())
   {
@@ -1718,10 +3493,12 @@ void RouterThread::ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &a
       args = OSCArgument::GetArgs(buf, packetSize, argsCount);
     }
 
+    // refers to args, rebuilt for each destination that encodes DMX, MIDI, or PSN
+    OSCMessageView oscMessage;
+
     for (DESTINATIONS_LIST::const_iterator i = routingDestinationList.begin(); i != routingDestinationList.end(); i++)
     {
-      const ROUTE_DESTINATIONS &destinations = **i;
-      for (ROUTE_DESTINATIONS::const_iterator j = destinations.begin(); j != destinations.end(); j++)
+      for (const sRouteDst *j = i->first; j != (i->first + i->count); j++)
       {
         const sRouteDst &routeDst = *j;
         SetItemActivity(routeDst.srcItemStateTableId);
@@ -1755,7 +3532,15 @@ void RouterThread::ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &a
             if (protocol == Protocol::kOSC)
             {
               EosPacket packet;
-              if (MakeOSCPacket(artnet, addr, protocol, path, routeDst, args, argsCount, packet) && tcpClient->SendFramed(packet))
+              bool sent = false;
+              if (routeDst.dst.script && !m_ScriptWorkers.empty())
+                QueueScript(artnet, addr, protocol, routeDst, dstAddr, /*tcp*/ true, recvPacket.packet);
+              else if (routeDst.oscPassThrough)
+                sent = tcpClient->SendFramed(recvPacket.packet);
+              else
+                sent = (MakeOSCPacket(m_PrivateLog, &artnet, addr, protocol, buf, pathLen, routeDst, args, argsCount, packet) && tcpClient->SendFramed(packet));
+
+              if (sent)
               {
                 SetItemActivity(routeDst.dstItemStateTableId);
                 SetItemActivity(tcpClient->GetItemStateTableId());
@@ -1770,39 +3555,38 @@ void RouterThread::ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &a
         }
         else if (protocol == Protocol::kOSC || protocol == Protocol::ksACN || protocol == Protocol::kArtNet || protocol == Protocol::kMIDI)
         {
-          EosPacket oscPacket;
-          MakeOSCPacket(artnet, addr, protocol, path, routeDst, args, argsCount, oscPacket);
-
-          if (routeDst.dst.protocol == Protocol::kPSN)
-          {
-            EosPacket psnPacket;
-            if (MakePSNPacket(oscPacket, psnPacket))
-            {
-              EosUdpOutThread *thread = CreateUdpOutThread(dstAddr, routeDst.dstItemStateTableId, udpOutThreads);
-              if (thread && thread->Send(psnPacket))
-                SetItemActivity(routeDst.dstItemStateTableId);
-            }
-          }
-          else if (routeDst.dst.protocol == Protocol::ksACN)
+          // DMX input is copied straight across, OSC arguments are written as is
+          if (routeDst.staticDMXOptions)
           {
-            if (SendsACN(sacn, artnet, addr, protocol, routeDst, oscPacket))
-              SetItemActivity(routeDst.dstItemStateTableId);
-          }
-          else if (routeDst.dst.protocol == Protocol::kArtNet)
-          {
-            if (SendArtNet(artnet, addr, protocol, routeDst.dst, oscPacket))
+            bool dmxInput = (protocol == Protocol::ksACN || protocol == Protocol::kArtNet);
+            if (SendDMX(sacn, artnet, addr, protocol, routeDst, dmxInput ? nullptr : args, dmxInput ? 0 : argsCount))
               SetItemActivity(routeDst.dstItemStateTableId);
+            continue;
           }
-          else if (routeDst.dst.protocol == Protocol::kMIDI)
+
+          if (routeDst.dst.script && !m_ScriptWorkers.empty())
           {
-            SendMIDI(midi, routeDst, oscPacket);
+            QueueScript(artnet, addr, protocol, routeDst, dstAddr, /*tcp*/ false, recvPacket.packet);
+            continue;
           }
-          else if (oscPacket.GetDataConst() && oscPacket.GetSize() > 0)
+
+          // every pass-through destination shares the received buffer
+          if (protocol == Protocol::kOSC && routeDst.oscPassThrough)
           {
             EosUdpOutThread *thread = CreateUdpOutThread(dstAddr, routeDst.dstItemStateTableId, udpOutThreads);
-            if (thread && thread->Send(oscPacket))
+            if (thread && thread->Send(recvPacket.packet))
               SetItemActivity(routeDst.dstItemStateTableId);
+            continue;
           }
+
+          // encoders read the parsed message, only OSC outputs need it as bytes
+          EosPacket oscPacket;
+          if (routeDst.dst.protocol == Protocol::kPSN || routeDst.dst.protocol == Protocol::ksACN || routeDst.dst.protocol == Protocol::kArtNet || routeDst.dst.protocol == Protocol::kMIDI)
+            MakeOSCMessage(m_PrivateLog, &artnet, addr, protocol, buf, pathLen, routeDst, args, argsCount, oscMessage);
+          else
+            MakeOSCPacket(m_PrivateLog, &artnet, addr, protocol, buf, pathLen, routeDst, args, argsCount, oscPacket);
+
+          SendOSC(sacn, artnet, midi, udpOutThreads, addr, protocol, routeDst, dstAddr, oscPacket, oscMessage);
         }
         else
         {
@@ -1812,126 +3596,265 @@ void RouterThread::ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &a
         }
       }
     }
-
-    if (args)
-      delete[] args;
+
+    if (args)
+      delete[] args;
+
+    if (m_Settings.latencyStats)
+      m_LatencyStats.Add(recvPacket.recvTime);
+  }
+
+  routingDestinationList.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::SendOSC(sACN &sacn, ArtNet &artnet, MIDI &midi, UDP_OUT_THREADS &udpOutThreads, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, const EosAddr &dstAddr,
+                           const EosPacket &oscPacket, const OSCMessageView &oscMessage)
+{
+  if (routeDst.dst.protocol == Protocol::kPSN)
+  {
+    PSNOutput *output = nullptr;
+    PSN_OUTPUTS::iterator outputIter = m_PSNOutputs.find(dstAddr);
+    if (outputIter != m_PSNOutputs.end())
+      output = &outputIter->second;
+    else
+    {
+      EosUdpOutThread *thread = CreateUdpOutThread(dstAddr, routeDst.dstItemStateTableId, udpOutThreads);
+      if (thread)
+      {
+        output = &m_PSNOutputs[dstAddr];
+        output->thread = thread;
+      }
+    }
+
+    // sent with the destination's next frame by FlushPSN
+    if (output && UpdatePSNOutput(oscMessage, *output))
+      SetItemActivity(routeDst.dstItemStateTableId);
+  }
+  else if (routeDst.dst.protocol == Protocol::ksACN)
+  {
+    if (SendsACN(sacn, artnet, addr, protocol, routeDst, oscMessage))
+      SetItemActivity(routeDst.dstItemStateTableId);
+  }
+  else if (routeDst.dst.protocol == Protocol::kArtNet)
+  {
+    if (SendArtNet(artnet, addr, protocol, routeDst.dst, oscMessage))
+      SetItemActivity(routeDst.dstItemStateTableId);
+  }
+  else if (routeDst.dst.protocol == Protocol::kMIDI)
+  {
+    SendMIDI(midi, routeDst, oscMessage);
+  }
+  else if (oscPacket.GetDataConst() && oscPacket.GetSize() > 0)
+  {
+    EosUdpOutThread *thread = CreateUdpOutThread(dstAddr, routeDst.dstItemStateTableId, udpOutThreads);
+    if (thread && thread->Send(oscPacket))
+      SetItemActivity(routeDst.dstItemStateTableId);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// rendered send paths are reused per thread, the router and each routing shard keep their own
+struct sSendPathScratch
+{
+  std::string sendPath;
+  std::string arg;
+};
+
+static sSendPathScratch &GetSendPathScratch()
+{
+  static thread_local sSendPathScratch scratch;
+  return scratch;
+}
+
+static void AppendDecimal(unsigned int n, std::string &str)
+{
+  char digits[16];
+  std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), n);
+  str.append(digits, result.ptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::MakeOSCPacket(EosLog &log, const ArtNet *artnet, const EosAddr &addr, Protocol protocol, const char *srcPath, size_t srcPathLen, const sRouteDst &route, OSCArgument *args,
+                                 size_t argsCount, EosPacket &packet)
+{
+  if (route.dst.script)
+  {
+    std::array<uint8_t, UNIVERSE_SIZE> dmx;
+    size_t universeCount = GetScriptUniverse(artnet, addr, protocol, dmx);
+    QString error = m_ScriptEngine->call(route.script, &log, QString::fromUtf8(srcPath, static_cast<int>(srcPathLen)), args, argsCount, universeCount ? dmx.data() : nullptr, universeCount, &packet);
+
+    if (error.isEmpty())
+      return true;
+
+    log.AddWarning(error.toStdString());
+    return false;
+  }
+
+  std::string &sendPath = GetSendPathScratch().sendPath;
+  MakeSendPath(log, artnet, addr, protocol, srcPath, srcPathLen, route.path, args, argsCount, sendPath);
+  return (!sendPath.empty() && WriteOSCPacket(protocol, route.dst, sendPath, args, argsCount, packet));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t RouterThread::GetScriptUniverse(const ArtNet *artnet, const EosAddr &addr, Protocol protocol, std::array<uint8_t, UNIVERSE_SIZE> &dmx)
+{
+  if (protocol == Protocol::ksACN)
+  {
+    dmx.fill(0);
+
+    const Universe *universe = m_sACNMerged.Find(addr.port);
+    if (universe)
+      dmx = universe->dmx;
+
+    return dmx.size();
+  }
+
+  if (protocol == Protocol::kArtNet)
+  {
+    const ArtNetRecvUniverse *universe = (artnet ? artnet->FindInput(addr.port) : nullptr);
+    if (universe && universe->length != 0)
+    {
+      size_t count = std::min(universe->length, dmx.size());
+      memcpy(dmx.data(), universe->dmx.data(), count);
+      return count;
+    }
   }
 
-  routingDestinationList.clear();
+  return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-bool RouterThread::MakeOSCPacket(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const QString &srcPath, const sRouteDst &route, OSCArgument *args, size_t argsCount, EosPacket &packet)
+bool RouterThread::GetInputUniverse(const ArtNet *artnet, const EosAddr &addr, Protocol protocol, const uint8_t *&dmx, size_t &size)
 {
-  QString sendPath;
-  if (route.dst.script)
+  if (protocol == Protocol::ksACN)
   {
-    QString error;
+    const Universe *universe = m_sACNMerged.Find(addr.port);
+    if (!universe)
+      return false;
 
-    if (protocol == Protocol::ksACN)
-    {
-      std::array<uint8_t, UNIVERSE_SIZE> dmx;
-      {
-        QMutexLocker locker(&m_sACNRecv.mutex);
-        UNIVERSE_LIST::const_iterator universeIter = m_sACNRecv.merged.find(addr.port);
-        if (universeIter != m_sACNRecv.merged.end())
-        {
-          const Universe &universe = universeIter->second;
-          dmx = universe.dmx;
-        }
-      }
+    dmx = universe->dmx.data();
+    size = universe->dmx.size();
+    return true;
+  }
 
-      error = m_ScriptEngine->evaluate(route.dst.scriptText, &m_PrivateLog, route.label, srcPath, /*args*/ nullptr, /*argsCount*/ 0, dmx.data(), dmx.size(), &packet);
-    }
-    else if (protocol == Protocol::kArtNet)
-    {
-      const uint8_t *universe = nullptr;
-      size_t universeCount = 0;
+  if (protocol == Protocol::kArtNet)
+  {
+    const ArtNetRecvUniverse *universe = (artnet ? artnet->FindInput(addr.port) : nullptr);
+    if (!universe)
+      return false;
 
-      uint8_t universeNumber = static_cast<uint8_t>(addr.port);
-      ARTNET_RECV_UNIVERSE_LIST::const_iterator i = artnet.inputs.find(universeNumber);
-      if (i != artnet.inputs.end())
-      {
-        int length = 0;
-        uint8_t *data = artnet_read_dmx(i->second.node, 0, &length);
-        if (data && length > 0)
-        {
-          universe = data;
-          universeCount = static_cast<size_t>(length);
-        }
-      }
+    dmx = universe->dmx.data();
+    size = universe->length;
+    return true;
+  }
 
-      error = m_ScriptEngine->evaluate(route.dst.scriptText, &m_PrivateLog, route.label, srcPath, args, argsCount, universe, universeCount, &packet);
-    }
-    else
-      error = m_ScriptEngine->evaluate(route.dst.scriptText, &m_PrivateLog, route.label, srcPath, args, argsCount, /*universe*/ nullptr, /*universeCount*/ 0, &packet);
+  return false;
+}
 
-    if (error.isEmpty())
-      return true;
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::SendDMX(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, OSCArgument *args, size_t argCount)
+{
+  if (routeDst.dst.protocol == Protocol::ksACN)
+    return WritesACN(sacn, artnet, addr, protocol, routeDst, routeDst.dmxOptions, args, argCount);
 
-    OSCParserClient_Log(error.toStdString());
+  return WriteArtNet(artnet, addr, protocol, routeDst.dst, routeDst.dmxOptions.offset, args, argCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::MakeOSCMessage(EosLog &log, const ArtNet *artnet, const EosAddr &addr, Protocol protocol, const char *srcPath, size_t srcPathLen, const sRouteDst &route, OSCArgument *args,
+                                  size_t argsCount, OSCMessageView &message)
+{
+  message.Clear();
+
+  EosPacket packet;
+  if (route.dst.script)
+    return (MakeOSCPacket(log, artnet, addr, protocol, srcPath, srcPathLen, route, args, argsCount, packet) && message.Parse(packet));
+
+  std::string &sendPath = GetSendPathScratch().sendPath;
+  MakeSendPath(log, artnet, addr, protocol, srcPath, srcPathLen, route.path, args, argsCount, sendPath);
+  if (sendPath.empty())
     return false;
+
+  bool dmxInput = (protocol == Protocol::ksACN || protocol == Protocol::kArtNet);
+  size_t index = sendPath.find('=');
+  if ((index != std::string::npos && index > 0) || (!dmxInput && route.dst.hasAnyTransforms()))
+  {
+    // argument from the path, or transformed
+    return (WriteOSCPacket(protocol, route.dst, sendPath, args, argsCount, packet) && message.Parse(packet));
   }
 
-  MakeSendPath(artnet, addr, protocol, srcPath, route.dst.path, args, argsCount, sendPath);
-  if (!sendPath.isEmpty())
+  message.SetPath(sendPath.data(), sendPath.size());
+  if (!dmxInput)
+    message.SetArgs(args, argsCount);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::WriteOSCPacket(Protocol protocol, const EosRouteDst &dst, const std::string &sendPath, OSCArgument *args, size_t argsCount, EosPacket &packet)
+{
+  size_t oscPacketSize = 0;
+  char *oscPacketData = nullptr;
+
+  size_t index = sendPath.find('=');
+  if (index != std::string::npos && index > 0)
   {
-    size_t oscPacketSize = 0;
-    char *oscPacketData = nullptr;
+    oscPacketData = OSCPacketWriter::CreateForString(sendPath.c_str(), oscPacketSize);
 
-    int index = sendPath.indexOf('=');
-    if (index > 0)
+    if (oscPacketData && oscPacketSize && dst.hasAnyTransforms())
     {
-      oscPacketData = OSCPacketWriter::CreateForString(sendPath.toUtf8().constData(), oscPacketSize);
-
-      if (oscPacketData && oscPacketSize && route.dst.hasAnyTransforms())
+      argsCount = 1;
+      args = OSCArgument::GetArgs(oscPacketData, oscPacketSize, argsCount);
+      if (args)
       {
-        argsCount = 1;
-        args = OSCArgument::GetArgs(oscPacketData, oscPacketSize, argsCount);
-        if (args)
-        {
-          OSCPacketWriter oscPacket(sendPath.left(index).toUtf8().constData());
-
-          if (ApplyTransform(args[0], route.dst, oscPacket))
-          {
-            delete[] oscPacketData;
-            oscPacketData = oscPacket.Create(oscPacketSize);
-          }
+        OSCPacketWriter oscPacket(sendPath.substr(0, index));
 
-          delete[] args;
+        if (ApplyTransform(args[0], dst, oscPacket))
+        {
+          delete[] oscPacketData;
+          oscPacketData = oscPacket.Create(oscPacketSize);
         }
+
+        delete[] args;
       }
     }
-    else
-    {
-      OSCPacketWriter oscPacket(sendPath.toUtf8().constData());
+  }
+  else
+  {
+    OSCPacketWriter oscPacket(sendPath);
 
-      if (protocol != Protocol::ksACN && protocol != Protocol::kArtNet)
+    if (protocol != Protocol::ksACN && protocol != Protocol::kArtNet)
+    {
+      if (dst.hasAnyTransforms())
       {
-        if (route.dst.hasAnyTransforms())
+        if (args && argsCount != 0)
         {
-          if (args && argsCount != 0)
-          {
-            if (!ApplyTransform(args[0], route.dst, oscPacket))
-              return false;
-          }
-          else
+          if (!ApplyTransform(args[0], dst, oscPacket))
             return false;
         }
         else
-          oscPacket.AddOSCArgList(args, argsCount);
+          return false;
       }
-
-      oscPacketData = oscPacket.Create(oscPacketSize);
+      else
+        oscPacket.AddOSCArgList(args, argsCount);
     }
 
-    if (oscPacketData && oscPacketSize)
-    {
-      packet = EosPacket(oscPacketData, static_cast<int>(oscPacketSize));
-      delete[] oscPacketData;
-      return true;
-    }
+    oscPacketData = oscPacket.Create(oscPacketSize);
+  }
+
+  if (oscPacketData && oscPacketSize)
+  {
+    packet = EosPacket(oscPacketData, static_cast<int>(oscPacketSize));
+    delete[] oscPacketData;
+    return true;
   }
 
   return false;
@@ -1953,114 +3876,148 @@ bool GetFloat3(OSCArgument *args, size_t argCount, size_t index, psn::float3 &f3
   return args[index + 2].GetFloat(f3.z);
 }
 
-bool RouterThread::MakePSNPacket(EosPacket &osc, EosPacket &psn)
+bool RouterThread::UpdatePSNOutput(const OSCMessageView &osc, PSNOutput &output)
 {
-  char *data = osc.GetData();
-  if (!data || osc.GetSize() < 1)
+  // /psn/<id>[/pos|speed|orientation|acceleration|target|status|timestamp]...
+  if (osc.GetSegmentCount() < 2 || !osc.SegmentEquals(0, "psn"))
     return false;
 
-  // find osc path null terminator
-  for (int i = 0; i < osc.GetSize(); i++)
+  int id = 0;
+  if (!osc.GetSegmentInt(1, id) || id < 0 || id > 0xffff)
+    id = 0;
+
+  // fields not in this message keep their last value
+  psn::tracker_map::iterator trackerIter = output.trackers.find(static_cast<uint16_t>(id));
+  if (trackerIter == output.trackers.end())
+    trackerIter = output.trackers.insert(psn::tracker_map::value_type(static_cast<uint16_t>(id), psn::tracker(static_cast<uint16_t>(id)))).first;
+
+  psn::tracker &tracker = trackerIter->second;
+
+  if (osc.GetSegmentCount() > 2)
   {
-    if (data[i] == 0)
+    size_t argCount = osc.GetArgsCount();
+    OSCArgument *args = osc.GetArgs();
+    size_t argIndex = 0;
+    psn::float3 f3;
+    for (size_t part = 2; part < osc.GetSegmentCount(); ++part)
     {
-      if (i < 1)
-        break;
+      if (osc.SegmentEquals(part, "pos"))
+      {
+        if (GetFloat3(args, argCount, argIndex, f3))
+          tracker.set_pos(f3);
+        argIndex += 3;
+      }
+      else if (osc.SegmentEquals(part, "speed"))
+      {
+        if (GetFloat3(args, argCount, argIndex, f3))
+          tracker.set_speed(f3);
+        argIndex += 3;
+      }
+      else if (osc.SegmentEquals(part, "orientation"))
+      {
+        if (GetFloat3(args, argCount, argIndex, f3))
+          tracker.set_ori(f3);
+        argIndex += 3;
+      }
+      else if (osc.SegmentEquals(part, "acceleration"))
+      {
+        if (GetFloat3(args, argCount, argIndex, f3))
+          tracker.set_accel(f3);
+        argIndex += 3;
+      }
+      else if (osc.SegmentEquals(part, "target"))
+      {
+        if (GetFloat3(args, argCount, argIndex, f3))
+          tracker.set_target_pos(f3);
+        argIndex += 3;
+      }
+      else if (osc.SegmentEquals(part, "status"))
+      {
+        float f = 0;
+        if (args && argIndex < argCount && args[argIndex].GetFloat(f))
+          tracker.set_status(f);
+        ++argIndex;
+      }
+      else if (osc.SegmentEquals(part, "timestamp"))
+      {
+        uint64_t u = 0;
+        if (args && argIndex < argCount && args[argIndex].GetUInt64(u))
+          tracker.set_timestamp(u);
+        ++argIndex;
+      }
+    }
+  }
 
-      QString path = QString::fromUtf8(data[0] == '/' ? &data[1] : &data[0]);
-      QStringList parts = path.split(QLatin1Char('/'));
-      if (parts.size() < 2)
-        break;
+  output.dirty = true;
+  return true;
+}
 
-      if (parts[0] != QLatin1String("psn"))
-        break;
+////////////////////////////////////////////////////////////////////////////////
 
-      psn::tracker tracker(parts[1].toUShort());
+void SendPSNPackets(EosUdpOutThread &thread, const std::list<std::string> &packets)
+{
+  // a frame with more trackers than fit one datagram is split over several packets
+  for (std::list<std::string>::const_iterator i = packets.begin(); i != packets.end(); ++i)
+  {
+    if (!i->empty())
+      thread.Send(EosPacket(i->data(), static_cast<int>(i->size())));
+  }
+}
 
-      if (parts.size() > 2)
-      {
-        size_t argCount = 0xffffffff;
-        OSCArgument *args = OSCArgument::GetArgs(&data[i], static_cast<size_t>(osc.GetSize()), argCount);
-        size_t argIndex = 0;
-        psn::float3 f3;
-        for (int part = 2; part < parts.size(); ++part)
-        {
-          if (parts[part] == QLatin1String("pos"))
-          {
-            if (GetFloat3(args, argCount, argIndex, f3))
-              tracker.set_pos(f3);
-            argIndex += 3;
-          }
-          else if (parts[part] == QLatin1String("speed"))
-          {
-            if (GetFloat3(args, argCount, argIndex, f3))
-              tracker.set_speed(f3);
-            argIndex += 3;
-          }
-          else if (parts[part] == QLatin1String("orientation"))
-          {
-            if (GetFloat3(args, argCount, argIndex, f3))
-              tracker.set_ori(f3);
-            argIndex += 3;
-          }
-          else if (parts[part] == QLatin1String("acceleration"))
-          {
-            if (GetFloat3(args, argCount, argIndex, f3))
-              tracker.set_accel(f3);
-            argIndex += 3;
-          }
-          else if (parts[part] == QLatin1String("target"))
-          {
-            if (GetFloat3(args, argCount, argIndex, f3))
-              tracker.set_target_pos(f3);
-            argIndex += 3;
-          }
-          else if (parts[part] == QLatin1String("status"))
-          {
-            float f = 0;
-            if (args && argIndex < argCount && args[argIndex].GetFloat(f))
-              tracker.set_status(f);
-            ++argIndex;
-          }
-          else if (parts[part] == QLatin1String("timestamp"))
-          {
-            uint64_t u = 0;
-            if (args && argIndex < argCount && args[argIndex].GetUInt64(u))
-              tracker.set_timestamp(u);
-            ++argIndex;
-          }
-        }
+////////////////////////////////////////////////////////////////////////////////
 
-        if (args)
-          delete[] args;
-      }
+void RouterThread::FlushPSN(bool muteAllOutgoing)
+{
+  if (m_PSNOutputs.empty())
+    return;
 
-      psn::tracker_map trackers;
-      trackers[tracker.get_id()] = tracker;
+  uint64_t timestamp = 0;
+  if (m_PSNEncoderTimer.isValid())
+    timestamp = m_PSNEncoderTimer.elapsed();
+  else
+    m_PSNEncoderTimer.start();
 
-      uint64_t timestamp = 0;
-      if (m_PSNEncoderTimer.isValid())
-        timestamp = m_PSNEncoderTimer.elapsed();
-      else
-        m_PSNEncoderTimer.start();
+  qint64 frameMS = (1000 / std::max(m_Settings.psnOutputRate, 1u));
 
-      std::list<std::string> packets = m_PSNEncoder->encode_data(trackers, tracker.is_timestamp_set() ? tracker.get_timestamp() : timestamp);
-      if (!packets.empty() && packets.front().data() && packets.front().size() != 0)
-      {
-        psn = EosPacket(packets.front().data(), static_cast<int>(packets.front().size()));
-        return true;
-      }
+  for (PSN_OUTPUTS::iterator outputIter = m_PSNOutputs.begin(); outputIter != m_PSNOutputs.end(); ++outputIter)
+  {
+    PSNOutput &output = outputIter->second;
+    if (output.trackers.empty())
+      continue;
 
-      break;
+    // system and tracker names, so receivers can list trackers
+    if (!output.infoTimer.isValid() || output.infoTimer.elapsed() >= PSN_REFRESH_MS)
+    {
+      if (!muteAllOutgoing)
+        SendPSNPackets(*output.thread, m_PSNEncoder->encode_info(output.trackers, timestamp));
+
+      output.infoTimer.start();
+    }
+
+    // every tracker goes out in each frame, changed or not, at most once per frame interval
+    if (!output.frameTimer.isValid() || output.frameTimer.elapsed() >= (output.dirty ? frameMS : PSN_REFRESH_MS))
+    {
+      if (!muteAllOutgoing)
+        SendPSNPackets(*output.thread, m_PSNEncoder->encode_data(output.trackers, timestamp));
+
+      output.frameTimer.start();
+      output.dirty = false;
     }
   }
+}
 
-  return false;
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::SendsACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, const OSCMessageView &osc)
+{
+  sDMXPathOptions options;
+  GetDMXPathOptions(osc, options);
+  return WritesACN(sacn, artnet, addr, protocol, routeDst, options, osc.GetArgs(), osc.GetArgsCount());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-bool RouterThread::SendsACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, EosPacket &osc)
+bool RouterThread::WritesACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, const sDMXPathOptions &options, OSCArgument *args, size_t argCount)
 {
   if (!sacn.server)
     return false;
@@ -2069,79 +4026,12 @@ bool RouterThread::SendsACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Pro
   if (universeNumber == 0)
     return false;
 
-  int offset = 0;
-  uint1 priority = static_cast<uint1>(DEFAULT_PRIORITY);
-  bool hasPriority = false;
-  bool perChannelPriority = false;
-  size_t argCount = 0xffffffff;
-  OSCArgument *args = nullptr;
+  int offset = options.offset;
+  uint1 priority = static_cast<uint1>(options.priority);
+  bool hasPriority = options.hasPriority;
+  bool perChannelPriority = options.perChannelPriority;
 
-  // find osc path null terminator
   bool sent = false;
-  char *data = osc.GetData();
-  if (data)
-  {
-    for (int i = 0; i < osc.GetSize(); i++)
-    {
-      if (data[i] == 0)
-      {
-        args = OSCArgument::GetArgs(&data[i], static_cast<size_t>(osc.GetSize()), argCount);
-        QString path = QString::fromUtf8(data[0] == '/' ? &data[1] : &data[0]);
-        QStringList parts = path.split(QLatin1Char('/'));
-        for (int part = 0; part < parts.size(); ++part)
-        {
-          if (parts[part] == QLatin1String("offset"))
-          {
-            int numberPart = part + 1;
-            if (numberPart < parts.size())
-            {
-              bool ok = false;
-              int n = parts[numberPart].toInt(&ok);
-              if (ok)
-              {
-                offset = std::max(0, n - 1);
-                ++part;
-              }
-            }
-          }
-          else if (parts[part] == QLatin1String("priority"))
-          {
-            int numberPart = part + 1;
-            if (numberPart < parts.size())
-            {
-              bool ok = false;
-              int n = parts[numberPart].toInt(&ok);
-              if (ok && n >= 0)
-              {
-                priority = static_cast<uint1>(std::min(n, 255));
-                hasPriority = true;
-                ++part;
-              }
-            }
-          }
-          else if (parts[part] == QLatin1String("perChannelPriority"))
-          {
-            int numberPart = part + 1;
-            if (numberPart < parts.size())
-            {
-              bool ok = false;
-              int n = parts[numberPart].toInt(&ok);
-              if (ok && n >= 0)
-              {
-                priority = static_cast<uint1>(std::min(n, 255));
-                hasPriority = true;
-                perChannelPriority = true;
-                ++part;
-              }
-            }
-          }
-        }
-
-        break;
-      }
-    }
-  }
-
   if (offset < UNIVERSE_SIZE)
   {
     SendUniverse &universe = sacn.output[universeNumber];
@@ -2240,60 +4130,16 @@ bool RouterThread::SendsACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Pro
           }
         }
       }
-      else if (protocol == Protocol::ksACN)
-      {
-        // special case: no args, so send sACN universe
-        bool found = false;
-        std::array<uint8_t, UNIVERSE_SIZE> srcDMX;
-        {
-          QMutexLocker locker(&m_sACNRecv.mutex);
-          UNIVERSE_LIST::const_iterator sACNIter = m_sACNRecv.merged.find(addr.port);
-          if (sACNIter != m_sACNRecv.merged.end())
-          {
-            srcDMX = sACNIter->second.dmx;
-            found = true;
-          }
-        }
-
-        if (found)
-        {
-          for (int i = 0; i < static_cast<int>(srcDMX.size()); ++i)
-          {
-            int channel = offset + i;
-            if (channel >= UNIVERSE_SIZE)
-              break;
-
-            if (universe.dmx.channels[channel] != srcDMX[channel])
-            {
-              universe.dmx.channels[channel] = srcDMX[channel];
-              dirty = true;
-            }
-          }
-        }
-      }
-      else if (protocol == Protocol::kArtNet)
+      else
       {
-        // special case: no args, so send ArtNet universe
-        ARTNET_RECV_UNIVERSE_LIST::const_iterator artNetIter = artnet.inputs.find(static_cast<uint8_t>(addr.port));
-        if (artNetIter != artnet.inputs.end())
+        // special case: no args, so send sACN or ArtNet universe, slots from offset on
+        const uint8_t *srcDMX = nullptr;
+        size_t srcDMXSize = 0;
+        if (GetInputUniverse(&artnet, addr, protocol, srcDMX, srcDMXSize))
         {
-          int srcDMXLength = 0;
-          uint8_t *srcDMX = artnet_read_dmx(artNetIter->second.node, 0, &srcDMXLength);
-          if (srcDMX)
-          {
-            for (int i = 0; i < srcDMXLength; ++i)
-            {
-              int channel = offset + i;
-              if (channel >= UNIVERSE_SIZE)
-                break;
-
-              if (universe.dmx.channels[channel] != srcDMX[channel])
-              {
-                universe.dmx.channels[channel] = srcDMX[channel];
-                dirty = true;
-              }
-            }
-          }
+          size_t end = std::min(srcDMXSize, static_cast<size_t>(UNIVERSE_SIZE));
+          if (static_cast<size_t>(offset) < end && DMXMerge::Copy(srcDMX + offset, universe.dmx.channels + offset, end - static_cast<size_t>(offset)))
+            dirty = true;
         }
       }
 
@@ -2305,60 +4151,39 @@ bool RouterThread::SendsACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Pro
     }
   }
 
-  if (args)
-    delete[] args;
-
   return sent;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-bool RouterThread::SendArtNet(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const EosRouteDst &dst, EosPacket &osc)
+bool RouterThread::SendArtNet(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const EosRouteDst &dst, const OSCMessageView &osc)
 {
-  if (!artnet.server)
-    return false;
-
-  uint8_t universeNumber = static_cast<uint8_t>(dst.addr.port);
-
   int offset = 0;
-  size_t argCount = 0xffffffff;
-  OSCArgument *args = nullptr;
-
-  // find osc path null terminator
-  bool sent = false;
-  char *data = osc.GetData();
-  if (data)
+  for (size_t part = 0; part < osc.GetSegmentCount(); ++part)
   {
-    for (int i = 0; i < osc.GetSize(); i++)
+    int n = 0;
+    if (osc.SegmentEquals(part, "offset") && osc.GetSegmentInt(part + 1, n))
     {
-      if (data[i] == 0)
-      {
-        args = OSCArgument::GetArgs(&data[i], static_cast<size_t>(osc.GetSize()), argCount);
-        QString path = QString::fromUtf8(data[0] == '/' ? &data[1] : &data[0]);
-        QStringList parts = path.split(QLatin1Char('/'));
-        for (int part = 0; part < parts.size(); ++part)
-        {
-          if (parts[part] == QLatin1String("offset"))
-          {
-            int numberPart = part + 1;
-            if (numberPart < parts.size())
-            {
-              bool ok = false;
-              int n = parts[numberPart].toInt(&ok);
-              if (ok)
-              {
-                offset = std::max(0, n - 1);
-                ++part;
-              }
-            }
-          }
-        }
-
-        break;
-      }
+      offset = std::max(0, n - 1);
+      ++part;
     }
   }
 
+  return WriteArtNet(artnet, addr, protocol, dst, offset, osc.GetArgs(), osc.GetArgsCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::WriteArtNet(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const EosRouteDst &dst, int offset, OSCArgument *args, size_t argCount)
+{
+  if (!artnet.server)
+    return false;
+
+  uint16_t universeNumber = static_cast<uint16_t>(dst.addr.port);
+  if (universeNumber >= ARTNET_PORT_ADDRESS_COUNT)
+    return false;
+
+  bool sent = false;
   if (offset < ARTNET_DMX_LENGTH)
   {
     ArtNetSendUniverse *universe = nullptr;
@@ -2393,77 +4218,31 @@ bool RouterThread::SendArtNet(ArtNet &artnet, const EosAddr &addr, Protocol prot
         }
       }
     }
-    else if (protocol == Protocol::ksACN)
-    {
-      // special case: no args, so send sACN universe
-      bool found = false;
-      std::array<uint8_t, UNIVERSE_SIZE> srcDMX;
-      {
-        QMutexLocker locker(&m_sACNRecv.mutex);
-        UNIVERSE_LIST::const_iterator sACNIter = m_sACNRecv.merged.find(addr.port);
-        if (sACNIter != m_sACNRecv.merged.end())
-        {
-          srcDMX = sACNIter->second.dmx;
-          found = true;
-        }
-      }
-
-      if (found)
-      {
-        for (int i = 0; i < static_cast<int>(srcDMX.size()); ++i)
-        {
-          int channel = offset + i;
-          if (channel >= static_cast<int>(universe->dmx.size()))
-            break;
-
-          if (universe->dmx[channel] != srcDMX[channel])
-          {
-            universe->dmx[channel] = srcDMX[channel];
-            universe->dirty = true;
-            sent = true;
-          }
-        }
-      }
-    }
-    else if (protocol == Protocol::kArtNet)
-    {
-      // special case: no args, so send ArtNet universe
-      ARTNET_RECV_UNIVERSE_LIST::const_iterator artNetIter = artnet.inputs.find(static_cast<uint8_t>(addr.port));
-      if (artNetIter != artnet.inputs.end())
-      {
-        int srcDMXLength = 0;
-        uint8_t *srcDMX = artnet_read_dmx(artNetIter->second.node, 0, &srcDMXLength);
-        if (srcDMX)
-        {
-          for (int i = 0; i < srcDMXLength; ++i)
-          {
-            int channel = offset + i;
-            if (channel >= static_cast<int>(universe->dmx.size()))
-              break;
-
-            if (universe->dmx[channel] != srcDMX[channel])
-            {
-              universe->dmx[channel] = srcDMX[channel];
-              universe->dirty = true;
-              sent = true;
-            }
-          }
+    else
+    {
+      // special case: no args, so send sACN or ArtNet universe, slots from offset on
+      const uint8_t *srcDMX = nullptr;
+      size_t srcDMXSize = 0;
+      if (GetInputUniverse(&artnet, addr, protocol, srcDMX, srcDMXSize))
+      {
+        size_t end = std::min(srcDMXSize, universe->dmx.size());
+        if (static_cast<size_t>(offset) < end && DMXMerge::Copy(srcDMX + offset, universe->dmx.data() + offset, end - static_cast<size_t>(offset)))
+        {
+          universe->dirty = true;
+          sent = true;
         }
       }
     }
   }
 
-  if (args)
-    delete[] args;
-
   return sent;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void RouterThread::SendMIDI(MIDI &midi, const sRouteDst &routeDst, EosPacket &oscPacket)
+void RouterThread::SendMIDI(MIDI &midi, const sRouteDst &routeDst, const OSCMessageView &osc)
 {
-  if (!oscPacket.GetData() || oscPacket.GetSize() < 1)
+  if (osc.empty())
     return;
 
   MIDI_OUTPUT_LIST::iterator portIter = midi.outputs.find(routeDst.dst.addr.port);
@@ -2487,40 +4266,26 @@ void RouterThread::SendMIDI(MIDI &midi, const sRouteDst &routeDst, EosPacket &os
     SetItemState(routeDst.dstItemStateTableId, ItemState::STATE_CONNECTED);
   }
 
-  // find osc path null terminator
-  QString path;
-  size_t argCount = 0xffffffff;
-  OSCArgument *args = nullptr;
-  char *data = oscPacket.GetData();
-  if (data)
-  {
-    for (int i = 0; i < oscPacket.GetSize(); i++)
-    {
-      if (data[i] == 0)
-      {
-        path = QString::fromUtf8(data);
-        args = OSCArgument::GetArgs(&data[i], static_cast<size_t>(oscPacket.GetSize()), argCount);
-        break;
-      }
-    }
-  }
+  size_t argCount = osc.GetArgsCount();
+  OSCArgument *args = osc.GetArgs();
 
   std::vector<unsigned char> message;
 
-  QStringList parts = path.split(QLatin1Char('/'));
-  qDebug() << parts;
-  if (parts.size() > 1 && parts[1] == QLatin1String("msc"))
+  // path parts as split from the whole path, a leading '/' yields an empty first part
+  size_t msc = (osc.HasLeadingSlash() ? 0 : 1);
+  if (osc.SegmentEquals(msc, "msc"))
   {
+    int n = 0;
     message.push_back(static_cast<unsigned char>(MSC::kSysEx));
     message.push_back(static_cast<unsigned char>(MSC::kSysExStart));
-    message.push_back((parts.size() > 2) ? static_cast<unsigned char>(parts[2].toInt()) : static_cast<unsigned char>(0x01u));
+    message.push_back(((msc + 1) < osc.GetSegmentCount()) ? static_cast<unsigned char>(osc.GetSegmentInt(msc + 1, n) ? n : 0) : static_cast<unsigned char>(0x01u));
     message.push_back(static_cast<unsigned char>(MSC::kMSC));
-    message.push_back((parts.size() > 3) ? static_cast<unsigned char>(parts[3].toInt()) : static_cast<unsigned char>(MSC::kLightingFormat));
+    message.push_back(((msc + 2) < osc.GetSegmentCount()) ? static_cast<unsigned char>(osc.GetSegmentInt(msc + 2, n) ? n : 0) : static_cast<unsigned char>(MSC::kLightingFormat));
 
     MSCCmd cmd = MSCCmd::kGo;
-    if (parts.size() > 4)
+    if ((msc + 3) < osc.GetSegmentCount())
     {
-      std::optional<MSCCmd> named = MSCCmdForName(parts[4]);
+      std::optional<MSCCmd> named = MSCCmdForName(QString::fromStdString(osc.GetSegment(msc + 3)));
       if (named.has_value())
         cmd = named.value();
     }
@@ -2570,8 +4335,6 @@ void RouterThread::SendMIDI(MIDI &midi, const sRouteDst &routeDst, EosPacket &os
     }
   }
 
-  delete[] args;
-
   if (message.empty())
     return;
 
@@ -2606,7 +4369,7 @@ void RouterThread::ProcessTcpConnectionQ(TCP_CLIENT_THREADS &tcpClientThreads, E
 
     EosTcpClientThread *thread = new EosTcpClientThread();
     tcpClientThreads[tcpConnection.addr] = thread;
-    thread->Start(tcpConnection.tcp, tcpConnection.addr, tcpServer.GetItemStateTableId(), tcpServer.GetFrameMode(), /*reconnectDelayMS*/ 0, mute);
+    thread->Start(tcpConnection.tcp, tcpConnection.addr, tcpServer.GetItemStateTableId(), tcpServer.GetFrameMode(), /*reconnectDelayMS*/ 0, mute, &m_Wakeup);
   }
 }
 
@@ -2657,147 +4420,94 @@ bool RouterThread::ApplyTransform(OSCArgument &arg, const EosRouteDst &dst, OSCP
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void RouterThread::MakeSendPath(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const QString &srcPath, const QString &dstPath, const OSCArgument *args, size_t argsCount, QString &sendPath)
+void RouterThread::MakeSendPath(EosLog &log, const ArtNet *artnet, const EosAddr &addr, Protocol protocol, const char *srcPath, size_t srcPathLen, const OSCPathTemplate &dstPath,
+                                const OSCArgument *args, size_t argsCount, std::string &sendPath)
 {
-  if (dstPath.isEmpty() && protocol != Protocol::ksACN && protocol != Protocol::kArtNet)
+  sendPath.clear();
+
+  if (dstPath.empty())
   {
-    sendPath = srcPath;
+    if (protocol != Protocol::ksACN && protocol != Protocol::kArtNet)
+      sendPath.assign(srcPath, srcPathLen);
+    return;
   }
-  else
+
+  if (!dstPath.HasReplacements())
   {
-    sendPath = dstPath;
+    sendPath = dstPath.GetLiteralText();
+    return;
+  }
+
+  // a source path without parts is one part
+  size_t srcPathPartCount = OSCPathTemplate::GetPartCount(srcPath, srcPathLen);
+  bool srcPathIsPart = (srcPathPartCount == 0);
+  if (srcPathIsPart)
+    srcPathPartCount = 1;
 
-    if (sendPath.contains('%'))
+  std::string &argStr = GetSendPathScratch().arg;
+  const OSCPathTemplate::TOKENS &tokens = dstPath.GetTokens();
+  for (OSCPathTemplate::TOKENS::const_iterator i = tokens.begin(); i != tokens.end(); ++i)
+  {
+    const OSCPathTemplate::sToken &token = *i;
+    if (token.type == OSCPathTemplate::EnumToken::kLiteral)
     {
-      // possible in-line path replacements:
-      // %1  => srcPath[0]
-      // %2  => srcPath[1]
-      // %3  => arg[0]
-      // %%1 => %1
-      // %A  => %A
+      sendPath.append(dstPath.GetText(token), token.length);
+      continue;
+    }
 
-      QStringList srcPathParts;
-      bool srcPathPartsInitialized = false;
+    int srcPathIndex = token.number;
+    if (srcPathLen != 0)
+      --srcPathIndex;
 
-      // look for all instances of '%' follow by a number
-      int digitCount = 0;
-      for (int i = 0; i <= sendPath.size(); i++)
+    size_t insertLen = sendPath.size();
+    if (srcPathIndex >= 0)
+    {
+      if (static_cast<size_t>(srcPathIndex) >= srcPathPartCount)
       {
-        if (i < sendPath.size() && sendPath[i].isDigit())
+        size_t index = (static_cast<size_t>(srcPathIndex) - srcPathPartCount);
+        if (protocol == Protocol::ksACN)
         {
-          digitCount++;
+          uint8_t value = 0;
+          const Universe *universe = m_sACNMerged.Find(addr.port);
+          if (universe && index < universe->dmx.size())
+            value = universe->dmx[index];
+
+          AppendDecimal(value, sendPath);
         }
-        else if (digitCount > 0)
+        else if (protocol == Protocol::kArtNet)
         {
-          // is number preceeded by a '%'?
-          int startIndex = (i - digitCount - 1);
-          if (startIndex > 0 && sendPath[startIndex] == '%')
-          {
-            // is '%' precceed by a '%'?
-            if ((startIndex - 1) > 0 && sendPath[startIndex - 1] == '%')
-            {
-              // %%xxx => %xxx
-              sendPath.remove(startIndex, 1);
-              --i;
-            }
-            else
-            {
-              // %xxx => srcPath[xxx-1]
-
-              int srcPathIndex = sendPath.mid(startIndex + 1, digitCount).toInt();
-              if (!srcPath.isEmpty())
-                --srcPathIndex;
-
-              if (!srcPathPartsInitialized)
-              {
-                srcPathParts = srcPath.split(OSC_ADDR_SEPARATOR, Qt::SkipEmptyParts);
-                if (srcPathParts.isEmpty())
-                  srcPathParts << srcPath;
-                srcPathPartsInitialized = true;
-              }
-
-              QString insertStr;
-              if (srcPathIndex >= 0)
-              {
-                if (srcPathIndex >= srcPathParts.size())
-                {
-                  if (protocol == Protocol::ksACN)
-                  {
-                    srcPathIndex -= srcPathParts.size();
-                    uint8_t value = 0;
-
-                    if (srcPathIndex >= 0)
-                    {
-                      QMutexLocker locker(&m_sACNRecv.mutex);
-                      UNIVERSE_LIST::const_iterator universeIter = m_sACNRecv.merged.find(addr.port);
-                      if (universeIter != m_sACNRecv.merged.end())
-                      {
-                        const Universe &universe = universeIter->second;
-                        if (static_cast<size_t>(srcPathIndex) < universe.dmx.size())
-                          value = universe.dmx[srcPathIndex];
-                      }
-                    }
-
-                    insertStr = QString::number(static_cast<ushort>(value));
-                  }
-                  else if (protocol == Protocol::kArtNet)
-                  {
-                    srcPathIndex -= srcPathParts.size();
-                    uint8_t value = 0;
-
-                    if (srcPathIndex >= 0)
-                    {
-                      uint8_t universeNumber = static_cast<uint8_t>(addr.port);
-                      ARTNET_RECV_UNIVERSE_LIST::const_iterator universeIter = artnet.inputs.find(universeNumber);
-                      if (universeIter != artnet.inputs.end())
-                      {
-                        int length = 0;
-                        uint8_t *data = artnet_read_dmx(universeIter->second.node, 0, &length);
-                        if (data && srcPathIndex < length)
-                          value = data[srcPathIndex];
-                      }
-                    }
-
-                    insertStr = QString::number(static_cast<ushort>(value));
-                  }
-                  else if (args)
-                  {
-                    srcPathIndex -= srcPathParts.size();
-                    if (srcPathIndex >= 0 && static_cast<size_t>(srcPathIndex) < argsCount)
-                    {
-                      std::string argStr;
-                      if (args[srcPathIndex].GetString(argStr))
-                        insertStr = QString::fromStdString(argStr);
-                    }
-                  }
-                }
-                else
-                  insertStr = srcPathParts[srcPathIndex];
-              }
-
-              if (insertStr.isEmpty())
-              {
-                QString msg = QString("Unable to remap %1 => %2, invalid replacement index %3").arg(srcPath).arg(sendPath).arg(srcPathIndex + 1);
-                m_PrivateLog.AddWarning(msg.toUtf8().constData());
-                sendPath.clear();
-                return;
-              }
-
-              int midIndex = (startIndex + digitCount + 1);
-
-              if (midIndex < sendPath.size())
-                sendPath = sendPath.left(startIndex) + insertStr + sendPath.mid(midIndex);
-              else
-                sendPath = sendPath.left(startIndex) + insertStr;
-
-              i = (midIndex - 1);
-            }
-          }
+          uint8_t value = 0;
+          const ArtNetRecvUniverse *universe = (artnet ? artnet->FindInput(addr.port) : nullptr);
+          if (universe && index < universe->length)
+            value = universe->dmx[index];
 
-          digitCount = 0;
+          AppendDecimal(value, sendPath);
         }
+        else if (args && index < argsCount && args[index].GetString(argStr))
+          sendPath.append(argStr);
+      }
+      else if (srcPathIsPart)
+        sendPath.append(srcPath, srcPathLen);
+      else
+      {
+        size_t offset = 0;
+        size_t partLen = 0;
+        if (OSCPathTemplate::GetPart(srcPath, srcPathLen, static_cast<size_t>(srcPathIndex), offset, partLen))
+          sendPath.append(srcPath + offset, partLen);
       }
     }
+
+    insertLen = (sendPath.size() - insertLen);
+    if (insertLen == 0)
+    {
+      QString msg = QString("Unable to remap %1 => %2, invalid replacement index %3")
+                        .arg(QString::fromUtf8(srcPath, static_cast<int>(srcPathLen)))
+                        .arg(QString::fromStdString(dstPath.GetPath()))
+                        .arg(srcPathIndex + 1);
+      log.AddWarning(msg.toUtf8().constData());
+      sendPath.clear();
+      return;
+    }
   }
 }
 
@@ -2906,6 +4616,41 @@ void RouterThread::SetItemActivity(ItemStateTable::ID id)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void RouterThread::SetItemActivity(const ITEM_FLAGS &activity)
+{
+  m_Mutex.lock();
+  for (size_t i = 0; i < activity.size(); ++i)
+  {
+    if (!activity[i])
+      continue;
+
+    const ItemState *itemState = m_ItemStateTable.GetItemState(i);
+    if (itemState && !itemState->activity)
+    {
+      ItemState newItemState(*itemState);
+      newItemState.activity = true;
+      m_ItemStateTable.Update(i, newItemState);
+    }
+  }
+  m_Mutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::GetMutes(MuteAll &muteAll, ITEM_FLAGS &muted)
+{
+  m_Mutex.lock();
+  muteAll.incoming = m_ItemStateTable.GetMuteAllIncoming();
+  muteAll.outgoing = m_ItemStateTable.GetMuteAllOutgoing();
+  const ItemStateTable::LIST &items = m_ItemStateTable.GetList();
+  muted.resize(items.size());
+  for (size_t i = 0; i < items.size(); ++i)
+    muted[i] = items[i].mute;
+  m_Mutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void RouterThread::run()
 {
   m_PrivateLog.AddInfo("router thread started");
@@ -2914,8 +4659,11 @@ void RouterThread::run()
   m_ScriptEngine = new ScriptEngine();
   m_PSNEncoder = new psn::psn_encoder(VER_PRODUCTNAME_STR);
   m_PSNEncoderTimer.invalidate();
+  m_PSNOutputs.clear();
 
   UDP_IN_THREADS udpInThreads;
+  UDP_IN_REACTORS udpInReactors;
+  ROUTE_SHARDS routeShards;
   UDP_OUT_THREADS udpOutThreads;
   TCP_CLIENT_THREADS tcpClientThreads;
   TCP_SERVER_THREADS tcpServerThreads;
@@ -2933,7 +4681,20 @@ void RouterThread::run()
   oscBundleParser.SetRoot(new OSCBundleMethod());
   PacketLogger packetLogger(EosLog::LOG_MSG_TYPE_RECV, m_PrivateLog);
 
-  BuildRoutes(routesByPort, routesBysACNUniverse, routesByArtNetUniverse, routesByMIDI, udpInThreads, udpOutThreads, tcpClientThreads, tcpServerThreads);
+  BuildRoutes(routesByPort, routesBysACNUniverse, routesByArtNetUniverse, routesByMIDI, udpInThreads, udpInReactors, routeShards, udpOutThreads, tcpClientThreads, tcpServerThreads);
+
+  // flattened copies for per-packet lookups
+  RouteTable routeTable;
+  routeTable.Build(routesByPort);
+  RouteTable sACNRouteTable;
+  sACNRouteTable.Build(routesBysACNUniverse);
+  RouteTable artNetRouteTable;
+  artNetRouteTable.Build(routesByArtNetUniverse);
+  RouteTable midiRouteTable;
+  midiRouteTable.Build(routesByMIDI);
+
+  for (ROUTE_SHARDS::const_iterator i = routeShards.begin(); i != routeShards.end(); i++)
+    (*i)->Start(routesByPort);
 
   sACN sacn;
   BuildsACN(routesByPort, routesBysACNUniverse, routesByArtNetUniverse, routesByMIDI, sacn);
@@ -2944,13 +4705,18 @@ void RouterThread::run()
   MIDI midi;
   BuildMIDI(routesByMIDI, midi);
 
-  if (!m_Settings.script.isEmpty())
+  StartScriptWorkers();
+
+  if (!m_Settings.script.isEmpty() && m_ScriptWorkers.empty())
   {
     QString error = m_ScriptEngine->evaluate(m_Settings.script, &m_PrivateLog);
     if (!error.isEmpty())
       OSCParserClient_Log(error.toStdString());
   }
 
+  EosTimer scriptTimingTimer;
+  scriptTimingTimer.Start();
+
   while (m_Run)
   {
     MuteAll muteAll = GetMuteAll();
@@ -2966,7 +4732,7 @@ void RouterThread::run()
         EosUdpInThread::sRecvPortPacket &dmxPacket = dmxRecvQ[i];
         dmxAddr.fromUInt(dmxPacket.p.ip);
         dmxAddr.port = dmxPacket.port;
-        ProcessRecvPacket(muteAll.outgoing, sacn, artnet, midi, routesBysACNUniverse, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, dmxAddr, Protocol::ksACN, dmxPacket.p);
+        ProcessRecvPacket(muteAll.outgoing, sacn, artnet, midi, sACNRouteTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, dmxAddr, Protocol::ksACN, dmxPacket.p);
       }
     }
 
@@ -2981,26 +4747,33 @@ void RouterThread::run()
         EosUdpInThread::sRecvPortPacket &dmxPacket = dmxRecvQ[i];
         dmxAddr.fromUInt(dmxPacket.p.ip);
         dmxAddr.port = dmxPacket.port;
-        ProcessRecvPacket(muteAll.outgoing, sacn, artnet, midi, routesByArtNetUniverse, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, dmxAddr, Protocol::kArtNet,
+        ProcessRecvPacket(muteAll.outgoing, sacn, artnet, midi, artNetRouteTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, dmxAddr, Protocol::kArtNet,
                           dmxPacket.p);
       }
     }
 
     // MIDI input
-    RecvMIDI(oscBundleParser, packetLogger, muteAll.incoming, muteAll.outgoing, sacn, artnet, midi, routesByMIDI, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads);
+    RecvMIDI(oscBundleParser, packetLogger, muteAll.incoming, muteAll.outgoing, sacn, artnet, midi, midiRouteTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads);
 
     // UDP input
     for (UDP_IN_THREADS::iterator i = udpInThreads.begin(); i != udpInThreads.end();)
     {
       EosUdpInThread *thread = i->second;
-      bool running = thread->isRunning();
+      bool running = thread->IsActive();
       thread->Mute(muteAll.incoming);
-      thread->Flush(tempLogQ, recvQ);
+      if (thread->IsSharded())
+      {
+        // packets are routed by its shard, which reads from it until shutdown
+        thread->FlushLog(tempLogQ);
+        running = true;
+      }
+      else
+        thread->Flush(tempLogQ, recvQ);
       m_PrivateLog.AddQ(tempLogQ);
       tempLogQ.clear();
 
       SetItemState(thread->GetItemStateTableId(), thread->GetState());
-      ProcessRecvQ(muteAll.outgoing, sacn, artnet, midi, oscBundleParser, routesByPort, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, thread->GetAddr(), recvQ);
+      ProcessRecvQ(muteAll.outgoing, sacn, artnet, midi, oscBundleParser, routeTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, thread->GetAddr(), recvQ);
 
       if (!running)
       {
@@ -3011,6 +4784,17 @@ void RouterThread::run()
         i++;
     }
 
+    // routing shards
+    for (ROUTE_SHARDS::const_iterator i = routeShards.begin(); i != routeShards.end(); i++)
+    {
+      (*i)->Flush(tempLogQ);
+      m_PrivateLog.AddQ(tempLogQ);
+      tempLogQ.clear();
+    }
+
+    // script workers
+    ProcessScriptResults(sacn, artnet, midi, udpOutThreads, tcpClientThreads);
+
     // TCP servers
     for (TCP_SERVER_THREADS::iterator i = tcpServerThreads.begin(); i != tcpServerThreads.end();)
     {
@@ -3048,7 +4832,7 @@ void RouterThread::run()
       tempLogQ.clear();
 
       SetItemState(thread->GetItemStateTableId(), thread->GetState());
-      ProcessRecvQ(muteAll.outgoing, sacn, artnet, midi, oscBundleParser, routesByPort, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, thread->GetAddr(), recvQ);
+      ProcessRecvQ(muteAll.outgoing, sacn, artnet, midi, oscBundleParser, routeTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, thread->GetAddr(), recvQ);
 
       if (!running)
       {
@@ -3070,7 +4854,7 @@ void RouterThread::run()
 
       SetItemState(thread->GetItemStateTableId(), thread->GetState());
 
-      if (!running)
+      if (!running && !thread->IsSharded())
       {
         delete thread;
         udpOutThreads.erase(i++);
@@ -3099,12 +4883,48 @@ void RouterThread::run()
     // ArtNet output
     FlushArtNet(artnet);
 
+    // PSN output
+    FlushPSN(muteAll.outgoing);
+
+    if (m_Settings.latencyStats)
+    {
+      QString report;
+      if (m_LatencyStats.Report(10000, report))
+      {
+        m_PrivateLog.AddInfo(QStringLiteral("%1 (%2)").arg(report).arg(m_Settings.polling ? QLatin1String("polling") : QLatin1String("wakeup")).toUtf8().constData());
+        m_ScriptEngine->reportTimings(m_PrivateLog);
+        scriptTimingTimer.Start();
+      }
+    }
+
+    // route script timings are always logged, just less often without latency stats
+    if (scriptTimingTimer.GetExpired(ScriptEngine::TIMING_REPORT_MS))
+    {
+      m_ScriptEngine->reportTimings(m_PrivateLog);
+      scriptTimingTimer.Start();
+    }
+
     UpdateLog();
 
-    msleep(1);
+    if (m_Settings.polling)
+      msleep(1);
+    else
+      m_Wakeup.Wait(GetWaitTimeout(sacn, artnet));
+  }
+
+  // shutdown, script workers first since their results refer to the route tables
+  StopScriptWorkers();
+
+  // shards next since they send to udp out threads
+  for (ROUTE_SHARDS::const_iterator i = routeShards.begin(); i != routeShards.end(); i++)
+  {
+    RouteShardThread *shard = *i;
+    shard->Stop();
+    shard->Flush(tempLogQ);
+    m_PrivateLog.AddQ(tempLogQ);
+    tempLogQ.clear();
   }
 
-  // shutdown
   for (TCP_SERVER_THREADS::const_iterator i = tcpServerThreads.begin(); i != tcpServerThreads.end(); i++)
   {
     EosTcpServerThread *thread = i->second;
@@ -3127,6 +4947,9 @@ void RouterThread::run()
     delete thread;
   }
 
+  // PSN outputs refer to udp out threads
+  m_PSNOutputs.clear();
+
   for (UDP_OUT_THREADS::const_iterator i = udpOutThreads.begin(); i != udpOutThreads.end(); i++)
   {
     EosUdpOutThread *thread = i->second;
@@ -3137,6 +4960,14 @@ void RouterThread::run()
     delete thread;
   }
 
+  // reactors release their inputs as they stop
+  for (UDP_IN_REACTORS::const_iterator i = udpInReactors.begin(); i != udpInReactors.end(); i++)
+  {
+    UdpInReactorThread *reactor = *i;
+    reactor->Stop();
+    delete reactor;
+  }
+
   for (UDP_IN_THREADS::const_iterator i = udpInThreads.begin(); i != udpInThreads.end(); i++)
   {
     EosUdpInThread *thread = i->second;
@@ -3147,6 +4978,10 @@ void RouterThread::run()
     delete thread;
   }
 
+  // inputs signal their shard's wakeup, so shards are only deleted after them
+  for (ROUTE_SHARDS::const_iterator i = routeShards.begin(); i != routeShards.end(); i++)
+    delete *i;
+
   m_ItemStateTable.Deactivate();
 
   DestroyArtNet(artnet);
@@ -3155,30 +4990,370 @@ void RouterThread::run()
   delete m_PSNEncoder;
   m_PSNEncoder = nullptr;
 
-  delete m_ScriptEngine;
-  m_ScriptEngine = nullptr;
+  delete m_ScriptEngine;
+  m_ScriptEngine = nullptr;
+
+  m_PrivateLog.AddInfo("router thread ended");
+  UpdateLog();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::FlushArtNet(ArtNet &artnet)
+{
+  if (!artnet.server || artnet.output.empty())
+    return;
+
+  if (m_Settings.artNetUnicast && (!artnet.pollTimer.isValid() || artnet.pollTimer.elapsed() >= ARTNET_POLL_INTERVAL_MS))
+  {
+    // replies arrive through RecvArtNet and refresh the subscribers
+    artnet_send_poll(artnet.server, nullptr, ARTNET_TTM_DEFAULT);
+    ++artnet.pollCount;
+    artnet.pollTimer.start();
+  }
+
+  // universes only go out together, one burst per frame, so a fixture spanning universes never shows half a frame
+  if (!artnet.frameTimer.isValid() || artnet.frameTimer.elapsed() >= 22)
+  {
+    size_t attempted = 0;
+    size_t sent = 0;
+    for (ARTNET_SEND_UNIVERSE_LIST::iterator outputIter = artnet.output.begin(); outputIter != artnet.output.end(); ++outputIter)
+    {
+      ArtNetSendUniverse &universe = outputIter->second;
+      if (!universe.dirty && universe.timer.isValid() && universe.timer.elapsed() < 1000)
+        continue;
+
+      ++attempted;
+      if (!SendArtNetUniverse(artnet, outputIter->first, universe))
+        continue;
+
+      if (universe.timer.isValid())
+      {
+        double intervalMS = (universe.timer.nsecsElapsed() / 1000000.0);
+        if (universe.frames != 0)
+          universe.jitterMS += ((qAbs(intervalMS - universe.intervalMS) - universe.jitterMS) / 16.0);
+        universe.intervalMS = intervalMS;
+      }
+
+      universe.timer.start();
+      universe.dirty = false;
+      ++universe.frames;
+      ++sent;
+    }
+
+    if (sent != 0 && m_Settings.artNetSync)
+      artnet_raw_send_sync(artnet.server);
+
+    // failed universes stay due and are retried next frame, not on every pass, which would spin the router thread
+    if (attempted != 0)
+      artnet.frameTimer.start();
+  }
+
+  if (m_Settings.latencyStats)
+  {
+    if (!artnet.statsTimer.isValid())
+      artnet.statsTimer.start();
+    else if (artnet.statsTimer.elapsed() >= 10000)
+    {
+      double seconds = (artnet.statsTimer.elapsed() / 1000.0);
+      artnet.statsTimer.start();
+
+      for (ARTNET_SEND_UNIVERSE_LIST::iterator outputIter = artnet.output.begin(); outputIter != artnet.output.end(); ++outputIter)
+      {
+        ArtNetSendUniverse &universe = outputIter->second;
+        m_PrivateLog.AddInfo(QStringLiteral("ArtNet universe %1 output %2 fps, jitter %3ms")
+                                 .arg(outputIter->first)
+                                 .arg(universe.frames / seconds, 0, 'f', 1)
+                                 .arg(universe.jitterMS, 0, 'f', 2)
+                                 .toUtf8()
+                                 .constData());
+        universe.frames = 0;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::SendArtNetUniverse(ArtNet &artnet, uint16_t universeNumber, const ArtNetSendUniverse &universe)
+{
+  int16_t length = static_cast<int16_t>(universe.dmx.size());
+
+  const ARTNET_SUBSCRIBER_LIST *subscribers = m_Settings.artNetUnicast ? artnet.FindSubscribers(universeNumber) : nullptr;
+  if (!subscribers)
+    return (artnet_raw_send_dmx(artnet.server, universeNumber, length, universe.dmx.data()) == ARTNET_EOK);
+
+  bool sent = false;
+  for (ARTNET_SUBSCRIBER_LIST::const_iterator i = subscribers->begin(); i != subscribers->end(); ++i)
+  {
+    if (artnet_raw_send_dmx_to(artnet.server, htonl(i->ip), universeNumber, length, universe.dmx.data()) == ARTNET_EOK)
+      sent = true;
+  }
+
+  return sent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned long RouterThread::GetWaitTimeout(sACN &sacn, ArtNet &artnet)
+{
+  // ArtNet and MIDI input signal m_Wakeup like the UDP inputs, so only output timers bound the wait
+  // upper bound, so thread states and logs keep syncing while idle
+  qint64 timeout = 100;
+
+  if (sacn.server && sacn.sendTimer.isValid())
+    timeout = std::min(timeout, 22 - sacn.sendTimer.elapsed());
+
+  if (sacn.client && sacn.recvTimer.isValid())
+    timeout = std::min(timeout, 200 - sacn.recvTimer.elapsed());
+
+  // output goes out in frame bursts, so a universe waits for the next frame even when its own timer is due
+  qint64 frameTimeout = artnet.frameTimer.isValid() ? (22 - artnet.frameTimer.elapsed()) : 0;
+  for (ARTNET_SEND_UNIVERSE_LIST::const_iterator outputIter = artnet.output.begin(); outputIter != artnet.output.end(); ++outputIter)
+  {
+    const ArtNetSendUniverse &universe = outputIter->second;
+    if (universe.dirty || !universe.timer.isValid())
+      timeout = std::min(timeout, frameTimeout);
+    else
+      timeout = std::min(timeout, std::max(frameTimeout, 1000 - universe.timer.elapsed()));
+  }
+
+  // a running route script is interrupted on time rather than at the next idle wakeup
+  if (m_Settings.scriptTimeoutMS != 0)
+  {
+    for (SCRIPT_WORKERS::const_iterator i = m_ScriptWorkers.begin(); i != m_ScriptWorkers.end(); ++i)
+    {
+      qint64 watchdogTimeout = (*i)->GetWatchdogTimeout(static_cast<qint64>(m_Settings.scriptTimeoutMS));
+      if (watchdogTimeout >= 0)
+        timeout = std::min(timeout, watchdogTimeout);
+    }
+  }
+
+  qint64 psnFrameMS = (1000 / std::max(m_Settings.psnOutputRate, 1u));
+  for (PSN_OUTPUTS::const_iterator outputIter = m_PSNOutputs.begin(); outputIter != m_PSNOutputs.end(); ++outputIter)
+  {
+    const PSNOutput &output = outputIter->second;
+    if (output.trackers.empty())
+      continue;
+
+    if (!output.infoTimer.isValid() || !output.frameTimer.isValid())
+      timeout = 0;
+    else
+    {
+      timeout = std::min(timeout, PSN_REFRESH_MS - output.infoTimer.elapsed());
+      timeout = std::min(timeout, (output.dirty ? psnFrameMS : PSN_REFRESH_MS) - output.frameTimer.elapsed());
+    }
+  }
+
+  return static_cast<unsigned long>(std::max(timeout, static_cast<qint64>(0)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::sACNUniverseSource::Reset(const CID &sourceCID)
+{
+  dmx.fill(0);
+  channelPriority.fill(0);
+  changedSlots.fill(0);
+  hasChangedSlots = false;
+  hasPerChannelPriority = false;
+  priority = 0;
+  ip = 0;
+  ipCount = 0;
+  cid = sourceCID;
+  name.fill(0);
+  lastPacket = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RouterThread::sACNUniverseSource::AddIP(unsigned int sourceIP)
+{
+  size_t count = std::min(ipCount, ips.size());
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (ips[i] == sourceIP)
+      return false;
+  }
+
+  // once full, the oldest address is forgotten
+  ips[ipCount % ips.size()] = sourceIP;
+  ++ipCount;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::sACNUniverseSource *RouterThread::sACNRecvUniverse::FindSource(const CID &cid)
+{
+  for (size_t i = 0; i < sourceCount; ++i)
+  {
+    sACNUniverseSource &source = sources[order[i]];
+    if (source.cid == cid)
+      return &source;
+  }
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::sACNUniverseSource *RouterThread::sACNRecvUniverse::AddSource(const CID &cid)
+{
+  if (sourceCount >= sources.size())
+    return nullptr;
+
+  // first unused slot
+  std::array<bool, MAX_UNIVERSE_SOURCES> used;
+  used.fill(false);
+  for (size_t i = 0; i < sourceCount; ++i)
+    used[order[i]] = true;
+
+  uint8_t index = 0;
+  while (used[index])
+    ++index;
+
+  sACNUniverseSource &source = sources[index];
+  source.Reset(cid);
+
+  // keep merge order by CID
+  size_t position = sourceCount;
+  while (position > 0 && cid < sources[order[position - 1]].cid)
+  {
+    order[position] = order[position - 1];
+    --position;
+  }
+
+  order[position] = index;
+  ++sourceCount;
+  return &source;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::sACNRecvUniverse::RemoveSource(const sACNUniverseSource &source)
+{
+  for (size_t i = 0; i < sourceCount; ++i)
+  {
+    if (&sources[order[i]] == &source)
+    {
+      for (size_t j = (i + 1); j < sourceCount; ++j)
+        order[j - 1] = order[j];
+      --sourceCount;
+      sourcesFull = false;
+      return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::sACNUniverseSource *RouterThread::sACNRecvUniverse::FindEvictable(uint8_t newPriority, qint64 now)
+{
+  // lowest priority, ties go to the source heard from least recently
+  sACNUniverseSource *weakest = nullptr;
+  for (size_t i = 0; i < sourceCount; ++i)
+  {
+    sACNUniverseSource &source = sources[order[i]];
+    if (!weakest || source.priority < weakest->priority || (source.priority == weakest->priority && source.lastPacket < weakest->lastPacket))
+      weakest = &source;
+  }
+
+  // only make room for a source that could win the merge, unless the weakest one has gone quiet
+  if (weakest && (weakest->priority < newPriority || (now - weakest->lastPacket) > SOURCE_QUIET_MS))
+    return weakest;
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RouterThread::sACNRecvUniverse &RouterThread::sACNRecv::Add(uint16_t universeNumber)
+{
+  sACNRecvUniverse *recvUniverse = Find(universeNumber);
+  if (recvUniverse)
+    return *recvUniverse;
+
+  // universes are only added the first time they are received, and kept at a fixed address after that
+  universes.push_back(std::make_unique<sACNRecvUniverse>());
+  recvUniverse = universes.back().get();
+  recvUniverse->number = universeNumber;
+  index[universeNumber] = static_cast<uint16_t>(universes.size());
+  dirtyUniverses.reserve(universes.size());
+  return *recvUniverse;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::sACNRecv::SetDirty(sACNRecvUniverse &recvUniverse, bool remerge)
+{
+  if (remerge)
+    recvUniverse.remerge = true;
+
+  if (!recvUniverse.dirty)
+  {
+    recvUniverse.dirty = true;
+    dirtyUniverses.push_back(&recvUniverse);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-  m_PrivateLog.AddInfo("router thread ended");
-  UpdateLog();
+RouterThread::Universe &RouterThread::sACNMerged::Add(uint16_t universeNumber)
+{
+  uint16_t i = index[universeNumber];
+  if (i != 0)
+    return *universes[i - 1];
+
+  universes.push_back(std::make_unique<Universe>());
+  Universe &universe = *universes.back();
+  universe.number = universeNumber;
+  index[universeNumber] = static_cast<uint16_t>(universes.size());
+  changed.reserve(universes.size());
+  return universe;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void RouterThread::FlushArtNet(ArtNet &artnet)
+void RouterThread::ArtNet::AddSubscriber(uint16_t universeNumber, unsigned int ip)
 {
-  for (ARTNET_SEND_UNIVERSE_LIST::iterator outputIter = artnet.output.begin(); outputIter != artnet.output.end(); ++outputIter)
+  ARTNET_SUBSCRIBER_LIST &list = subscribers[universeNumber];
+  for (ARTNET_SUBSCRIBER_LIST::iterator i = list.begin(); i != list.end(); ++i)
   {
-    uint8_t universeNumber = outputIter->first;
-    ArtNetSendUniverse &universe = outputIter->second;
+    if (i->ip == ip)
+    {
+      i->poll = pollCount;
+      return;
+    }
+  }
 
-    qint64 timeout = universe.dirty ? 22 : 1000;
-    if (universe.timer.isValid() && universe.timer.elapsed() < timeout)
-      continue;
+  ArtNetSubscriber subscriber;
+  subscriber.ip = ip;
+  subscriber.poll = pollCount;
+  list.push_back(subscriber);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const RouterThread::ARTNET_SUBSCRIBER_LIST *RouterThread::ArtNet::FindSubscribers(uint16_t universeNumber)
+{
+  ARTNET_SUBSCRIBERS::iterator subscribersIter = subscribers.find(universeNumber);
+  if (subscribersIter == subscribers.end())
+    return nullptr;
 
-    artnet_raw_send_dmx(artnet.server, universeNumber, static_cast<int16_t>(universe.dmx.size()), universe.dmx.data());
-    universe.timer.start();
-    universe.dirty = false;
+  ARTNET_SUBSCRIBER_LIST &list = subscribersIter->second;
+  for (size_t i = 0; i < list.size();)
+  {
+    if ((pollCount - list[i].poll) > ARTNET_SUBSCRIBER_POLLS)
+    {
+      list[i] = list.back();
+      list.pop_back();
+    }
+    else
+      ++i;
   }
+
+  return list.empty() ? nullptr : &list;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3201,116 +5376,45 @@ void RouterThread::RecvsACN(sACN &sacn, EosUdpInThread::RECV_PORT_Q &recvQ)
       sacn.recvTimer.start();
   }
 
-  QMutexLocker locker(&m_sACNRecv.mutex);
-
-  if (m_sACNRecv.dirtyUniverses.empty())
-    return;
-
-  UNIVERSE_NUMBER_SET activeUniverses;
+  m_sACNMerged.changed.clear();
 
-  for (SACN_SOURCE_LIST::const_iterator sourceIter = m_sACNRecv.sources.begin(); sourceIter != m_sACNRecv.sources.end(); ++sourceIter)
   {
-    const sACNSource &source = sourceIter->second;
+    // only the merge itself runs under the lock, the results are router thread only
+    QMutexLocker locker(&m_sACNRecv.mutex);
 
-    for (UNIVERSE_NUMBER_SET::const_iterator dirtyIter = m_sACNRecv.dirtyUniverses.begin(); dirtyIter != m_sACNRecv.dirtyUniverses.end(); ++dirtyIter)
+    if (m_sACNRecv.dirtyUniverses.empty())
+      return;
+
+    for (SACN_RECV_UNIVERSE_PTRS::const_iterator dirtyIter = m_sACNRecv.dirtyUniverses.begin(); dirtyIter != m_sACNRecv.dirtyUniverses.end(); ++dirtyIter)
     {
-      uint16_t universeNumber = *dirtyIter;
-      UNIVERSE_LIST::const_iterator universeIter = source.universes.find(universeNumber);
-      if (universeIter == source.universes.end())
-        continue;
+      sACNRecvUniverse &recvUniverse = **dirtyIter;
+      recvUniverse.dirty = false;
 
-      const Universe &universe = universeIter->second;
-      Universe &merged = m_sACNRecv.merged[universeNumber];
+      Universe &merged = m_sACNMerged.Add(recvUniverse.number);
 
-      if (activeUniverses.insert(universeNumber).second)
-      {
-        // fist instance of this universe
-        merged.ip = universe.ip;
-        merged.dmx = universe.dmx;
-        merged.hasPerChannelPriority = universe.hasPerChannelPriority;
-        if (merged.hasPerChannelPriority)
-          merged.channelPriority = universe.channelPriority;
-        else
-          merged.priority = universe.priority;
-      }
-      else if (universe.hasPerChannelPriority)
-      {
-        if (merged.hasPerChannelPriority)
-        {
-          // merge per channel priority universe with existing per channel priority universe
-          for (int channel = 0; channel < UNIVERSE_SIZE; ++channel)
-          {
-            if (universe.channelPriority[channel] > merged.channelPriority[channel])
-            {
-              merged.dmx[channel] = universe.dmx[channel];
-              merged.channelPriority[channel] = universe.channelPriority[channel];
-              merged.ip = universe.ip;
-            }
-          }
-        }
-        else
-        {
-          // merge per channel priority unviverse with basic priority universe
-          merged.hasPerChannelPriority = true;
-          for (int channel = 0; channel < UNIVERSE_SIZE; ++channel)
-          {
-            if (universe.channelPriority[channel] > merged.priority)
-            {
-              merged.dmx[channel] = universe.dmx[channel];
-              merged.channelPriority[channel] = universe.channelPriority[channel];
-              merged.ip = universe.ip;
-            }
-            else
-              merged.channelPriority[channel] = merged.priority;
-          }
-        }
-      }
+      // only levels changed, so every slot still comes from the same source
+      if (merged.active && !recvUniverse.remerge)
+        UpdateMergedLevels(recvUniverse, merged);
       else
       {
-        if (merged.hasPerChannelPriority)
-        {
-          // merge basic priority universe with existing per channel priority universe
-          for (int channel = 0; channel < UNIVERSE_SIZE; ++channel)
-          {
-            if (universe.priority > merged.channelPriority[channel])
-            {
-              merged.dmx[channel] = universe.dmx[channel];
-              merged.channelPriority[channel] = universe.priority;
-              merged.ip = universe.ip;
-            }
-          }
-        }
-        else if (universe.priority > merged.priority)
-        {
-          // merge basic priority universe with existing basic priority universe
-          merged.dmx = universe.dmx;
-          merged.priority = universe.priority;
-          merged.ip = universe.ip;
-        }
+        MergeUniverse(recvUniverse, merged);
+        recvUniverse.remerge = false;
       }
-    }
-  }
 
-  // remove inactive universes
-  if (activeUniverses.size() < m_sACNRecv.dirtyUniverses.size())
-  {
-    for (UNIVERSE_NUMBER_SET::const_iterator dirtyIter = m_sACNRecv.dirtyUniverses.begin(); dirtyIter != m_sACNRecv.dirtyUniverses.end(); ++dirtyIter)
-    {
-      uint16_t universeNumber = *dirtyIter;
-      if (activeUniverses.find(universeNumber) == activeUniverses.end())
-        m_sACNRecv.merged.erase(universeNumber);
+      if (merged.active)
+        m_sACNMerged.changed.push_back(&merged);
     }
+
+    m_sACNRecv.dirtyUniverses.clear();
+
+    m_PrivateLog.AddLog(m_sACNRecv.log);
+    m_sACNRecv.log.Clear();
   }
 
   // queue OSC style packets
-  for (UNIVERSE_NUMBER_SET::const_iterator activeIter = activeUniverses.begin(); activeIter != activeUniverses.end(); ++activeIter)
+  for (MERGED_UNIVERSE_PTRS::const_iterator changedIter = m_sACNMerged.changed.begin(); changedIter != m_sACNMerged.changed.end(); ++changedIter)
   {
-    uint16_t universeNumber = *activeIter;
-    UNIVERSE_LIST::iterator universeIter = m_sACNRecv.merged.find(universeNumber);
-    if (universeIter == m_sACNRecv.merged.end())
-      continue;
-
-    Universe &universe = universeIter->second;
+    Universe &universe = **changedIter;
     if (m_Settings.levelChangesOnly)
     {
       if (universe.hasPrevDMX && universe.dmx == universe.prevDMX)
@@ -3320,13 +5424,102 @@ void RouterThread::RecvsACN(sACN &sacn, EosUdpInThread::RECV_PORT_Q &recvQ)
       universe.hasPrevDMX = true;
     }
 
-    recvQ.push_back(EosUdpInThread::sRecvPortPacket(universeNumber, nullptr, 0, universe.ip));
+    recvQ.push_back(EosUdpInThread::sRecvPortPacket(universe.number, nullptr, 0, universe.ip));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::MergeUniverse(sACNRecvUniverse &recvUniverse, Universe &merged)
+{
+  for (size_t i = 0; i < recvUniverse.sourceCount; ++i)
+  {
+    uint8_t index = recvUniverse.order[i];
+    sACNUniverseSource &source = recvUniverse.sources[index];
+    source.changedSlots.fill(0);
+    source.hasChangedSlots = false;
+
+    if (i == 0)
+    {
+      // first instance of this universe
+      merged.owner.fill(index);
+      merged.ipSource = index;
+      merged.ip = source.ip;
+      merged.dmx = source.dmx;
+      merged.hasPerChannelPriority = source.hasPerChannelPriority;
+      if (merged.hasPerChannelPriority)
+        merged.channelPriority = source.channelPriority;
+      else
+        merged.priority = source.priority;
+      continue;
+    }
+
+    bool taken = false;
+
+    if (source.hasPerChannelPriority)
+    {
+      // merge per channel priority universe, a basic priority merged universe takes its priority on every channel first
+      if (!merged.hasPerChannelPriority)
+      {
+        merged.hasPerChannelPriority = true;
+        merged.channelPriority.fill(merged.priority);
+      }
+
+      taken = DMXMerge::Merge(source.dmx.data(), source.channelPriority.data(), index, merged.dmx.data(), merged.channelPriority.data(), merged.owner.data(), UNIVERSE_SIZE);
+    }
+    else if (merged.hasPerChannelPriority)
+    {
+      // merge basic priority universe with existing per channel priority universe
+      taken = DMXMerge::Merge(source.dmx.data(), source.priority, index, merged.dmx.data(), merged.channelPriority.data(), merged.owner.data(), UNIVERSE_SIZE);
+    }
+    else if (source.priority > merged.priority)
+    {
+      // merge basic priority universe with existing basic priority universe
+      merged.dmx = source.dmx;
+      merged.priority = source.priority;
+      merged.owner.fill(index);
+      taken = true;
+    }
+
+    if (taken)
+    {
+      merged.ip = source.ip;
+      merged.ipSource = index;
+    }
   }
 
-  m_sACNRecv.dirtyUniverses.clear();
+  // no sources left, a returning universe starts over
+  merged.active = (recvUniverse.sourceCount != 0);
+  if (!merged.active)
+    merged.hasPrevDMX = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RouterThread::UpdateMergedLevels(sACNRecvUniverse &recvUniverse, Universe &merged)
+{
+  for (size_t i = 0; i < recvUniverse.sourceCount; ++i)
+  {
+    uint8_t index = recvUniverse.order[i];
+    sACNUniverseSource &source = recvUniverse.sources[index];
+    if (!source.hasChangedSlots)
+      continue;
+
+    for (size_t word = 0; word < source.changedSlots.size(); ++word)
+    {
+      uint64_t bits = source.changedSlots[word];
+      for (size_t slot = (word * 64); bits != 0; ++slot, bits >>= 1)
+      {
+        if ((bits & 1) != 0 && merged.owner[slot] == index)
+          merged.dmx[slot] = source.dmx[slot];
+      }
+    }
 
-  m_PrivateLog.AddLog(m_sACNRecv.log);
-  m_sACNRecv.log.Clear();
+    source.changedSlots.fill(0);
+    source.hasChangedSlots = false;
+  }
+
+  merged.ip = recvUniverse.sources[merged.ipSource].ip;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3335,144 +5528,144 @@ void RouterThread::RecvArtNet(ArtNet &artnet, EosUdpInThread::RECV_PORT_Q &recvQ
 {
   recvQ.clear();
 
-  for (ARTNET_RECV_UNIVERSE_LIST::const_iterator inputIter = artnet.inputs.begin(); inputIter != artnet.inputs.end(); ++inputIter)
-    artnet_read(inputIter->second.node, 0);
+  if (!artnet.server || (artnet.inputs.empty() && !m_Settings.artNetUnicast))
+    return;
+
+  // drains the shared socket, ArtNetRecv marks each universe that received levels and records ArtPollReply subscribers
+  artnet_read(artnet.server, 0);
+  if (artnet.wakeThread)
+    artnet.wakeThread->Rearm();
 
   for (ARTNET_DIRTY_LIST::const_iterator dirtyIter = artnet.dirty.begin(); dirtyIter != artnet.dirty.end(); ++dirtyIter)
   {
-    artnet_node node = *dirtyIter;
-
-    int universeNumber = artnet_get_universe_addr(node, 0, ARTNET_OUTPUT_PORT);
-    if (universeNumber < 0)
-      continue;
-
-    unsigned int ip = 0;
-    ARTNET_NODE_IP_LIST::const_iterator ipIter = artnet.inputIPs.find(*dirtyIter);
-    if (ipIter != artnet.inputIPs.end())
-      ip = ipIter->second;
+    ArtNetRecvUniverse &recv = artnet.inputs[*dirtyIter];
+    recv.dirty = false;
 
     if (m_Settings.levelChangesOnly)
     {
-      ARTNET_RECV_UNIVERSE_LIST::iterator recvIter = artnet.inputs.find(universeNumber);
-      if (recvIter == artnet.inputs.end())
-        continue;  // no such universe to compare
-
-      ArtNetRecvUniverse &recv = recvIter->second;
-
-      int length = 0;
-      uint8_t *data = artnet_read_dmx(recv.node, 0, &length);
-      if (!data || length < 1)
+      if (recv.length == 0)
         continue;  // no levels to compare
 
-      size_t dmxLength = std::min(recv.prevDMX.size(), static_cast<size_t>(length));
-      if (recv.hasPrevDMX && memcmp(recv.prevDMX.data(), data, dmxLength) == 0)
+      if (recv.hasPrevDMX && memcmp(recv.prevDMX.data(), recv.dmx.data(), recv.length) == 0)
         continue;  // no levels changed
 
-      memcpy(recv.prevDMX.data(), data, dmxLength);
+      memcpy(recv.prevDMX.data(), recv.dmx.data(), recv.length);
       recv.hasPrevDMX = true;
     }
 
-    recvQ.push_back(EosUdpInThread::sRecvPortPacket(static_cast<uint16_t>(universeNumber), nullptr, 0, ip));
+    recvQ.push_back(EosUdpInThread::sRecvPortPacket(recv.number, nullptr, 0, recv.ip));
   }
 
   artnet.dirty.clear();
 }
 
-void RouterThread::RecvMIDI(OSCParser &oscParser, PacketLogger &packetLogger, bool muteAllIncoming, bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, ROUTES_BY_PORT &routesByPort,
+void RouterThread::RecvMIDI(OSCParser &oscParser, PacketLogger &packetLogger, bool muteAllIncoming, bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, const RouteTable &routeTable,
                             DESTINATIONS_LIST &routingDestinationList, UDP_OUT_THREADS &udpOutThreads, TCP_SERVER_THREADS &tcpServerThreads, TCP_CLIENT_THREADS &tcpClientThreads)
 {
   if (midi.inputs.empty())
     return;
 
   EosAddr addr;
-  std::vector<unsigned char> message;
+  MIDIInMessage item;
+  MIDI_MESSAGE &message = m_MIDIMessage;
   for (MIDI_INPUT_LIST::const_iterator portIter = midi.inputs.begin(); portIter != midi.inputs.end(); ++portIter)
   {
-    try
-    {
-      portIter->second.midi->getMessage(&message);
-    }
-    catch (RtMidiError &error)
-    {
-      m_PrivateLog.AddError("RtMidiOut getMessage error: " + error.getMessage());
-      continue;
-    }
+    MIDIInQueue &queue = *portIter->second.queue;
+    uint64_t dropped = queue.messages.TakeDropped();
+    if (dropped != 0)
+      m_PrivateLog.AddWarning(QStringLiteral("MIDI IN  [%1] queue full, dropped %2 messages").arg(portIter->second.name.c_str()).arg(static_cast<qulonglong>(dropped)).toUtf8().constData());
 
-    if (message.empty() || muteAllIncoming)
-      continue;
+    dropped = queue.sysExDropped.exchange(0, std::memory_order_relaxed);
+    if (dropped != 0)
+      m_PrivateLog.AddWarning(QStringLiteral("MIDI IN  [%1] no free SysEx buffer, dropped %2 messages").arg(portIter->second.name.c_str()).arg(static_cast<qulonglong>(dropped)).toUtf8().constData());
 
-    LogMIDI(/*send*/ false, portIter->second.name, message);
+    while (queue.messages.Pop(item))
+    {
+      // copied into one reused buffer, SysEx buffers go straight back to the callback
+      if (item.sysEx)
+      {
+        message.assign(item.sysEx->begin(), item.sysEx->end());
+        queue.sysExFree.Push(item.sysEx);
+      }
+      else
+        message.assign(item.bytes.begin(), item.bytes.begin() + item.size);
 
-    packetLogger.SetPrefix(QStringLiteral("MIDI IN  [%1] ").arg(portIter->second.name).toUtf8().constData());
+      if (message.empty() || muteAllIncoming)
+        continue;
 
-    // raw MIDI
-    {
-      OSCPacketWriter osc("/midi");
-      for (size_t i = 0; i < message.size(); ++i)
-        osc.AddInt32(message[i]);
+      LogMIDI(/*send*/ false, portIter->second.name, message);
 
-      size_t oscPacketSize = 0;
-      char *oscPacket = osc.Create(oscPacketSize);
-      if (oscPacket)
+      packetLogger.SetPrefix(QStringLiteral("MIDI IN  [%1] ").arg(portIter->second.name).toUtf8().constData());
+
+      // raw MIDI
       {
-        addr.port = static_cast<unsigned short>(portIter->first);
-        packetLogger.PrintPacket(oscParser, oscPacket, oscPacketSize);
-        EosUdpInThread::sRecvPacket packet(oscPacket, static_cast<int>(oscPacketSize), /*Ip*/ 0);
-        delete[] oscPacket;
+        OSCPacketWriter osc("/midi");
+        for (size_t i = 0; i < message.size(); ++i)
+          osc.AddInt32(message[i]);
 
-        ProcessRecvPacket(muteAllOutgoing, sacn, artnet, midi, routesByPort, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, addr, Protocol::kOSC, packet);
-      }
-    }
+        size_t oscPacketSize = 0;
+        char *oscPacket = osc.Create(oscPacketSize);
+        if (oscPacket)
+        {
+          addr.port = static_cast<unsigned short>(portIter->first);
+          packetLogger.PrintPacket(oscParser, oscPacket, oscPacketSize);
+          EosUdpInThread::sRecvPacket packet(oscPacket, static_cast<int>(oscPacketSize), /*Ip*/ 0);
+          delete[] oscPacket;
 
-    // MIDI Show Control
-    if (message.size() >= 8 && static_cast<MSC>(message[0]) == MSC::kSysEx && static_cast<MSC>(message[1]) == MSC::kSysExStart && static_cast<MSC>(message[3]) == MSC::kMSC)
-    {
-      MSCCmd mscCmd = ValueMSCCmd(message[5]);
-      OSCPacketWriter osc("/msc/" + std::to_string(message[2]) + "/" + std::to_string(message[4]) + "/" + MSCCmdName(mscCmd).toStdString());
+          ProcessRecvPacket(muteAllOutgoing, sacn, artnet, midi, routeTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, addr, Protocol::kOSC, packet);
+        }
+      }
 
-      if (MSCCmdStrings(mscCmd))
+      // MIDI Show Control
+      if (message.size() >= 8 && static_cast<MSC>(message[0]) == MSC::kSysEx && static_cast<MSC>(message[1]) == MSC::kSysExStart && static_cast<MSC>(message[3]) == MSC::kMSC)
       {
-        std::string str;
-        for (size_t i = 6; i < message.size(); ++i)
+        MSCCmd mscCmd = ValueMSCCmd(message[5]);
+        OSCPacketWriter osc("/msc/" + std::to_string(message[2]) + "/" + std::to_string(message[4]) + "/" + MSCCmdName(mscCmd).toStdString());
+
+        if (MSCCmdStrings(mscCmd))
         {
-          if (message[i] == 0)
+          std::string str;
+          for (size_t i = 6; i < message.size(); ++i)
           {
-            if (!str.empty())
-              osc.AddString(str);
-            str.clear();
-            continue;
-          }
+            if (message[i] == 0)
+            {
+              if (!str.empty())
+                osc.AddString(str);
+              str.clear();
+              continue;
+            }
 
-          if (message[i] == static_cast<unsigned char>(MSC::kSysExEnd))
-            break;
+            if (message[i] == static_cast<unsigned char>(MSC::kSysExEnd))
+              break;
 
-          str += static_cast<char>(message[i]);
-        }
+            str += static_cast<char>(message[i]);
+          }
 
-        if (!str.empty())
-          osc.AddString(str);
-      }
-      else
-      {
-        for (size_t i = 6; i < message.size(); ++i)
+          if (!str.empty())
+            osc.AddString(str);
+        }
+        else
         {
-          if (message[i] == static_cast<unsigned char>(MSC::kSysExEnd))
-            break;
+          for (size_t i = 6; i < message.size(); ++i)
+          {
+            if (message[i] == static_cast<unsigned char>(MSC::kSysExEnd))
+              break;
 
-          osc.AddInt32(static_cast<int32_t>(message[i]));
+            osc.AddInt32(static_cast<int32_t>(message[i]));
+          }
         }
-      }
 
-      size_t oscPacketSize = 0;
-      char *oscPacket = osc.Create(oscPacketSize);
-      if (oscPacket)
-      {
-        addr.port = static_cast<unsigned short>(portIter->first);
-        packetLogger.PrintPacket(oscParser, oscPacket, oscPacketSize);
-        EosUdpInThread::sRecvPacket packet(oscPacket, static_cast<int>(oscPacketSize), /*Ip*/ 0);
-        delete[] oscPacket;
+        size_t oscPacketSize = 0;
+        char *oscPacket = osc.Create(oscPacketSize);
+        if (oscPacket)
+        {
+          addr.port = static_cast<unsigned short>(portIter->first);
+          packetLogger.PrintPacket(oscParser, oscPacket, oscPacketSize);
+          EosUdpInThread::sRecvPacket packet(oscPacket, static_cast<int>(oscPacketSize), /*Ip*/ 0);
+          delete[] oscPacket;
 
-        ProcessRecvPacket(muteAllOutgoing, sacn, artnet, midi, routesByPort, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, addr, Protocol::kOSC, packet);
+          ProcessRecvPacket(muteAllOutgoing, sacn, artnet, midi, routeTable, routingDestinationList, udpOutThreads, tcpServerThreads, tcpClientThreads, addr, Protocol::kOSC, packet);
+        }
       }
     }
   }
@@ -3495,24 +5688,22 @@ void RouterThread::SourceDisappeared(const CID &source, uint2 universe)
 {
   QMutexLocker locker(&m_sACNRecv.mutex);
 
-  SACN_SOURCE_LIST::iterator sourceIter = m_sACNRecv.sources.find(source);
-  if (sourceIter == m_sACNRecv.sources.end())
+  sACNRecvUniverse *recvUniverse = m_sACNRecv.Find(universe);
+  if (!recvUniverse)
     return;
 
-  sACNSource &recvSource = sourceIter->second;
-  UNIVERSE_LIST::iterator universeIter = recvSource.universes.find(universe);
-  if (universeIter == recvSource.universes.end())
+  sACNUniverseSource *recvSource = recvUniverse->FindSource(source);
+  if (!recvSource)
     return;
 
   char str[CID::CIDSTRINGBYTES];
   CID::CIDIntoString(source, str);
-  m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 source disappeared: %2 {%3}").arg(universe).arg(recvSource.name).arg(str).toUtf8().constData());
+  m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 source disappeared: %2 {%3}").arg(universe).arg(QString::fromUtf8(recvSource->name.data())).arg(str).toUtf8().constData());
 
-  recvSource.universes.erase(universeIter);
-  m_sACNRecv.dirtyUniverses.insert(universe);
+  recvUniverse->RemoveSource(*recvSource);
+  m_sACNRecv.SetDirty(*recvUniverse, /*remerge*/ true);
 
-  if (recvSource.universes.empty())
-    m_sACNRecv.sources.erase(sourceIter);
+  m_Wakeup.Signal();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3521,25 +5712,23 @@ void RouterThread::SourcePCPExpired(const CID &source, uint2 universe)
 {
   QMutexLocker locker(&m_sACNRecv.mutex);
 
-  SACN_SOURCE_LIST::iterator sourceIter = m_sACNRecv.sources.find(source);
-  if (sourceIter == m_sACNRecv.sources.end())
-    return;
-
-  sACNSource &recvSource = sourceIter->second;
-  UNIVERSE_LIST::iterator universeIter = recvSource.universes.find(universe);
-  if (universeIter == recvSource.universes.end())
+  sACNRecvUniverse *recvUniverse = m_sACNRecv.Find(universe);
+  if (!recvUniverse)
     return;
 
-  Universe &recvUniverse = universeIter->second;
-  if (!recvUniverse.hasPerChannelPriority)
+  sACNUniverseSource *recvSource = recvUniverse->FindSource(source);
+  if (!recvSource || !recvSource->hasPerChannelPriority)
     return;
 
   char str[CID::CIDSTRINGBYTES];
   CID::CIDIntoString(source, str);
-  m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 per channel priority source expired: %2 {%3}").arg(universe).arg(recvSource.name).arg(str).toUtf8().constData());
+  m_sACNRecv.log.AddInfo(
+      QStringLiteral("sACN universe %1 per channel priority source expired: %2 {%3}").arg(universe).arg(QString::fromUtf8(recvSource->name.data())).arg(str).toUtf8().constData());
+
+  recvSource->hasPerChannelPriority = false;
+  m_sACNRecv.SetDirty(*recvUniverse, /*remerge*/ true);
 
-  recvUniverse.hasPerChannelPriority = false;
-  m_sACNRecv.dirtyUniverses.insert(universe);
+  m_Wakeup.Signal();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3550,16 +5739,61 @@ void RouterThread::UniverseData(const CID &source, const char *source_name, cons
   QMutexLocker locker(&m_sACNRecv.mutex);
 
   unsigned int ip = source_ip.GetV4Address();
+  qint64 now = m_sACNRecv.clock.elapsed();
+
+  sACNRecvUniverse &recvUniverse = m_sACNRecv.Add(universe);
+  sACNUniverseSource *recvSource = recvUniverse.FindSource(source);
+  bool added = false;
+  if (!recvSource)
+  {
+    recvSource = recvUniverse.AddSource(source);
+    if (!recvSource)
+    {
+      sACNUniverseSource *evicted = recvUniverse.FindEvictable(priority, now);
+      if (evicted)
+      {
+        char str[CID::CIDSTRINGBYTES];
+        CID::CIDIntoString(evicted->cid, str);
+        m_sACNRecv.log.AddWarning(QStringLiteral("sACN universe %1 has more than %2 sources, dropped: %3 {%4}, priority: %5, last heard %6ms ago")
+                                      .arg(universe)
+                                      .arg(static_cast<int>(MAX_UNIVERSE_SOURCES))
+                                      .arg(QString::fromUtf8(evicted->name.data()))
+                                      .arg(str)
+                                      .arg(evicted->priority)
+                                      .arg(now - evicted->lastPacket)
+                                      .toUtf8()
+                                      .constData());
+
+        recvUniverse.RemoveSource(*evicted);
+        recvSource = recvUniverse.AddSource(source);
+      }
+    }
+
+    if (!recvSource)
+    {
+      if (!recvUniverse.sourcesFull)
+      {
+        recvUniverse.sourcesFull = true;
+        m_sACNRecv.log.AddWarning(QStringLiteral("sACN universe %1 has more than %2 sources, ignoring new sources").arg(universe).arg(static_cast<int>(MAX_UNIVERSE_SOURCES)).toUtf8().constData());
+      }
+      return;
+    }
+
+    added = true;
+    m_sACNRecv.SetDirty(recvUniverse, /*remerge*/ true);
+  }
+
+  recvSource->lastPacket = now;
 
-  sACNSource &recvSource = m_sACNRecv.sources[source];
-  if (source_name)
-    recvSource.name = QString::fromUtf8(source_name);
+  if (source_name && strncmp(recvSource->name.data(), source_name, recvSource->name.size() - 1) != 0)
+  {
+    strncpy(recvSource->name.data(), source_name, recvSource->name.size() - 1);
+    recvSource->name.back() = 0;
+  }
 
-  std::pair<UNIVERSE_LIST::iterator, bool> result = recvSource.universes.insert(std::make_pair(universe, Universe()));
-  Universe &recvUniverse = result.first->second;
   if (start_code == STARTCODE_DMX)
   {
-    if (result.second)
+    if (added)
     {
       char cidStr[CID::CIDSTRINGBYTES];
       CID::CIDIntoString(source, cidStr);
@@ -3567,28 +5801,34 @@ void RouterThread::UniverseData(const CID &source, const char *source_name, cons
       char ipStr[CIPAddr::ADDRSTRINGBYTES];
       CIPAddr::AddrIntoString(source_ip, ipStr, /*showport*/ false, /*showint*/ false);
 
-      recvUniverse.ips.insert(ip);
+      recvSource->AddIP(ip);
 
-      m_sACNRecv.log.AddInfo(
-          QStringLiteral("sACN universe %1 source appeared: %2 {%3}, priority: %4, ip: %5").arg(universe).arg(recvSource.name).arg(cidStr).arg(priority).arg(ipStr).toUtf8().constData());
+      m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 source appeared: %2 {%3}, priority: %4, ip: %5")
+                                 .arg(universe)
+                                 .arg(QString::fromUtf8(recvSource->name.data()))
+                                 .arg(cidStr)
+                                 .arg(priority)
+                                 .arg(ipStr)
+                                 .toUtf8()
+                                 .constData());
     }
     else
     {
-      if (recvUniverse.priority != priority)
+      if (recvSource->priority != priority)
       {
         char str[CID::CIDSTRINGBYTES];
         CID::CIDIntoString(source, str);
         m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 source priority changed: %2 {%3}, priority: %4 -> %5")
                                    .arg(universe)
-                                   .arg(recvSource.name)
+                                   .arg(QString::fromUtf8(recvSource->name.data()))
                                    .arg(str)
-                                   .arg(recvUniverse.priority)
+                                   .arg(recvSource->priority)
                                    .arg(priority)
                                    .toUtf8()
                                    .constData());
       }
 
-      if (recvUniverse.ips.insert(ip).second)
+      if (recvSource->AddIP(ip))
       {
         char cidStr[CID::CIDSTRINGBYTES];
         CID::CIDIntoString(source, cidStr);
@@ -3596,21 +5836,39 @@ void RouterThread::UniverseData(const CID &source, const char *source_name, cons
         char ipStr[CIPAddr::ADDRSTRINGBYTES];
         CIPAddr::AddrIntoString(source_ip, ipStr, /*showport*/ false, /*showint*/ false);
 
-        m_sACNRecv.log.AddInfo(
-            QStringLiteral("sACN universe %1 source appeared: %2 {%3}, priority: %4, ip: %5").arg(universe).arg(recvSource.name).arg(cidStr).arg(priority).arg(ipStr).toUtf8().constData());
+        m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 source appeared: %2 {%3}, priority: %4, ip: %5")
+                                   .arg(universe)
+                                   .arg(QString::fromUtf8(recvSource->name.data()))
+                                   .arg(cidStr)
+                                   .arg(priority)
+                                   .arg(ipStr)
+                                   .toUtf8()
+                                   .constData());
       }
     }
 
-    recvUniverse.priority = priority;
-    recvUniverse.ip = ip;
-    m_sACNRecv.dirtyUniverses.insert(universe);
+    m_sACNRecv.SetDirty(recvUniverse, /*remerge*/ recvSource->priority != priority);
+    recvSource->priority = priority;
+    recvSource->ip = ip;
 
     if (slot_count != 0 && pdata)
-      memcpy(recvUniverse.dmx.data(), pdata, std::min(recvUniverse.dmx.size(), static_cast<size_t>(slot_count)));
+    {
+      // note changed slots, so the merge only revisits those
+      size_t count = std::min(recvSource->dmx.size(), static_cast<size_t>(slot_count));
+      for (size_t i = 0; i < count; ++i)
+      {
+        if (recvSource->dmx[i] != pdata[i])
+        {
+          recvSource->dmx[i] = pdata[i];
+          recvSource->changedSlots[i >> 6] |= (static_cast<uint64_t>(1) << (i & 63));
+          recvSource->hasChangedSlots = true;
+        }
+      }
+    }
   }
   else if (start_code == STARTCODE_PRIORITY)
   {
-    if (result.second)
+    if (added)
     {
       char cidStr[CID::CIDSTRINGBYTES];
       CID::CIDIntoString(source, cidStr);
@@ -3618,17 +5876,24 @@ void RouterThread::UniverseData(const CID &source, const char *source_name, cons
       char ipStr[CIPAddr::ADDRSTRINGBYTES];
       CIPAddr::AddrIntoString(source_ip, ipStr, /*showport*/ false, /*showint*/ false);
 
-      recvUniverse.ips.insert(ip);
+      recvSource->AddIP(ip);
 
-      m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 per channel priority source appeared: %2 {%3}, ip: %4").arg(universe).arg(recvSource.name).arg(cidStr).arg(ipStr).toUtf8().constData());
+      m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 per channel priority source appeared: %2 {%3}, ip: %4")
+                                 .arg(universe)
+                                 .arg(QString::fromUtf8(recvSource->name.data()))
+                                 .arg(cidStr)
+                                 .arg(ipStr)
+                                 .toUtf8()
+                                 .constData());
     }
-    else if (!recvUniverse.hasPerChannelPriority)
+    else if (!recvSource->hasPerChannelPriority)
     {
       char str[CID::CIDSTRINGBYTES];
       CID::CIDIntoString(source, str);
-      m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 changed to per channel priority: %2 {%3}").arg(universe).arg(recvSource.name).arg(str).toUtf8().constData());
+      m_sACNRecv.log.AddInfo(
+          QStringLiteral("sACN universe %1 changed to per channel priority: %2 {%3}").arg(universe).arg(QString::fromUtf8(recvSource->name.data())).arg(str).toUtf8().constData());
     }
-    else if (recvUniverse.ips.insert(ip).second)
+    else if (recvSource->AddIP(ip))
     {
       char cidStr[CID::CIDSTRINGBYTES];
       CID::CIDIntoString(source, cidStr);
@@ -3636,16 +5901,33 @@ void RouterThread::UniverseData(const CID &source, const char *source_name, cons
       char ipStr[CIPAddr::ADDRSTRINGBYTES];
       CIPAddr::AddrIntoString(source_ip, ipStr, /*showport*/ false, /*showint*/ false);
 
-      m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 per channel priority source appeared: %2 {%3}, ip: %4").arg(universe).arg(recvSource.name).arg(cidStr).arg(ipStr).toUtf8().constData());
+      m_sACNRecv.log.AddInfo(QStringLiteral("sACN universe %1 per channel priority source appeared: %2 {%3}, ip: %4")
+                                 .arg(universe)
+                                 .arg(QString::fromUtf8(recvSource->name.data()))
+                                 .arg(cidStr)
+                                 .arg(ipStr)
+                                 .toUtf8()
+                                 .constData());
     }
 
-    recvUniverse.hasPerChannelPriority = true;
-    recvUniverse.ip = ip;
-    m_sACNRecv.dirtyUniverses.insert(universe);
+    bool remerge = !recvSource->hasPerChannelPriority;
+    recvSource->hasPerChannelPriority = true;
+    recvSource->ip = ip;
 
     if (slot_count != 0 && pdata)
-      memcpy(recvUniverse.channelPriority.data(), pdata, std::min(recvUniverse.channelPriority.size(), static_cast<size_t>(slot_count)));
+    {
+      size_t count = std::min(recvSource->channelPriority.size(), static_cast<size_t>(slot_count));
+      if (memcmp(recvSource->channelPriority.data(), pdata, count) != 0)
+      {
+        memcpy(recvSource->channelPriority.data(), pdata, count);
+        remerge = true;
+      }
+    }
+
+    m_sACNRecv.SetDirty(recvUniverse, remerge);
   }
+
+  m_Wakeup.Signal();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3672,142 +5954,3 @@ void RouterThread::LogMIDI(bool send, const std::string &name, const std::vector
 
   m_PrivateLog.Add(send ? EosLog::LOG_MSG_TYPE_SEND : EosLog::LOG_MSG_TYPE_RECV, log);
 }
-
-////////////////////////////////////////////////////////////////////////////////
-
-QString ScriptEngine::evaluate(const QString &script, EosLog *log /*= nullptr*/, const QString &label /*= QString()*/, const QString &path /*= QString()*/, const OSCArgument *args /*= nullptr*/,
-                               size_t argsCount /*= 0*/, const uint8_t *universe /*= nullptr*/, size_t universeCount /*= 0*/, EosPacket *packet /*= nullptr*/)
-{
-  // set globals
-  m_JS.globalObject().setProperty(QLatin1String("NAME"), label);
-  m_JS.globalObject().setProperty(QLatin1String("OSC"), path);
-
-  QJSValue jsarray;
-
-  if (args && argsCount != 0)
-  {
-    jsarray = m_JS.newArray(static_cast<quint32>(argsCount));
-    for (quint32 i = 0; i < static_cast<quint32>(argsCount); ++i)
-    {
-      switch (args[i].GetType())
-      {
-        case OSCArgument::OSC_TYPE_INT32:
-        case OSCArgument::OSC_TYPE_INT64:
-        case OSCArgument::OSC_TYPE_TIME:
-        case OSCArgument::OSC_TYPE_RGBA32:
-        case OSCArgument::OSC_TYPE_MIDI:
-        {
-          int n = 0;
-          if (args[i].GetInt(n))
-            jsarray.setProperty(i, n);
-        }
-        break;
-
-        case OSCArgument::OSC_TYPE_FLOAT32:
-        {
-          float n = 0;
-          if (args[i].GetFloat(n))
-            jsarray.setProperty(i, n);
-        }
-        break;
-
-        case OSCArgument::OSC_TYPE_FLOAT64:
-        {
-          double n = 0;
-          if (args[i].GetDouble(n))
-            jsarray.setProperty(i, n);
-        }
-        break;
-
-        case OSCArgument::OSC_TYPE_TRUE: jsarray.setProperty(i, true); break;
-        case OSCArgument::OSC_TYPE_FALSE: jsarray.setProperty(i, false); break;
-        case OSCArgument::OSC_TYPE_INFINITY: jsarray.setProperty(i, std::numeric_limits<int>::infinity()); break;
-
-        default:
-        {
-          std::string str;
-          if (args[i].GetString(str))
-            jsarray.setProperty(i, QString::fromStdString(str));
-        }
-        break;
-      }
-    }
-  }
-  else if (universe && universeCount != 0)
-  {
-    jsarray = m_JS.newArray(static_cast<quint32>(universeCount));
-    for (quint32 i = 0; i < static_cast<quint32>(universeCount); ++i)
-      jsarray.setProperty(i, universe[i]);
-  }
-  else
-    jsarray = m_JS.newArray(0);
-
-  m_JS.globalObject().setProperty(QLatin1String("ARGS"), jsarray);
-  m_JS.globalObject().setProperty(QLatin1String("LOGS"), m_JS.newArray(0));
-
-  // evaluate
-  QStringList stack_trace;
-  QJSValue eval = m_JS.evaluate(script, QString(), 1, &stack_trace);
-  if (eval.isError())
-  {
-    QString error = eval.toString();
-
-    if (!stack_trace.isEmpty())
-    {
-      if (!error.isEmpty())
-        error += QLatin1Char('\n');
-
-      error += stack_trace.join(QLatin1Char('\n'));
-    }
-
-    return error;
-  }
-
-  if (log)
-  {
-    jsarray = m_JS.globalObject().property(QLatin1String("LOGS"));
-    quint32 count = jsarray.property(QLatin1String("length")).toUInt();
-    for (quint32 i = 0; i < count; ++i)
-    {
-      QString msg = jsarray.property(i).toString();
-      if (!msg.isEmpty())
-        log->AddInfo(msg.toUtf8().constData());
-    }
-  }
-
-  if (!packet)
-    return QString();  // done with evaluation, no packet needed
-
-  QString sendPath = m_JS.globalObject().property(QLatin1String("OSC")).toString();
-  if (sendPath.isEmpty())
-    return QString();  // done with evaluation, no packet needed
-
-  OSCPacketWriter osc(sendPath.toUtf8().constData());
-
-  jsarray = m_JS.globalObject().property(QLatin1String("ARGS"));
-  quint32 count = jsarray.property(QLatin1String("length")).toUInt();
-  for (quint32 i = 0; i < count; ++i)
-  {
-    QJSValue arg = jsarray.property(i);
-    switch (arg.toPrimitive().type())
-    {
-      case QJSPrimitiveValue::Boolean: osc.AddBool(arg.toBool()); break;
-      case QJSPrimitiveValue::Integer: osc.AddInt32(arg.toInt()); break;
-      case QJSPrimitiveValue::Double: osc.AddFloat32(static_cast<float>(arg.toNumber())); break;
-      case QJSPrimitiveValue::String: osc.AddString(arg.toString().toStdString()); break;
-      default: break;
-    }
-  }
-
-  size_t packetSize = 0;
-  char *packetData = osc.Create(packetSize);
-  if (packetData && packetSize)
-  {
-    *packet = EosPacket(packetData, static_cast<int>(packetSize));
-    delete[] packetData;
-  }
-
-  return QString();
-}
-
-////////////////////////////////////////////////////////////////////////////////
@@ -34,6 +34,42 @@
 #include "OSCParser.h"
 #endif
 
+#ifndef OSC_MESSAGE_VIEW_H
+#include "OSCMessageView.h"
+#endif
+
+#ifndef OSC_PATH_MATCHER_H
+#include "OSCPathMatcher.h"
+#endif
+
+#ifndef OSC_PATH_TEMPLATE_H
+#include "OSCPathTemplate.h"
+#endif
+
+#ifndef SCRIPT_ENGINE_H
+#include "ScriptEngine.h"
+#endif
+
+#ifndef SPSC_QUEUE_H
+#include "SPSCQueue.h"
+#endif
+
+#ifndef PSN_OSC_WRITER_H
+#include "PSNOSCWriter.h"
+#endif
+
+#ifndef UDP_BATCH_H
+#include "UdpBatch.h"
+#endif
+
+#ifndef ARTNET_POLL_REPLY_H
+#include "ArtNetPollReply.h"
+#endif
+
+#ifndef EOS_TIMER_H
+#include "EosTimer.h"
+#endif
+
 #ifndef ITEM_STATE_H
 #include "ItemState.h"
 #endif
@@ -112,7 +148,10 @@
 #include "RtMidi.h"
 #endif
 
+#include <atomic>
+#include <memory>
 #include <unordered_set>
+#include <utility>
 
 class EosTcp;
 
@@ -124,21 +163,6 @@ class psn_encoder;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-class ScriptEngine
-{
-public:
-  ScriptEngine() = default;
-
-  QJSEngine &js() { return m_JS; }
-  QString evaluate(const QString &script, EosLog *log = nullptr, const QString &label = QString(), const QString &path = QString(), const OSCArgument *args = nullptr, size_t argsCount = 0,
-                   const uint8_t *universe = nullptr, size_t universeCount = 0, EosPacket *packet = nullptr);
-
-private:
-  QJSEngine m_JS;
-};
-
-////////////////////////////////////////////////////////////////////////////////
-
 class Router
 {
 public:
@@ -171,6 +195,25 @@ public:
     QString artNetIP;
     bool levelChangesOnly = false;
     QString script;
+
+    // tuning, not saved with show files
+    bool polling = false;                // legacy msleep(1) router loop instead of wakeups
+    bool latencyStats = false;           // periodically log p50/p99 routing latency
+    bool udpBatchRecv = true;            // UdpBatchIn input, recvmmsg on Linux
+    unsigned int udpRecvBufferSize = 0;  // SO_RCVBUF for batch input, 0 for OS default
+    bool udpBatchSend = true;            // UdpBatchOut output, sendmmsg on Linux
+    bool psnBundle = false;              // PSN input as one OSC bundle per frame
+    unsigned int psnTrackerMin = 0;      // PSN trackers outside this id range are ignored
+    unsigned int psnTrackerMax = 0xffff;
+    unsigned int psnOutputRate = 60;     // PSN output data frames per second, per destination
+    bool artNetSync = false;             // ArtSync after each ArtNet output frame, so nodes latch all universes together
+    bool artNetUnicast = false;          // ArtNet output only to nodes found by ArtPoll, broadcast for universes with none
+    unsigned int udpBundleSize = 0;      // max bytes when packing queued OSC output into bundles, 0 for off
+    unsigned int udpInReactors = 0;      // UdpPoller threads shared by all UDP inputs, 0 for a thread per input
+    bool udpInReactorPinned = false;     // pin each reactor thread to its own cpu
+    unsigned int routerShards = 0;       // threads routing plain UDP/OSC input beside the router thread, 0 for off
+    unsigned int scriptWorkers = 0;      // threads running route scripts, each with its own engine and copy of the globals, 0 to run them on the router thread
+    unsigned int scriptTimeoutMS = 100;  // scripts running longer are interrupted, 0 for no limit
   };
 
   typedef std::vector<sRoute> ROUTES;
@@ -204,11 +247,62 @@ protected:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// wakes the router thread when an input thread has queued work
+//
+// only the first Signal after each Wait takes the mutex, later ones see m_Pending and return,
+// so producers pushing a burst of packets do not lock once per packet
+class RouterWakeup
+{
+public:
+  RouterWakeup() = default;
+
+  virtual void Signal();
+  virtual void Wait(unsigned long timeoutMS);
+
+private:
+  std::atomic<bool> m_Pending{false};  // signaled since the waiter last woke
+  QMutex m_Mutex;
+  QWaitCondition m_Cond;
+  bool m_Signaled = false;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// receive-to-dispatch latency samples, reported as percentiles
+class LatencyStats
+{
+public:
+  LatencyStats() = default;
+
+  static qint64 Now();
+
+  virtual void Add(qint64 recvTime);
+  virtual bool Report(qint64 intervalMS, QString &report);
+
+private:
+  enum EnumConstants
+  {
+    MAX_SAMPLES = 8192
+  };
+
+  std::vector<qint64> m_Samples;
+  size_t m_Count = 0;
+  QElapsedTimer m_Timer;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class UdpInReactorThread;
+
 class EosUdpInThread : public QThread
 {
 public:
   struct sRecvPacket
   {
+    sRecvPacket()
+      : ip(0)
+    {
+    }
     sRecvPacket(const char *data, int size, unsigned int Ip)
       : packet(data, size)
       , ip(Ip)
@@ -216,6 +310,7 @@ public:
     }
     EosPacket packet;
     unsigned int ip;
+    qint64 recvTime = 0;  // LatencyStats::Now() when queued, 0 if unknown
   };
   typedef std::vector<sRecvPacket> RECV_Q;
 
@@ -234,36 +329,133 @@ public:
   EosUdpInThread();
   virtual ~EosUdpInThread();
 
-  virtual void Start(const EosAddr &addr, QString multicastIP, Protocol protocol, ItemStateTable::ID itemStateTableId, unsigned int reconnectDelayMS, bool mute);
+  virtual void Start(const EosAddr &addr, QString multicastIP, Protocol protocol, ItemStateTable::ID itemStateTableId, unsigned int reconnectDelayMS, bool mute, RouterWakeup *wakeup,
+                     bool batchRecv, unsigned int recvBufferSize, UdpInReactorThread *reactor);
   virtual void Stop();
+  virtual bool IsActive() const;
   const EosAddr &GetAddr() const { return m_Addr; }
   Protocol GetProtocol() const { return m_Protocol; }
   ItemStateTable::ID GetItemStateTableId() const { return m_ItemStateTableId; }
   ItemState::EnumState GetState();
   virtual void Flush(EosLog::LOG_Q &logQ, RECV_Q &recvQ);
+  virtual void FlushLog(EosLog::LOG_Q &logQ);
+  virtual void PopPackets(RECV_Q &recvQ);
   virtual void Mute(bool b) { m_Mute = b; }
+  void SetSharded(bool b) { m_Sharded = b; }
+  bool IsSharded() const { return m_Sharded; }
+  void SetPSNBundle(bool b) { m_PSNBundle = b; }
+  virtual void SetPSNFilter(const std::vector<std::string> &paths, uint16_t minTracker, uint16_t maxTracker);
 
 protected:
   EosAddr m_Addr;
   QString m_MulticastIP;
   Protocol m_Protocol = Protocol::kDefault;
   ItemStateTable::ID m_ItemStateTableId;
-  ItemState::EnumState m_State;
+  std::atomic<ItemState::EnumState> m_State;
   unsigned int m_ReconnectDelay;
   bool m_Run;
   EosLog m_Log;
   EosLog m_PrivateLog;
-  RECV_Q m_Q;
+  EosLog::LOG_Q m_PrivateLogQ;
+  std::atomic<bool> m_LogPending{false};
+  SPSCQueue<sRecvPacket> m_Q;
   QRecursiveMutex m_Mutex;
   psn::psn_decoder *m_PSNDecoder = nullptr;
   std::optional<uint8_t> m_PSNFrame;
+  PSNOSCWriter m_PSNWriter;
+  bool m_PSNBundle = false;  // one OSC bundle per PSN frame instead of a packet per message
   bool m_Mute;
+  RouterWakeup *m_Wakeup = nullptr;
+  bool m_BatchRecv = false;
+  unsigned int m_RecvBufferSize = 0;
+  UdpInReactorThread *m_Reactor = nullptr;  // socket owned by a shared reactor instead of this thread
+  std::atomic<bool> m_ReactorActive{false};
+  bool m_Sharded = false;  // packets drained by a routing shard instead of the router thread
+
+  friend class UdpInReactorThread;
 
   virtual void run();
+  virtual void RunBatchRecv();
   virtual void UpdateLog();
   virtual void SetState(ItemState::EnumState state);
-  virtual void RecvPacket(const QHostAddress &host, const char *data, int len, OSCParser &logParser, PacketLogger &packetLogger);
-  virtual void QueuePacket(const QHostAddress &host, const char *data, int len, OSCParser &logParser, PacketLogger &packetLogger);
+  virtual void RecvPacket(const QHostAddress &host, const char *data, int len, qint64 recvTime, OSCParser &logParser, PacketLogger &packetLogger);
+  virtual void QueuePacket(const QHostAddress &host, const char *data, int len, qint64 recvTime, OSCParser &logParser, PacketLogger &packetLogger);
+  virtual void PushPacket(unsigned int ip, const char *data, int len, qint64 recvTime, OSCParser &logParser, PacketLogger &packetLogger);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// one UdpPoller thread servicing the sockets of many EosUdpInThread inputs
+//
+// inputs keep their own queue, log, item state, and reconnect delay, the reactor only replaces
+// their threads, so the router drains them exactly as it does thread per input
+class UdpInReactorThread : public QThread
+{
+public:
+  UdpInReactorThread();
+  virtual ~UdpInReactorThread();
+
+  virtual void AddInput(EosUdpInThread *input);
+  virtual void RemoveInput(EosUdpInThread *input);  // returns once the reactor no longer refers to input
+  virtual void Start(int cpu);
+  virtual void Stop();
+  bool empty() const { return m_Inputs.empty(); }
+
+  static bool IsSupported();
+
+protected:
+  struct sInput
+  {
+    EosUdpInThread *input = nullptr;  // null once the input has ended
+    UdpBatchIn *udpIn = nullptr;
+    PacketLogger *packetLogger = nullptr;
+    EosTimer reconnectTimer;
+  };
+
+  typedef std::vector<sInput> INPUTS;
+
+  INPUTS m_Inputs;
+  UdpPoller m_Poller;
+  int m_Cpu = -1;  // pinned cpu, -1 for any
+  bool m_Run = false;
+  QMutex m_RemoveMutex;
+  QWaitCondition m_Removed;
+  std::vector<EosUdpInThread *> m_Remove;  // inputs stopping while the reactor runs
+  std::atomic<bool> m_HasRemove{false};
+
+  virtual void run();
+  virtual void Open(size_t index);
+  virtual void Close(size_t index);
+  virtual void Reconnect(size_t index);
+  virtual void End(size_t index);
+  virtual void EndRemoved();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// wakes the router thread when the ArtNet socket, which the router thread reads itself, becomes readable
+//
+// after each wakeup it waits for Rearm, called once the router has read the socket, so pending
+// datagrams wake the router once instead of on every pass until they are read
+class ArtNetWakeThread : public QThread
+{
+public:
+  ArtNetWakeThread() = default;
+  virtual ~ArtNetWakeThread();
+
+  virtual void Start(artnet_node server, RouterWakeup &wakeup);
+  virtual void Stop();
+  virtual void Rearm();
+
+protected:
+  artnet_node m_Server = nullptr;
+  RouterWakeup *m_Wakeup = nullptr;
+  std::atomic<bool> m_Run{false};
+  QMutex m_Mutex;
+  QWaitCondition m_Cond;
+  bool m_Rearmed = false;
+
+  virtual void run();
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -274,25 +466,33 @@ public:
   EosUdpOutThread();
   virtual ~EosUdpOutThread();
 
-  virtual void Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, unsigned int reconnectDelayMS);
+  virtual void Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, unsigned int reconnectDelayMS, bool batchSend, unsigned int bundleSize, size_t producerCount);
   virtual void Stop();
   const EosAddr &GetAddr() const { return m_Addr; }
   ItemStateTable::ID GetItemStateTableId() const { return m_ItemStateTableId; }
   ItemState::EnumState GetState();
   virtual bool Send(const EosPacket &packet);
+  virtual bool Send(const EosPacket &packet, size_t producer);
   virtual void Flush(EosLog::LOG_Q &logQ);
+  void SetSharded(bool b) { m_Sharded = b; }
+  bool IsSharded() const { return m_Sharded; }
 
 protected:
   EosAddr m_Addr;
   ItemStateTable::ID m_ItemStateTableId;
-  ItemState::EnumState m_State;
+  std::atomic<ItemState::EnumState> m_State;
   unsigned int m_ReconnectDelay;
   bool m_Run;
   EosLog m_Log;
   EosLog m_PrivateLog;
-  EosPacket::Q m_Q;
-  bool m_QEnabled;
+  EosLog::LOG_Q m_PrivateLogQ;
+  std::atomic<bool> m_LogPending{false};
+  std::vector<SPSCQueue<EosPacket> *> m_Qs;  // one per producer thread, router thread is 0
+  std::atomic<bool> m_QEnabled;
   QRecursiveMutex m_Mutex;
+  bool m_Sharded = false;  // referenced by routing shards, kept until shutdown
+  bool m_BatchSend = false;
+  unsigned int m_BundleSize = 0;  // 0 sends each OSC message on its own
 
   virtual void run();
   virtual void UpdateLog();
@@ -307,8 +507,9 @@ public:
   EosTcpClientThread();
   virtual ~EosTcpClientThread();
 
-  virtual void Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, bool mute);
-  virtual void Start(EosTcp *tcp, const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, bool mute);
+  virtual void Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, bool mute, RouterWakeup *wakeup);
+  virtual void Start(EosTcp *tcp, const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, bool mute,
+                     RouterWakeup *wakeup);
   virtual void Stop();
   const EosAddr &GetAddr() const { return m_Addr; }
   ItemStateTable::ID GetItemStateTableId() const { return m_ItemStateTableId; }
@@ -322,16 +523,19 @@ protected:
   EosTcp *m_AcceptedTcp;
   EosAddr m_Addr;
   ItemStateTable::ID m_ItemStateTableId;
-  ItemState::EnumState m_State;
+  std::atomic<ItemState::EnumState> m_State;
   OSCStream::EnumFrameMode m_FrameMode;
   unsigned int m_ReconnectDelay;
   bool m_Run;
   EosLog m_Log;
   EosLog m_PrivateLog;
-  EosUdpInThread::RECV_Q m_RecvQ;
-  EosPacket::Q m_SendQ;
+  EosLog::LOG_Q m_PrivateLogQ;
+  std::atomic<bool> m_LogPending{false};
+  SPSCQueue<EosUdpInThread::sRecvPacket> m_RecvQ;
+  SPSCQueue<EosPacket> m_SendQ;
   QRecursiveMutex m_Mutex;
   bool m_Mute;
+  RouterWakeup *m_Wakeup = nullptr;
 
   virtual void run();
   virtual void UpdateLog();
@@ -357,7 +561,7 @@ public:
   EosTcpServerThread();
   virtual ~EosTcpServerThread();
 
-  virtual void Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS);
+  virtual void Start(const EosAddr &addr, ItemStateTable::ID itemStateTableId, OSCStream::EnumFrameMode frameMode, unsigned int reconnectDelayMS, RouterWakeup *wakeup);
   virtual void Stop();
   const EosAddr &GetAddr() const { return m_Addr; }
   ItemStateTable::ID GetItemStateTableId() const { return m_ItemStateTableId; }
@@ -376,6 +580,7 @@ protected:
   EosLog m_PrivateLog;
   CONNECTION_Q m_Q;
   QRecursiveMutex m_Mutex;
+  RouterWakeup *m_Wakeup = nullptr;
 
   virtual void run();
   virtual void UpdateLog();
@@ -401,34 +606,103 @@ private:
 class RouterThread : public QThread, private OSCParserClient, private IStreamACNCliNotify
 {
 public:
+  enum EnumArtNetConstants
+  {
+    ARTNET_PORT_ADDRESS_COUNT = 0x8000,  // 15 bit Net/Sub-Net/Universe
+    ARTNET_POLL_INTERVAL_MS = 2500,
+    ARTNET_SUBSCRIBER_POLLS = 3  // polls without a reply before a node is dropped
+  };
+
+  enum EnumPSNConstants
+  {
+    PSN_REFRESH_MS = 1000  // info frames, and data frames while no tracker changes
+  };
+
   struct ArtNetSendUniverse
   {
     std::array<uint8_t, ARTNET_DMX_LENGTH> dmx;
     bool dirty = true;
-    QElapsedTimer timer;
+    QElapsedTimer timer;    // since the last send
+    uint32_t frames = 0;    // sent since the last stats report
+    double intervalMS = 0;   // between the last two sends
+    double jitterMS = 0;    // smoothed change in send interval, as RFC 3550 interarrival jitter
   };
 
   struct ArtNetRecvUniverse
   {
-    artnet_node node = nullptr;
+    uint16_t number = 0;  // port address
+    std::array<uint8_t, ARTNET_DMX_LENGTH> dmx;
+    size_t length = 0;  // 0 until the first ArtDmx
+    unsigned int ip = 0;
+    bool dirty = false;
     std::array<uint8_t, ARTNET_DMX_LENGTH> prevDMX;
     bool hasPrevDMX = false;
   };
 
-  typedef std::unordered_map<uint8_t, ArtNetSendUniverse> ARTNET_SEND_UNIVERSE_LIST;
-  typedef std::unordered_map<uint8_t, ArtNetRecvUniverse> ARTNET_RECV_UNIVERSE_LIST;
-  typedef std::unordered_map<artnet_node, /*ip*/ unsigned int> ARTNET_NODE_IP_LIST;
-  typedef std::unordered_set<artnet_node> ARTNET_DIRTY_LIST;
+  // node that reported an output port on a universe in its ArtPollReply
+  struct ArtNetSubscriber
+  {
+    unsigned int ip = 0;
+    unsigned int poll = 0;  // ArtNet::pollCount when last seen
+  };
+
+  typedef std::unordered_map<uint16_t, ArtNetSendUniverse> ARTNET_SEND_UNIVERSE_LIST;
+  typedef std::vector<ArtNetRecvUniverse> ARTNET_RECV_UNIVERSE_LIST;
+  typedef std::vector<uint16_t> ARTNET_DIRTY_LIST;
+  typedef std::vector<ArtNetSubscriber> ARTNET_SUBSCRIBER_LIST;
+  typedef std::unordered_map<uint16_t, ARTNET_SUBSCRIBER_LIST> ARTNET_SUBSCRIBERS;
 
+  // one libartnet node, so one socket, sends every output universe and receives every ArtDmx,
+  // demultiplexed by port address into a flat table of input universes
   struct ArtNet
   {
     artnet_node server = nullptr;
+    ArtNetWakeThread *wakeThread = nullptr;  // while anything is read from server
     ARTNET_SEND_UNIVERSE_LIST output;
+    std::vector<uint16_t> inputIndex;  // by port address, position in inputs + 1
     ARTNET_RECV_UNIVERSE_LIST inputs;
-    ARTNET_NODE_IP_LIST inputIPs;
-    ARTNET_DIRTY_LIST dirty;
+    ARTNET_DIRTY_LIST dirty;   // positions in inputs with new levels since the last read
+    QElapsedTimer frameTimer;  // since the last output burst
+    QElapsedTimer statsTimer;
+    ARTNET_SUBSCRIBERS subscribers;  // by port address, from ArtPollReply
+    unsigned int pollCount = 0;
+    QElapsedTimer pollTimer;
+    ArtNetPollReply::PAGES pollReplyPages;  // answer to ArtPoll, advertising every input universe
+
+    void AddSubscriber(uint16_t universeNumber, unsigned int ip);
+    const ARTNET_SUBSCRIBER_LIST *FindSubscribers(uint16_t universeNumber);  // nullptr when no node replied in the last few polls
+
+    ArtNet()
+      : inputIndex(ARTNET_PORT_ADDRESS_COUNT, 0)
+    {
+    }
+
+    ArtNetRecvUniverse *FindInput(uint16_t universeNumber)
+    {
+      uint16_t i = (universeNumber < inputIndex.size()) ? inputIndex[universeNumber] : 0;
+      return (i == 0) ? nullptr : &inputs[i - 1];
+    }
+
+    const ArtNetRecvUniverse *FindInput(uint16_t universeNumber) const
+    {
+      uint16_t i = (universeNumber < inputIndex.size()) ? inputIndex[universeNumber] : 0;
+      return (i == 0) ? nullptr : &inputs[i - 1];
+    }
+  };
+
+  // every tracker routed to one PSN destination, merged from individual OSC messages
+  // and sent as whole frames, so receivers see all trackers at a steady rate
+  struct PSNOutput
+  {
+    psn::tracker_map trackers;
+    EosUdpOutThread *thread = nullptr;
+    bool dirty = false;        // trackers changed since the last data frame
+    QElapsedTimer frameTimer;  // since the last data frame
+    QElapsedTimer infoTimer;   // since the last info frame
   };
 
+  typedef std::map<EosAddr, PSNOutput> PSN_OUTPUTS;
+
   RouterThread(const Router::ROUTES &routes, const Router::CONNECTIONS &tcpConnections, const Router::Settings &settings, const ItemStateTable &itemStateTable, unsigned int reconnectDelayMS);
   virtual ~RouterThread();
 
@@ -436,10 +710,24 @@ public:
   virtual void Sync(EosLog::LOG_Q &logQ, ItemStateTable &itemStateTable);
 
 protected:
+  // sACN/ArtNet output options from the destination path: /offset/N, /priority/N, /perChannelPriority/N
+  struct sDMXPathOptions
+  {
+    int offset = 0;
+    uint8_t priority = 0;
+    bool hasPriority = false;
+    bool perChannelPriority = false;
+  };
+
   struct sRouteDst
   {
     QString label;
     EosRouteDst dst;
+    OSCPathTemplate path;  // dst.path, compiled
+    ScriptEngine::ID script = ScriptEngine::sm_Invalid_Id;
+    bool staticDMXOptions = false;  // sACN/ArtNet output sent without an OSC message, path options resolved when routes are built
+    bool oscPassThrough = false;    // OSC input sent on as received, same path and arguments
+    sDMXPathOptions dmxOptions;
     ItemStateTable::ID srcItemStateTableId;
     ItemStateTable::ID dstItemStateTableId;
   };
@@ -462,55 +750,203 @@ protected:
   typedef std::pair<unsigned short, ROUTES_BY_IP> ROUTES_BY_PORT_PAIR;
 
   typedef std::map<EosAddr, EosUdpInThread *> UDP_IN_THREADS;
+  typedef std::vector<UdpInReactorThread *> UDP_IN_REACTORS;
   typedef std::map<EosAddr, EosUdpOutThread *> UDP_OUT_THREADS;
 
   typedef std::map<EosAddr, EosTcpClientThread *> TCP_CLIENT_THREADS;
   typedef std::map<EosAddr, EosTcpServerThread *> TCP_SERVER_THREADS;
 
-  typedef std::vector<const ROUTE_DESTINATIONS *> DESTINATIONS_LIST;
+  struct sRouteDstRange
+  {
+    const sRouteDst *first = nullptr;
+    size_t count = 0;
+  };
+
+  typedef std::vector<sRouteDstRange> DESTINATIONS_LIST;
+
+  // immutable, flattened copy of a ROUTES_BY_PORT table for per-packet lookups
+  //
+  // exact paths live in one open addressing hash keyed on (port, ip, path), compared as UTF-8 bytes,
+  // and all destinations are copied into a single contiguous array in ROUTES_BY_PORT order
+  class RouteTable
+  {
+  public:
+    RouteTable() = default;
+
+    virtual void Build(const ROUTES_BY_PORT &routesByPort);
+    virtual void Clear();
+    virtual void Find(unsigned short port, unsigned int ip, bool isOSC, const char *path, size_t pathLen, DESTINATIONS_LIST &destinations) const;
+    bool empty() const { return m_Entries.empty() && m_Groups.empty(); }
+
+  private:
+    enum EnumConstants
+    {
+      INVALID_INDEX = 0xffffffff
+    };
+
+    struct sEntry
+    {
+      uint64_t hash = 0;
+      unsigned int ip = 0;
+      unsigned short port = 0;
+      uint32_t pathOffset = 0;
+      uint32_t pathLen = 0;
+      sRouteDstRange destinations;
+    };
+
+    // wildcard paths for one (port, ip), matched after the exact path
+    struct sGroup
+    {
+      unsigned int ip = 0;
+      unsigned short port = 0;
+      OSCPathMatcher matcher;  // ids index wildcards
+      std::vector<sRouteDstRange> wildcards;
+    };
+
+    typedef std::vector<uint32_t> SLOTS;
+
+    std::vector<sEntry> m_Entries;
+    SLOTS m_EntrySlots;
+    std::vector<sGroup> m_Groups;
+    SLOTS m_GroupSlots;
+    std::string m_Paths;
+    std::vector<sRouteDst> m_Destinations;
+    mutable OSCPathMatcher::IDS m_Matches;  // scratch, owning thread only
+
+    virtual void AddDestinations(unsigned short port, unsigned int ip, const ROUTES_BY_PATH &routesByPath, bool wildcard);
+    virtual void FindAll(unsigned short port, unsigned int ip, uint64_t pathHash, const char *path, size_t pathLen, DESTINATIONS_LIST &destinations) const;
+    virtual const sEntry *FindEntry(unsigned short port, unsigned int ip, uint64_t pathHash, const char *path, size_t pathLen) const;
+    virtual const sGroup *FindGroup(unsigned short port, unsigned int ip) const;
+    static void InitSlots(size_t count, SLOTS &slots);
+    static uint64_t HashPath(const char *path, size_t pathLen);
+    static uint64_t Hash(unsigned short port, unsigned int ip, uint64_t pathHash);
+  };
 
   enum EnumConstants
   {
     UNIVERSE_SIZE = 512,
-    DEFAULT_PRIORITY = 100
+    DEFAULT_PRIORITY = 100,
+    MAX_UNIVERSE_SOURCES = 8,  // per universe, once full a newcomer replaces a lower priority or quiet source
+    SOURCE_QUIET_MS = 1000,    // sources send at least this often, even when levels are unchanged
+    MAX_SOURCE_IPS = 4,
+    SOURCE_NAME_SIZE = 64
   };
 
+  typedef std::array<uint64_t, (UNIVERSE_SIZE + 63) / 64> SLOT_MASK;
+
+  // merged universe, only touched by the router thread so reading it needs no lock
   struct Universe
   {
+    alignas(64) std::array<uint8_t, UNIVERSE_SIZE> dmx;
+    alignas(64) std::array<uint8_t, UNIVERSE_SIZE> prevDMX;
+    alignas(64) std::array<uint8_t, UNIVERSE_SIZE> channelPriority;
+
+    // source slot each level was taken from, valid until a source is added or removed or its priorities change
+    alignas(64) std::array<uint8_t, UNIVERSE_SIZE> owner;
+    size_t ipSource = 0;
+
+    uint16_t number = 0;
+    bool active = false;  // holds the levels of at least one source
     uint8_t priority = 0;
     unsigned int ip = 0;
-    std::unordered_set<unsigned int> ips;
     bool hasPerChannelPriority = false;
     bool hasPrevDMX = false;
-    std::array<uint8_t, UNIVERSE_SIZE> dmx;
-    std::array<uint8_t, UNIVERSE_SIZE> prevDMX;
-    std::array<uint8_t, UNIVERSE_SIZE> channelPriority;
 
     Universe()
     {
       dmx.fill(0);
       channelPriority.fill(0);
+      owner.fill(0);
     }
   };
 
-  typedef std::map<uint16_t, Universe> UNIVERSE_LIST;
+  // one source of one universe
+  struct sACNUniverseSource
+  {
+    alignas(64) std::array<uint8_t, UNIVERSE_SIZE> dmx;
+    alignas(64) std::array<uint8_t, UNIVERSE_SIZE> channelPriority;
+    SLOT_MASK changedSlots;  // slots whose level changed since the last merge
+    bool hasChangedSlots = false;
+    bool hasPerChannelPriority = false;
+    uint8_t priority = 0;
+    unsigned int ip = 0;
+    std::array<unsigned int, MAX_SOURCE_IPS> ips;
+    size_t ipCount = 0;
+    CID cid;
+    std::array<char, SOURCE_NAME_SIZE> name;
+    qint64 lastPacket = 0;  // sACNRecv::clock
+
+    void Reset(const CID &sourceCID);
+    bool AddIP(unsigned int sourceIP);
+  };
 
-  struct sACNSource
+  // everything received for one universe number, source slots are reused so frames never allocate
+  struct sACNRecvUniverse
   {
-    QString name;
-    UNIVERSE_LIST universes;
+    uint16_t number = 0;
+    bool dirty = false;
+    bool remerge = false;  // sources or priorities changed since the last merge
+    bool sourcesFull = false;
+    size_t sourceCount = 0;
+    std::array<uint8_t, MAX_UNIVERSE_SOURCES> order;  // active source slots in CID order, ties go to the earlier source
+    std::array<sACNUniverseSource, MAX_UNIVERSE_SOURCES> sources;
+
+    sACNUniverseSource *FindSource(const CID &cid);
+    sACNUniverseSource *AddSource(const CID &cid);
+    void RemoveSource(const sACNUniverseSource &source);
+    sACNUniverseSource *FindEvictable(uint8_t newPriority, qint64 now);
   };
 
-  typedef std::map<CID, sACNSource> SACN_SOURCE_LIST;
-  typedef std::unordered_set<uint16_t> UNIVERSE_NUMBER_SET;
+  typedef std::vector<std::unique_ptr<sACNRecvUniverse>> SACN_RECV_UNIVERSE_LIST;
+  typedef std::vector<sACNRecvUniverse *> SACN_RECV_UNIVERSE_PTRS;
 
   struct sACNRecv
   {
     QRecursiveMutex mutex;
-    UNIVERSE_NUMBER_SET dirtyUniverses;
-    SACN_SOURCE_LIST sources;
-    UNIVERSE_LIST merged;
+    std::vector<uint16_t> index;  // by universe number, position in universes + 1
+    SACN_RECV_UNIVERSE_LIST universes;
+    SACN_RECV_UNIVERSE_PTRS dirtyUniverses;
+    QElapsedTimer clock;
     EosLog log;
+
+    sACNRecv()
+      : index(0x10000, 0)
+    {
+      clock.start();
+    }
+
+    sACNRecvUniverse *Find(uint16_t universeNumber) const
+    {
+      uint16_t i = index[universeNumber];
+      return (i == 0) ? nullptr : universes[i - 1].get();
+    }
+
+    sACNRecvUniverse &Add(uint16_t universeNumber);
+    void SetDirty(sACNRecvUniverse &recvUniverse, bool remerge);
+  };
+
+  typedef std::vector<std::unique_ptr<Universe>> MERGED_UNIVERSE_LIST;
+  typedef std::vector<Universe *> MERGED_UNIVERSE_PTRS;
+
+  // merge results, router thread only
+  struct sACNMerged
+  {
+    std::vector<uint16_t> index;  // by universe number, position in universes + 1
+    MERGED_UNIVERSE_LIST universes;
+    MERGED_UNIVERSE_PTRS changed;  // scratch, universes merged in the last pass
+
+    sACNMerged()
+      : index(0x10000, 0)
+    {
+    }
+
+    const Universe *Find(uint16_t universeNumber) const
+    {
+      uint16_t i = index[universeNumber];
+      return (i == 0 || !universes[i - 1]->active) ? nullptr : universes[i - 1].get();
+    }
+
+    Universe &Add(uint16_t universeNumber);
   };
 
   struct SendUniverseData
@@ -543,8 +979,49 @@ protected:
     int GetNetIFListSize() { return static_cast<int>(ifaces.size()); }
   };
 
+  typedef std::vector<unsigned char> MIDI_MESSAGE;
+
+  // one received MIDI message, short messages are held inline so the callback never allocates
+  struct MIDIInMessage
+  {
+    std::array<unsigned char, 3> bytes;
+    uint8_t size = 0;
+    MIDI_MESSAGE *sysEx = nullptr;  // longer messages, one of MIDIInQueue::sysExBuffers
+  };
+
+  // filled on the RtMidi callback thread, drained by the router thread
+  //
+  // SysEx buffers are preallocated and cycle between the two threads through sysExFree,
+  // so neither side allocates once a buffer has grown to the largest message seen
+  struct MIDIInQueue
+  {
+    enum EnumConstants
+    {
+      SYSEX_BUFFER_COUNT = 16,
+      SYSEX_BUFFER_RESERVE = 1024
+    };
+
+    SPSCQueue<MIDIInMessage> messages{1024};
+    SPSCQueue<MIDI_MESSAGE *> sysExFree{SYSEX_BUFFER_COUNT};  // pushed by the router thread, popped by the callback
+    MIDI_MESSAGE *sysExSpare = nullptr;                       // callback only, kept when a push failed
+    std::atomic<uint64_t> sysExDropped{0};                    // no free buffer for a SysEx message
+    std::vector<MIDI_MESSAGE> sysExBuffers;
+    RouterWakeup *wakeup = nullptr;
+
+    MIDIInQueue()
+      : sysExBuffers(SYSEX_BUFFER_COUNT)
+    {
+      for (size_t i = 0; i < sysExBuffers.size(); ++i)
+      {
+        sysExBuffers[i].reserve(SYSEX_BUFFER_RESERVE);
+        sysExFree.Push(&sysExBuffers[i]);
+      }
+    }
+  };
+
   struct MIDIIn
   {
+    std::shared_ptr<MIDIInQueue> queue;  // before midi, so it outlives the port's callbacks
     std::shared_ptr<RtMidiIn> midi;
     std::string name;
   };
@@ -570,6 +1047,140 @@ protected:
     bool outgoing = false;
   };
 
+  typedef std::vector<bool> ITEM_FLAGS;  // indexed by ItemStateTable::ID
+
+  // routes UDP input on its own thread when every route from the input's port only sends OSC/UDP to a known address
+  //
+  // each shard owns a disjoint set of input ports and a RouteTable built from just those ports, so packets from one
+  // source are always routed in order by one thread, and it sends on its own producer queue of each output thread
+  // DMX, MIDI, PSN, TCP, and script routes stay on the router thread, which remains the only writer of universe state
+  class RouteShardThread : public QThread, private OSCParserClient
+  {
+  public:
+    RouteShardThread(RouterThread &router, size_t producer);
+    virtual ~RouteShardThread();
+
+    virtual void AddInput(EosUdpInThread *input);
+    virtual void AddOutput(EosUdpOutThread *output);
+    virtual void Start(const ROUTES_BY_PORT &routesByPort);
+    virtual void Stop();
+    virtual void Flush(EosLog::LOG_Q &logQ);
+    RouterWakeup &GetWakeup() { return m_Wakeup; }
+    bool empty() const { return m_Inputs.empty(); }
+
+  private:
+    typedef std::vector<EosUdpInThread *> INPUTS;
+
+    RouterThread &m_Router;
+    size_t m_Producer;
+    bool m_Run = false;
+    INPUTS m_Inputs;
+    UDP_OUT_THREADS m_Outputs;
+    RouteTable m_RouteTable;
+    RouterWakeup m_Wakeup;
+    LatencyStats m_LatencyStats;
+    ITEM_FLAGS m_Muted;
+    ITEM_FLAGS m_Activity;
+    bool m_HasActivity = false;
+    EosLog m_Log;
+    EosLog m_PrivateLog;
+    QRecursiveMutex m_Mutex;
+
+    virtual void run();
+    virtual void ProcessRecvPacket(bool muteAllOutgoing, const EosAddr &addr, Protocol protocol, DESTINATIONS_LIST &routingDestinationList, EosUdpInThread::sRecvPacket &recvPacket);
+    virtual void SetActivity(ItemStateTable::ID id);
+    virtual void UpdateLog();
+
+    // OSCParserClient
+    virtual void OSCParserClient_Log(const std::string &message);
+    virtual void OSCParserClient_Send(const char *buf, size_t size);
+  };
+
+  typedef std::vector<RouteShardThread *> ROUTE_SHARDS;
+
+  struct sScriptSource
+  {
+    QString script;
+    QString label;
+  };
+
+  typedef std::vector<sScriptSource> SCRIPT_SOURCES;  // indexed by ScriptEngine::ID
+
+  typedef std::array<uint8_t, UNIVERSE_SIZE> SCRIPT_UNIVERSE;
+
+  // one script route invocation, queued to a worker and returned with the script's packet
+  struct sScriptJob
+  {
+    const sRouteDst *routeDst = nullptr;
+    EosAddr addr;
+    Protocol protocol = Protocol::kInvalid;
+    EosAddr dstAddr;
+    bool tcp = false;
+    EosPacket input;                      // OSC input, args are parsed by the worker
+    SCRIPT_UNIVERSE *universe = nullptr;  // sACN or ArtNet input levels when queued, one of the worker's universe buffers
+    size_t universeCount = 0;             // levels in universe
+    EosPacket packet;                     // script output
+  };
+
+  typedef std::vector<sScriptJob> SCRIPT_JOBS;
+
+  // runs route scripts off the router thread, with its own ScriptEngine that has every route script compiled
+  //
+  // a route is always queued to the same worker, so its results come back in the order it received messages
+  // and globals its script keeps between calls stay in one engine, the router thread sends the results
+  // a call running past the time budget is interrupted by the router thread's watchdog, the worker wakes
+  // the router when a call starts so its wait ends at the deadline
+  //
+  // DMX input levels are copied into preallocated universe buffers that cycle between the router and the
+  // worker through m_UniverseFree, like MIDI SysEx buffers, so queueing a DMX script job never allocates
+  class ScriptWorker : public QThread
+  {
+  public:
+    enum EnumConstants
+    {
+      UNIVERSE_BUFFER_COUNT = 64  // DMX jobs queued at once, a universe at 44Hz backed up for well over a second
+    };
+
+    ScriptWorker(RouterThread &router, size_t index);
+    virtual ~ScriptWorker();
+
+    virtual void Start(const SCRIPT_SOURCES &scripts, const QString &showScript);
+    virtual void Stop();
+    virtual bool Push(sScriptJob &job);
+    virtual void PopResults(SCRIPT_JOBS &results);
+    virtual SCRIPT_UNIVERSE *PopUniverse();  // router thread, nullptr when every buffer is queued
+    virtual void Watchdog(qint64 budgetMS);
+    virtual qint64 GetWatchdogTimeout(qint64 budgetMS);  // ms until the running call is over budget, -1 when none is running
+    virtual void Flush(EosLog::LOG_Q &logQ);
+    uint64_t TakeDropped() { return (m_Jobs.TakeDropped() + std::exchange(m_UniverseDropped, 0)); }
+
+  private:
+    RouterThread &m_Router;
+    size_t m_Index;
+    bool m_Run = false;
+    SCRIPT_SOURCES m_Scripts;
+    QString m_ShowScript;
+    SPSCQueue<sScriptJob> m_Jobs;
+    SPSCQueue<sScriptJob> m_Results;
+    std::vector<SCRIPT_UNIVERSE> m_Universes;
+    SPSCQueue<SCRIPT_UNIVERSE *> m_UniverseFree;  // pushed by the worker once a job has run, popped by the router
+    SCRIPT_UNIVERSE *m_UniverseSpare = nullptr;   // router thread only, kept when a push failed
+    uint64_t m_UniverseDropped = 0;               // router thread only, no free universe buffer
+    RouterWakeup m_Wakeup;
+    ScriptEngine *m_Engine = nullptr;  // created and used on this thread, only interrupted from others
+    QElapsedTimer m_CallTimer;         // valid while a script is running
+    bool m_Interrupted = false;
+    EosLog m_Log;
+    EosLog m_PrivateLog;
+    QRecursiveMutex m_Mutex;
+
+    virtual void run();
+    virtual void RunJob(ScriptEngine &engine, sScriptJob &job);
+    virtual void UpdateLog();
+  };
+
+  typedef std::vector<ScriptWorker *> SCRIPT_WORKERS;
+
   bool m_Run;
   unsigned int m_ReconnectDelay;
   Router::ROUTES m_Routes;
@@ -580,35 +1191,70 @@ protected:
   ItemStateTable m_ItemStateTable;
   QRecursiveMutex m_Mutex;
   ScriptEngine *m_ScriptEngine = nullptr;
+  SCRIPT_SOURCES m_ScriptSources;
+  SCRIPT_WORKERS m_ScriptWorkers;  // router thread only
+  SCRIPT_JOBS m_ScriptResults;
   psn::psn_encoder *m_PSNEncoder = nullptr;
   QElapsedTimer m_PSNEncoderTimer;
+  PSN_OUTPUTS m_PSNOutputs;  // by destination
   sACNRecv m_sACNRecv;
+  sACNMerged m_sACNMerged;
+  RouterWakeup m_Wakeup;
+  LatencyStats m_LatencyStats;
+  size_t m_RouteShardCount = 0;
+  MIDI_MESSAGE m_MIDIMessage;  // RecvMIDI scratch
 
   virtual void run();
   virtual void RecvsACN(sACN &sacn, EosUdpInThread::RECV_PORT_Q &recvPortQ);
+  virtual void MergeUniverse(sACNRecvUniverse &recvUniverse, Universe &merged);
+  virtual void UpdateMergedLevels(sACNRecvUniverse &recvUniverse, Universe &merged);
   virtual void RecvArtNet(ArtNet &artnet, EosUdpInThread::RECV_PORT_Q &recvPortQ);
-  virtual void RecvMIDI(OSCParser &oscParser, PacketLogger &packetLogger, bool muteAllIncoming, bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, ROUTES_BY_PORT &routesByPort,
+  virtual void RecvMIDI(OSCParser &oscParser, PacketLogger &packetLogger, bool muteAllIncoming, bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, const RouteTable &routeTable,
                         DESTINATIONS_LIST &routingDestinationList, UDP_OUT_THREADS &udpOutThreads, TCP_SERVER_THREADS &tcpServerThreads, TCP_CLIENT_THREADS &tcpClientThreads);
   virtual void BuildRoutes(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &routesBysACNUniverse, ROUTES_BY_PORT &routesByArtNetUniverse, ROUTES_BY_PORT &routesByMIDI, UDP_IN_THREADS &udpInThreads,
-                           UDP_OUT_THREADS &udpOutThreads, TCP_CLIENT_THREADS &tcpClientThreads, TCP_SERVER_THREADS &tcpServerThreads);
+                           UDP_IN_REACTORS &udpInReactors, ROUTE_SHARDS &routeShards, UDP_OUT_THREADS &udpOutThreads, TCP_CLIENT_THREADS &tcpClientThreads,
+                           TCP_SERVER_THREADS &tcpServerThreads);
+  virtual bool IsShardable(const ROUTES_BY_IP &routesByIp, const UDP_OUT_THREADS &udpOutThreads, const TCP_CLIENT_THREADS &tcpClientThreads, const TCP_SERVER_THREADS &tcpServerThreads,
+                           UDP_OUT_THREADS &outputs);
+  virtual bool IsShardable(const ROUTES_BY_PATH &routesByPath, const UDP_OUT_THREADS &udpOutThreads, const TCP_CLIENT_THREADS &tcpClientThreads, const TCP_SERVER_THREADS &tcpServerThreads,
+                           UDP_OUT_THREADS &outputs);
   virtual void BuildsACN(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &routesBysACNUniverse, ROUTES_BY_PORT &routesByArtNetUniverse, ROUTES_BY_PORT &routesByMIDI, sACN &sacn);
   virtual void BuildArtNet(ROUTES_BY_PORT &routesByPort, ROUTES_BY_PORT &routesBysACNUniverse, ROUTES_BY_PORT &routesByArtNetUniverse, ROUTES_BY_PORT &routesByMIDI, ArtNet &artnet);
   virtual void BuildMIDI(ROUTES_BY_PORT &routesByMIDI, MIDI &midi);
+  static void MIDIInCallback(double timeStamp, std::vector<unsigned char> *message, void *userData);
   virtual EosUdpOutThread *CreateUdpOutThread(const EosAddr &addr, ItemStateTable::ID itemStateTableId, UDP_OUT_THREADS &udpOutThreads);
-  virtual void AddRoutingDestinations(bool isOSC, const QString &path, const sRoutesByIp &routesByIp, DESTINATIONS_LIST &destinations);
-  virtual void ProcessRecvQ(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, OSCParser &oscBundleParser, ROUTES_BY_PORT &routesByPort, DESTINATIONS_LIST &routingDestinationList,
+  virtual void ProcessRecvQ(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, OSCParser &oscBundleParser, const RouteTable &routeTable, DESTINATIONS_LIST &routingDestinationList,
                             UDP_OUT_THREADS &udpOutThreads, TCP_SERVER_THREADS &tcpServerThreads, TCP_CLIENT_THREADS &tcpClientThreads, const EosAddr &addr, EosUdpInThread::RECV_Q &recvQ);
-  virtual void ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, ROUTES_BY_PORT &routesByPort, DESTINATIONS_LIST &routingDestinationList, UDP_OUT_THREADS &udpOutThreads,
+  virtual void ProcessRecvPacket(bool muteAllOutgoing, sACN &sacn, ArtNet &artnet, MIDI &midi, const RouteTable &routeTable, DESTINATIONS_LIST &routingDestinationList, UDP_OUT_THREADS &udpOutThreads,
                                  TCP_SERVER_THREADS &tcpServerThreads, TCP_CLIENT_THREADS &tcpClientThreads, const EosAddr &addr, Protocol protocol, EosUdpInThread::sRecvPacket &recvPacket);
-  virtual bool MakeOSCPacket(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const QString &srcPath, const sRouteDst &route, OSCArgument *args, size_t argsCount, EosPacket &packet);
-  virtual bool MakePSNPacket(EosPacket &osc, EosPacket &psn);
-  virtual bool SendsACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, EosPacket &osc);
-  virtual bool SendArtNet(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const EosRouteDst &dst, EosPacket &osc);
+  virtual void SendOSC(sACN &sacn, ArtNet &artnet, MIDI &midi, UDP_OUT_THREADS &udpOutThreads, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, const EosAddr &dstAddr,
+                       const EosPacket &oscPacket, const OSCMessageView &oscMessage);
+  virtual void StartScriptWorkers();
+  virtual void StopScriptWorkers();
+  virtual bool QueueScript(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, const EosAddr &dstAddr, bool tcp, const EosPacket &input);
+  virtual void ProcessScriptResults(sACN &sacn, ArtNet &artnet, MIDI &midi, UDP_OUT_THREADS &udpOutThreads, TCP_CLIENT_THREADS &tcpClientThreads);
+  virtual size_t GetScriptUniverse(const ArtNet *artnet, const EosAddr &addr, Protocol protocol, std::array<uint8_t, UNIVERSE_SIZE> &dmx);
+  virtual bool GetInputUniverse(const ArtNet *artnet, const EosAddr &addr, Protocol protocol, const uint8_t *&dmx, size_t &size);
+  virtual bool SendDMX(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, OSCArgument *args, size_t argCount);
+  virtual bool MakeOSCPacket(EosLog &log, const ArtNet *artnet, const EosAddr &addr, Protocol protocol, const char *srcPath, size_t srcPathLen, const sRouteDst &route, OSCArgument *args,
+                             size_t argsCount, EosPacket &packet);
+  virtual bool MakeOSCMessage(EosLog &log, const ArtNet *artnet, const EosAddr &addr, Protocol protocol, const char *srcPath, size_t srcPathLen, const sRouteDst &route, OSCArgument *args,
+                              size_t argsCount, OSCMessageView &message);
+  virtual bool WriteOSCPacket(Protocol protocol, const EosRouteDst &dst, const std::string &sendPath, OSCArgument *args, size_t argsCount, EosPacket &packet);
+  virtual bool UpdatePSNOutput(const OSCMessageView &osc, PSNOutput &output);
+  virtual void FlushPSN(bool muteAllOutgoing);
+  virtual bool SendsACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, const OSCMessageView &osc);
+  virtual bool WritesACN(sACN &sacn, ArtNet &artnet, const EosAddr &addr, Protocol protocol, const sRouteDst &routeDst, const sDMXPathOptions &options, OSCArgument *args, size_t argCount);
+  virtual bool SendArtNet(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const EosRouteDst &dst, const OSCMessageView &osc);
+  virtual bool WriteArtNet(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const EosRouteDst &dst, int offset, OSCArgument *args, size_t argCount);
   virtual void FlushArtNet(ArtNet &artnet);
-  virtual void SendMIDI(MIDI &midi, const sRouteDst &routeDst, EosPacket &oscPacket);
+  virtual bool SendArtNetUniverse(ArtNet &artnet, uint16_t universeNumber, const ArtNetSendUniverse &universe);
+  virtual unsigned long GetWaitTimeout(sACN &sacn, ArtNet &artnet);
+  virtual void SendMIDI(MIDI &midi, const sRouteDst &routeDst, const OSCMessageView &osc);
   virtual void ProcessTcpConnectionQ(TCP_CLIENT_THREADS &tcpClientThreads, EosTcpServerThread &tcpServer, EosTcpServerThread::CONNECTION_Q &tcpConnectionQ, bool mute);
   virtual bool ApplyTransform(OSCArgument &arg, const EosRouteDst &dst, OSCPacketWriter &packet);
-  virtual void MakeSendPath(ArtNet &artnet, const EosAddr &addr, Protocol protocol, const QString &srcPath, const QString &dstPath, const OSCArgument *args, size_t argsCount, QString &sendPath);
+  virtual void MakeSendPath(EosLog &log, const ArtNet *artnet, const EosAddr &addr, Protocol protocol, const char *srcPath, size_t srcPathLen, const OSCPathTemplate &dstPath, const OSCArgument *args,
+                            size_t argsCount, std::string &sendPath);
   virtual void UpdateLog();
   virtual MuteAll GetMuteAll();
   virtual bool IsRouteMuted(ItemStateTable::ID id);
@@ -617,6 +1263,8 @@ protected:
   virtual void SetItemState(const ROUTES_BY_IP &routesByIp, Protocol dstProtocol, ItemState::EnumState state);
   virtual void SetItemState(const ROUTES_BY_PATH &routesByPath, Protocol dstProtocol, ItemState::EnumState state);
   virtual void SetItemActivity(ItemStateTable::ID id);
+  virtual void SetItemActivity(const ITEM_FLAGS &activity);
+  virtual void GetMutes(MuteAll &muteAll, ITEM_FLAGS &muted);
   virtual void DestroysACN(sACN &sacn);
   virtual void DestroyArtNet(ArtNet &artnet);
   virtual void LogMIDI(bool send, const std::string &name, const std::vector<unsigned char> &message);
@@ -636,6 +1284,9 @@ protected:
 
   static bool HasProtocolOutput(const ROUTES_BY_PORT &routesByPort, Protocol protocol);
   static bool HasProtocolOutput(const ROUTES_BY_PATH &routesByPath, Protocol protocol);
+  static void GetDMXPathOptions(const OSCMessageView &osc, sDMXPathOptions &options);
+  static bool InitDMXOptions(Protocol srcProtocol, sRouteDst &routeDst);
+  static bool InitOSCPassThrough(Protocol srcProtocol, const std::string &srcPath, const sRouteDst &routeDst);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
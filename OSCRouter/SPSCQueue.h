@@ -0,0 +1,132 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// bounded, lock free queue for exactly one producer thread and one consumer thread
+//
+// items are moved in and out of preallocated slots, so neither side allocates,
+// pushing to a full queue fails and is counted rather than growing the queue
+template <typename T>
+class SPSCQueue
+{
+public:
+  typedef std::vector<T> ITEMS;
+
+  explicit SPSCQueue(size_t capacity = 4096)
+  {
+    size_t size = 2;
+    while (size < capacity)
+      size <<= 1;
+
+    m_Slots.resize(size);
+    m_Mask = (size - 1);
+  }
+
+  SPSCQueue(const SPSCQueue &) = delete;
+  SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+  size_t capacity() const { return m_Slots.size(); }
+  bool empty() const { return (m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire)); }
+
+  // producer
+  bool Push(T &&item)
+  {
+    size_t tail = m_Tail.load(std::memory_order_relaxed);
+    if ((tail - m_CachedHead) > m_Mask)
+    {
+      m_CachedHead = m_Head.load(std::memory_order_acquire);
+      if ((tail - m_CachedHead) > m_Mask)
+      {
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+
+    m_Slots[tail & m_Mask] = std::move(item);
+    m_Tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool Push(const T &item)
+  {
+    T copy(item);
+    return Push(std::move(copy));
+  }
+
+  // consumer
+  bool Pop(T &item)
+  {
+    size_t head = m_Head.load(std::memory_order_relaxed);
+    if (head == m_CachedTail)
+    {
+      m_CachedTail = m_Tail.load(std::memory_order_acquire);
+      if (head == m_CachedTail)
+        return false;
+    }
+
+    item = std::move(m_Slots[head & m_Mask]);
+    m_Slots[head & m_Mask] = T();  // drop any shared resources now, not when the slot is reused
+    m_Head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer, appends everything currently queued
+  size_t PopAll(ITEMS &items)
+  {
+    size_t head = m_Head.load(std::memory_order_relaxed);
+    size_t tail = m_Tail.load(std::memory_order_acquire);
+    m_CachedTail = tail;
+    for (size_t i = head; i != tail; ++i)
+    {
+      items.push_back(std::move(m_Slots[i & m_Mask]));
+      m_Slots[i & m_Mask] = T();
+    }
+
+    m_Head.store(tail, std::memory_order_release);
+    return (tail - head);
+  }
+
+  // either side, number of failed pushes since the last call
+  uint64_t TakeDropped() { return m_Dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+  ITEMS m_Slots;
+  size_t m_Mask = 0;
+  alignas(64) std::atomic<size_t> m_Head{0};  // written by consumer
+  size_t m_CachedTail = 0;                    // consumer only
+  alignas(64) std::atomic<size_t> m_Tail{0};  // written by producer
+  size_t m_CachedHead = 0;                    // producer only
+  alignas(64) std::atomic<uint64_t> m_Dropped{0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
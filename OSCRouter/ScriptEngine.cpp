@@ -0,0 +1,421 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ScriptEngine.h"
+
+#include <limits>
+
+// must be last include
+#include "LeakWatcher.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+const ScriptEngine::ID ScriptEngine::sm_Invalid_Id = static_cast<ScriptEngine::ID>(0xffffffff);
+
+////////////////////////////////////////////////////////////////////////////////
+
+QString ScriptEngine::evaluate(const QString &script, EosLog *log /*= nullptr*/, const QString &label /*= QString()*/, const QString &path /*= QString()*/, const OSCArgument *args /*= nullptr*/,
+                               size_t argsCount /*= 0*/, const uint8_t *universe /*= nullptr*/, size_t universeCount /*= 0*/, EosPacket *packet /*= nullptr*/)
+{
+  // set globals
+  m_JS.globalObject().setProperty(QLatin1String("NAME"), label);
+  m_JS.globalObject().setProperty(QLatin1String("OSC"), path);
+
+  QJSValue jsarray = m_JS.newArray(0);
+  setArgs(jsarray, args, argsCount, universe, universeCount);
+
+  m_JS.globalObject().setProperty(QLatin1String("ARGS"), jsarray);
+  m_JS.globalObject().setProperty(QLatin1String("LOGS"), m_JS.newArray(0));
+
+  // evaluate
+  QStringList stack_trace;
+  QJSValue eval = m_JS.evaluate(script, QString(), 1, &stack_trace);
+  if (eval.isError())
+    return errorString(eval, stack_trace);
+
+  if (log)
+    addLogs(m_JS.globalObject().property(QLatin1String("LOGS")), *log);
+
+  if (!packet)
+    return QString();  // done with evaluation, no packet needed
+
+  QString sendPath = m_JS.globalObject().property(QLatin1String("OSC")).toString();
+  if (sendPath.isEmpty())
+    return QString();  // done with evaluation, no packet needed
+
+  makePacket(sendPath, m_JS.globalObject().property(QLatin1String("ARGS")), *packet);
+  return QString();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ScriptEngine::ID ScriptEngine::compile(const QString &script, const QString &label, EosLog *log /*= nullptr*/)
+{
+  sScript compiled;
+  compiled.label = label;
+  compiled.args = m_JS.newArray(0);
+  compiled.logs = m_JS.newArray(0);
+
+  // as a function body, top level declarations would become locals and lose their values between messages
+  if (HasTopLevelDeclaration(script))
+  {
+    compiled.source = script;
+    if (log)
+      log->AddInfo(QStringLiteral("script %1 declares top level var or function, evaluated per message to keep them global").arg(label).toStdString());
+
+    ID id = static_cast<ID>(m_Scripts.size());
+    m_Scripts.push_back(compiled);
+    return id;
+  }
+
+  // script body starts on line 1, same as evaluate()
+  QString source = QLatin1String("(function () {\n");
+  source += script;
+  source += QLatin1String("\n})");
+
+  QStringList stack_trace;
+  compiled.function = m_JS.evaluate(source, QString(), 0, &stack_trace);
+  if (compiled.function.isError())
+    compiled.error = errorString(compiled.function, stack_trace);
+  else if (!compiled.function.isCallable())
+    compiled.error = QLatin1String("script did not compile to a function");
+
+  ID id = static_cast<ID>(m_Scripts.size());
+  m_Scripts.push_back(compiled);
+  return id;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+QString ScriptEngine::call(ID id, EosLog *log, const QString &path, const OSCArgument *args, size_t argsCount, const uint8_t *universe, size_t universeCount, EosPacket *packet)
+{
+  if (id >= m_Scripts.size())
+    return QLatin1String("invalid script");
+
+  sScript &script = m_Scripts[id];
+  if (!script.error.isEmpty())
+    return script.error;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QString error;
+  if (!script.source.isEmpty())
+  {
+    error = evaluate(script.source, log, script.label, path, args, argsCount, universe, universeCount, packet);
+    addTiming(script, timer.nsecsElapsed());
+    return error;
+  }
+
+  script.args.setProperty(QLatin1String("length"), 0);
+  setArgs(script.args, args, argsCount, universe, universeCount);
+  script.logs.setProperty(QLatin1String("length"), 0);
+
+  // set globals, same as evaluate(), so functions declared by the show script see this message too
+  QJSValue global = m_JS.globalObject();
+  global.setProperty(QLatin1String("NAME"), script.label);
+  global.setProperty(QLatin1String("OSC"), path);
+  global.setProperty(QLatin1String("ARGS"), script.args);
+  global.setProperty(QLatin1String("LOGS"), script.logs);
+
+  QJSValue result = script.function.call();
+
+  if (result.isError())
+    error = errorString(result, QStringList() << result.property(QLatin1String("stack")).toString());
+  else
+  {
+    // the script may have replaced OSC, ARGS or LOGS, so read them back rather than using script.args
+    if (log)
+      addLogs(global.property(QLatin1String("LOGS")), *log);
+
+    if (packet)
+    {
+      QString sendPath = global.property(QLatin1String("OSC")).toString();
+      if (!sendPath.isEmpty())
+        makePacket(sendPath, global.property(QLatin1String("ARGS")), *packet);
+    }
+  }
+
+  addTiming(script, timer.nsecsElapsed());
+  return error;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScriptEngine::addTiming(sScript &script, qint64 ns)
+{
+  ++script.calls;
+  script.totalNS += ns;
+  if (ns > script.maxNS)
+    script.maxNS = ns;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScriptEngine::reportTimings(EosLog &log)
+{
+  for (sScript &script : m_Scripts)
+  {
+    if (script.calls == 0)
+      continue;
+
+    log.AddInfo(QStringLiteral("script %1: %2 calls, avg %3us, max %4us")
+                     .arg(script.label)
+                     .arg(script.calls)
+                     .arg(script.totalNS / static_cast<qint64>(script.calls) / 1000.0, 0, 'f', 1)
+                     .arg(script.maxNS / 1000.0, 0, 'f', 1)
+                     .toStdString());
+
+    script.calls = 0;
+    script.totalNS = script.maxNS = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScriptEngine::setArgs(QJSValue &jsarray, const OSCArgument *args, size_t argsCount, const uint8_t *universe, size_t universeCount)
+{
+  if (args && argsCount != 0)
+  {
+    for (quint32 i = 0; i < static_cast<quint32>(argsCount); ++i)
+    {
+      switch (args[i].GetType())
+      {
+        case OSCArgument::OSC_TYPE_INT32:
+        case OSCArgument::OSC_TYPE_INT64:
+        case OSCArgument::OSC_TYPE_TIME:
+        case OSCArgument::OSC_TYPE_RGBA32:
+        case OSCArgument::OSC_TYPE_MIDI:
+        {
+          int n = 0;
+          if (args[i].GetInt(n))
+            jsarray.setProperty(i, n);
+        }
+        break;
+
+        case OSCArgument::OSC_TYPE_FLOAT32:
+        {
+          float n = 0;
+          if (args[i].GetFloat(n))
+            jsarray.setProperty(i, n);
+        }
+        break;
+
+        case OSCArgument::OSC_TYPE_FLOAT64:
+        {
+          double n = 0;
+          if (args[i].GetDouble(n))
+            jsarray.setProperty(i, n);
+        }
+        break;
+
+        case OSCArgument::OSC_TYPE_TRUE: jsarray.setProperty(i, true); break;
+        case OSCArgument::OSC_TYPE_FALSE: jsarray.setProperty(i, false); break;
+        case OSCArgument::OSC_TYPE_INFINITY: jsarray.setProperty(i, std::numeric_limits<int>::infinity()); break;
+
+        default:
+        {
+          std::string str;
+          if (args[i].GetString(str))
+            jsarray.setProperty(i, QString::fromStdString(str));
+        }
+        break;
+      }
+    }
+
+    jsarray.setProperty(QLatin1String("length"), static_cast<quint32>(argsCount));
+  }
+  else if (universe && universeCount != 0)
+  {
+    for (quint32 i = 0; i < static_cast<quint32>(universeCount); ++i)
+      jsarray.setProperty(i, universe[i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScriptEngine::addLogs(const QJSValue &jsarray, EosLog &log)
+{
+  quint32 count = jsarray.property(QLatin1String("length")).toUInt();
+  for (quint32 i = 0; i < count; ++i)
+  {
+    QString msg = jsarray.property(i).toString();
+    if (!msg.isEmpty())
+      log.AddInfo(msg.toUtf8().constData());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScriptEngine::makePacket(const QString &sendPath, const QJSValue &jsarray, EosPacket &packet)
+{
+  OSCPacketWriter osc(sendPath.toUtf8().constData());
+
+  quint32 count = jsarray.property(QLatin1String("length")).toUInt();
+  for (quint32 i = 0; i < count; ++i)
+  {
+    QJSValue arg = jsarray.property(i);
+    switch (arg.toPrimitive().type())
+    {
+      case QJSPrimitiveValue::Boolean: osc.AddBool(arg.toBool()); break;
+      case QJSPrimitiveValue::Integer: osc.AddInt32(arg.toInt()); break;
+      case QJSPrimitiveValue::Double: osc.AddFloat32(static_cast<float>(arg.toNumber())); break;
+      case QJSPrimitiveValue::String: osc.AddString(arg.toString().toStdString()); break;
+      default: break;
+    }
+  }
+
+  size_t packetSize = 0;
+  char *packetData = osc.Create(packetSize);
+  if (packetData && packetSize)
+  {
+    packet = EosPacket(packetData, static_cast<int>(packetSize));
+    delete[] packetData;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ScriptEngine::HasTopLevelDeclaration(const QString &script)
+{
+  // var outside any function body, or a function declaration (not expression) outside one, skipping strings and comments
+  // unbalanced braces count as a declaration, so scripts this scan misreads keep the old global evaluation
+  std::vector<bool> braces;  // true for function bodies
+  size_t functionDepth = 0;
+  bool functionBody = false;  // next brace opens a function body
+  QChar prev;
+  bool prevOperatorWord = false;
+  int i = 0;
+  int len = script.size();
+  while (i < len)
+  {
+    QChar c = script[i];
+    if (c.isSpace())
+    {
+      ++i;
+      continue;
+    }
+
+    if (c == QLatin1Char('/') && (i + 1) < len && script[i + 1] == QLatin1Char('/'))
+    {
+      while (i < len && script[i] != QLatin1Char('\n'))
+        ++i;
+      continue;
+    }
+
+    if (c == QLatin1Char('/') && (i + 1) < len && script[i + 1] == QLatin1Char('*'))
+    {
+      int end = script.indexOf(QLatin1String("*/"), i + 2);
+      i = (end < 0) ? len : (end + 2);
+      continue;
+    }
+
+    if (c == QLatin1Char('"') || c == QLatin1Char('\'') || c == QLatin1Char('`'))
+    {
+      for (++i; i < len && script[i] != c; ++i)
+      {
+        if (script[i] == QLatin1Char('\\'))
+          ++i;
+      }
+      ++i;
+      prev = QLatin1Char('"');
+      prevOperatorWord = false;
+      continue;
+    }
+
+    if (c == QLatin1Char('{'))
+    {
+      braces.push_back(functionBody);
+      if (functionBody)
+        ++functionDepth;
+      functionBody = false;
+    }
+    else if (c == QLatin1Char('}'))
+    {
+      if (braces.empty())
+        return true;
+      if (braces.back())
+        --functionDepth;
+      braces.pop_back();
+    }
+    else if (c == QLatin1Char('=') && (i + 1) < len && script[i + 1] == QLatin1Char('>'))
+    {
+      // arrow function, only a body when followed by a brace
+      int j = (i + 2);
+      while (j < len && script[j].isSpace())
+        ++j;
+      if (j < len && script[j] == QLatin1Char('{'))
+        functionBody = true;
+      ++i;
+    }
+    else if (c.isLetter() || c == QLatin1Char('_') || c == QLatin1Char('$'))
+    {
+      int start = i;
+      while (i < len && (script[i].isLetterOrNumber() || script[i] == QLatin1Char('_') || script[i] == QLatin1Char('$')))
+        ++i;
+
+      QStringView word = QStringView(script).mid(start, i - start);
+      bool member = (prev == QLatin1Char('.'));
+      if (!member && word == QLatin1String("function"))
+      {
+        bool expression = (prevOperatorWord || (!prev.isNull() && QStringView(u"(,=:?[!&|+-*/%<>~^").contains(prev)));
+        if (!expression && functionDepth == 0)
+          return true;
+        functionBody = true;
+      }
+      else if (!member && word == QLatin1String("var") && functionDepth == 0)
+        return true;
+
+      prevOperatorWord = (!member && (word == QLatin1String("return") || word == QLatin1String("typeof") || word == QLatin1String("new") || word == QLatin1String("void") ||
+                                      word == QLatin1String("delete") || word == QLatin1String("in") || word == QLatin1String("of")));
+      prev = QLatin1Char('a');
+      continue;
+    }
+
+    prev = c;
+    prevOperatorWord = false;
+    ++i;
+  }
+
+  return !braces.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+QString ScriptEngine::errorString(const QJSValue &error, const QStringList &stackTrace)
+{
+  QString str = error.toString();
+
+  if (!stackTrace.isEmpty())
+  {
+    QString trace = stackTrace.join(QLatin1Char('\n'));
+    if (!trace.isEmpty())
+    {
+      if (!str.isEmpty())
+        str += QLatin1Char('\n');
+
+      str += trace;
+    }
+  }
+
+  return str;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,94 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef SCRIPT_ENGINE_H
+#define SCRIPT_ENGINE_H
+
+#ifndef NETWORK_UTILS_H
+#include "NetworkUtils.h"
+#endif
+
+#ifndef EOS_LOG_H
+#include "EosLog.h"
+#endif
+
+#ifndef OSC_PARSER_H
+#include "OSCParser.h"
+#endif
+
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+class ScriptEngine
+{
+public:
+  typedef size_t ID;
+
+  enum EnumConstants
+  {
+    TIMING_REPORT_MS = 60000  // per route call counts and run times, 10s with latency stats
+  };
+
+  static const ID sm_Invalid_Id;
+
+  ScriptEngine() = default;
+
+  QJSEngine &js() { return m_JS; }
+  QString evaluate(const QString &script, EosLog *log = nullptr, const QString &label = QString(), const QString &path = QString(), const OSCArgument *args = nullptr, size_t argsCount = 0,
+                   const uint8_t *universe = nullptr, size_t universeCount = 0, EosPacket *packet = nullptr);
+
+  // route scripts are compiled once into a function, called with the OSC, ARGS, NAME and LOGS globals set for each message,
+  // except scripts declaring top level vars or functions, which keep running in global scope so those stay global
+  ID compile(const QString &script, const QString &label, EosLog *log = nullptr);
+  QString call(ID id, EosLog *log, const QString &path, const OSCArgument *args, size_t argsCount, const uint8_t *universe, size_t universeCount, EosPacket *packet);
+  void reportTimings(EosLog &log);
+
+private:
+  struct sScript
+  {
+    QString label;
+    QString source;  // evaluated in global scope when function is not used
+    QJSValue function;
+    QJSValue args;  // reused for each call
+    QJSValue logs;
+    QString error;  // compile error, reported on each call
+    quint64 calls = 0;
+    qint64 totalNS = 0;
+    qint64 maxNS = 0;
+  };
+
+  typedef std::vector<sScript> SCRIPTS;
+
+  QJSEngine m_JS;
+  SCRIPTS m_Scripts;
+
+  void setArgs(QJSValue &jsarray, const OSCArgument *args, size_t argsCount, const uint8_t *universe, size_t universeCount);
+  void addLogs(const QJSValue &jsarray, EosLog &log);
+  void makePacket(const QString &sendPath, const QJSValue &jsarray, EosPacket &packet);
+  void addTiming(sScript &script, qint64 ns);
+  static QString errorString(const QJSValue &error, const QStringList &stackTrace);
+  static bool HasTopLevelDeclaration(const QString &script);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,1079 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "UdpBatch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+
+#ifdef WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <ctime>
+#elif defined(__APPLE__)
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+// must be last include
+#include "LeakWatcher.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __linux__
+
+struct UdpBatchIn::sBatch
+{
+  mmsghdr headers[MAX_BATCH];
+  iovec iov[MAX_BATCH];
+  sockaddr_in addrs[MAX_BATCH];
+  char control[MAX_BATCH][CMSG_SPACE(sizeof(timespec))];
+  std::vector<char> data;
+};
+
+struct UdpBatchOut::sBatch
+{
+  mmsghdr headers[MAX_BATCH];
+  iovec iov[MAX_BATCH];
+  sockaddr_in addr;
+};
+
+struct UdpPoller::sState
+{
+  int epoll = -1;
+};
+
+#elif defined(WIN32)
+
+struct UdpBatchIn::sBatch
+{
+  std::vector<char> data;
+};
+
+struct UdpBatchOut::sBatch
+{
+  sockaddr_in addr;
+};
+
+struct UdpPoller::sState
+{
+  std::vector<WSAPOLLFD> fds;
+  IDS ids;
+};
+
+#else
+
+struct UdpBatchIn::sBatch
+{
+  char control[CMSG_SPACE(sizeof(timeval))];
+  std::vector<char> data;
+};
+
+struct UdpBatchOut::sBatch
+{
+  sockaddr_in addr;
+};
+
+#ifdef __APPLE__
+struct UdpPoller::sState
+{
+  int kqueue = -1;
+};
+#else
+struct UdpPoller::sState
+{
+  std::vector<pollfd> fds;
+  IDS ids;
+};
+#endif
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef WIN32
+
+static int GetSocketError()
+{
+  return WSAGetLastError();
+}
+
+static bool IsInterrupted(int error)
+{
+  return (error == WSAEINTR);
+}
+
+static bool IsWouldBlock(int error)
+{
+  return (error == WSAEWOULDBLOCK || error == WSAEINTR);
+}
+
+static std::string SocketErrorText(int error)
+{
+  return (std::string("error ") + std::to_string(error));
+}
+
+static void CloseSocket(UDP_SOCKET socket)
+{
+  closesocket(static_cast<SOCKET>(socket));
+}
+
+static int PollSockets(WSAPOLLFD *fds, size_t count, unsigned int timeoutMS)
+{
+  return WSAPoll(fds, static_cast<ULONG>(count), static_cast<INT>(timeoutMS));
+}
+
+// Winsock is reference counted, started once for the process and left running until exit
+static bool StartSockets(EosLog &log)
+{
+  static const int result = []() {
+    WSADATA wsaData;
+    return WSAStartup(MAKEWORD(2, 2), &wsaData);
+  }();
+
+  if (result != 0)
+  {
+    log.AddError(std::string("udp WSAStartup failed: ") + SocketErrorText(result));
+    return false;
+  }
+
+  return true;
+}
+
+#else
+
+static int GetSocketError()
+{
+  return errno;
+}
+
+static bool IsInterrupted(int error)
+{
+  return (error == EINTR);
+}
+
+static bool IsWouldBlock(int error)
+{
+  return (error == EAGAIN || error == EWOULDBLOCK || error == EINTR);
+}
+
+static std::string SocketErrorText(int error)
+{
+  return strerror(error);
+}
+
+static void CloseSocket(UDP_SOCKET socket)
+{
+  close(socket);
+}
+
+static int PollSockets(pollfd *fds, size_t count, unsigned int timeoutMS)
+{
+  return poll(fds, static_cast<nfds_t>(count), static_cast<int>(timeoutMS));
+}
+
+static bool StartSockets(EosLog & /*log*/)
+{
+  return true;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+static UDP_SOCKET CreateSocket()
+{
+#ifdef __linux__
+  return socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP);
+#elif defined(WIN32)
+  return static_cast<UDP_SOCKET>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+#else
+  int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (s >= 0)
+    fcntl(s, F_SETFD, FD_CLOEXEC);
+  return s;
+#endif
+}
+
+#ifndef __linux__
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool SetNonBlocking(UDP_SOCKET socket)
+{
+#ifdef WIN32
+  u_long on = 1;
+  return (ioctlsocket(static_cast<SOCKET>(socket), FIONBIO, &on) == 0);
+#else
+  int flags = fcntl(socket, F_GETFL, 0);
+  return (flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0);
+#endif
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+static int SetSocketOption(UDP_SOCKET socket, int level, int option, const void *value, size_t size)
+{
+#ifdef WIN32
+  return setsockopt(static_cast<SOCKET>(socket), level, option, static_cast<const char *>(value), static_cast<int>(size));
+#else
+  return setsockopt(socket, level, option, value, static_cast<socklen_t>(size));
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void LogSocketError(EosLog &log, const char *prefix, const char *what, const char *ip, unsigned short port)
+{
+  std::string msg = std::string(prefix) + " " + ip + ":" + std::to_string(port) + " " + what + " failed: " + SocketErrorText(GetSocketError());
+  log.AddError(msg);
+}
+
+#ifdef __linux__
+
+////////////////////////////////////////////////////////////////////////////////
+
+static int64_t TimespecToNS(const timespec &t)
+{
+  return (static_cast<int64_t>(t.tv_sec) * 1000000000ll + static_cast<int64_t>(t.tv_nsec));
+}
+
+#else
+
+////////////////////////////////////////////////////////////////////////////////
+
+// same clock as LatencyStats::Now()
+static int64_t SteadyNowNS()
+{
+  return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#endif
+
+#if !defined(__linux__) && !defined(WIN32)
+
+////////////////////////////////////////////////////////////////////////////////
+
+static int64_t SystemNowNS()
+{
+  return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static int64_t TimevalToNS(const timeval &t)
+{
+  return (static_cast<int64_t>(t.tv_sec) * 1000000000ll + static_cast<int64_t>(t.tv_usec) * 1000ll);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+UdpBatchIn::UdpBatchIn()
+  : m_Socket(UDP_INVALID_SOCKET)
+  , m_Batch(nullptr)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+UdpBatchIn::~UdpBatchIn()
+{
+  Shutdown();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpBatchIn::IsSupported()
+{
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpBatchIn::Initialize(EosLog &log, const char *ip, unsigned short port, const char *multicastIP, unsigned int recvBufferSize)
+{
+  Shutdown();
+
+  if (!StartSockets(log))
+    return false;
+
+  m_Socket = CreateSocket();
+  if (m_Socket == UDP_INVALID_SOCKET)
+  {
+    LogSocketError(log, "udp in", "socket", ip, port);
+    return false;
+  }
+
+  int on = 1;
+  SetSocketOption(m_Socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+#ifdef __linux__
+  if (SetSocketOption(m_Socket, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0)
+    LogSocketError(log, "udp in", "SO_TIMESTAMPNS", ip, port);  // not fatal, falls back to queue time
+#elif !defined(WIN32)
+  if (SetSocketOption(m_Socket, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) != 0)
+    LogSocketError(log, "udp in", "SO_TIMESTAMP", ip, port);  // not fatal, falls back to queue time
+#endif
+
+#ifndef __linux__
+  // recvmmsg takes MSG_DONTWAIT, the loops elsewhere read until the socket would block
+  if (!SetNonBlocking(m_Socket))
+  {
+    LogSocketError(log, "udp in", "non-blocking", ip, port);
+    Shutdown();
+    return false;
+  }
+#endif
+
+  if (recvBufferSize != 0)
+  {
+    int size = static_cast<int>(recvBufferSize);
+    if (SetSocketOption(m_Socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) != 0)
+      LogSocketError(log, "udp in", "SO_RCVBUF", ip, port);
+  }
+
+  in_addr ifaceAddr;
+  if (!ip || !*ip || inet_pton(AF_INET, ip, &ifaceAddr) != 1)
+    ifaceAddr.s_addr = htonl(INADDR_ANY);
+
+  // multicast is received on a socket bound to any, joined on the requested interface
+  bool multicast = (multicastIP && *multicastIP);
+  sockaddr_in bindAddr;
+  memset(&bindAddr, 0, sizeof(bindAddr));
+  bindAddr.sin_family = AF_INET;
+  bindAddr.sin_port = htons(port);
+  bindAddr.sin_addr.s_addr = (multicast ? htonl(INADDR_ANY) : ifaceAddr.s_addr);
+  if (bind(m_Socket, reinterpret_cast<const sockaddr *>(&bindAddr), sizeof(bindAddr)) != 0)
+  {
+    LogSocketError(log, "udp in", "bind", ip, port);
+    Shutdown();
+    return false;
+  }
+
+  if (multicast)
+  {
+    ip_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_interface = ifaceAddr;
+    if (inet_pton(AF_INET, multicastIP, &mreq.imr_multiaddr) != 1 || SetSocketOption(m_Socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0)
+    {
+      LogSocketError(log, "udp in", "multicast join", multicastIP, port);
+      Shutdown();
+      return false;
+    }
+  }
+
+  m_Batch = new sBatch;
+  m_Batch->data.resize(static_cast<size_t>(MAX_BATCH) * MAX_PACKET_SIZE);
+#ifdef __linux__
+  for (int i = 0; i < MAX_BATCH; ++i)
+  {
+    m_Batch->iov[i].iov_base = &m_Batch->data[static_cast<size_t>(i) * MAX_PACKET_SIZE];
+    m_Batch->iov[i].iov_len = MAX_PACKET_SIZE;
+  }
+#endif
+
+  std::string msg = std::string("udp in ") + ip + ":" + std::to_string(port) + " batch receive enabled";
+  log.AddInfo(msg);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpBatchIn::Shutdown()
+{
+  if (m_Socket != UDP_INVALID_SOCKET)
+  {
+    CloseSocket(m_Socket);
+    m_Socket = UDP_INVALID_SOCKET;
+  }
+
+  if (m_Batch)
+  {
+    delete m_Batch;
+    m_Batch = nullptr;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpBatchIn::Recv(EosLog &log, unsigned int timeoutMS, PACKETS &packets)
+{
+  packets.clear();
+
+  if (m_Socket == UDP_INVALID_SOCKET || !m_Batch)
+    return false;
+
+#ifdef WIN32
+  WSAPOLLFD pfd;
+  pfd.fd = static_cast<SOCKET>(m_Socket);
+#else
+  pollfd pfd;
+  pfd.fd = m_Socket;
+#endif
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  int ready = PollSockets(&pfd, 1, timeoutMS);
+  if (ready < 0)
+  {
+    int error = GetSocketError();
+    if (IsInterrupted(error))
+      return true;
+    log.AddError(std::string("udp in poll failed: ") + SocketErrorText(error));
+    return false;
+  }
+
+  if (ready == 0)
+    return true;
+
+  return RecvAvailable(log, packets);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpBatchIn::RecvAvailable(EosLog &log, PACKETS &packets)
+{
+  packets.clear();
+
+  if (m_Socket == UDP_INVALID_SOCKET || !m_Batch)
+    return false;
+
+#ifdef __linux__
+  for (int i = 0; i < MAX_BATCH; ++i)
+  {
+    msghdr &hdr = m_Batch->headers[i].msg_hdr;
+    hdr.msg_name = &m_Batch->addrs[i];
+    hdr.msg_namelen = sizeof(m_Batch->addrs[i]);
+    hdr.msg_iov = &m_Batch->iov[i];
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = m_Batch->control[i];
+    hdr.msg_controllen = sizeof(m_Batch->control[i]);
+    hdr.msg_flags = 0;
+    m_Batch->headers[i].msg_len = 0;
+  }
+
+  int count = recvmmsg(m_Socket, m_Batch->headers, MAX_BATCH, MSG_DONTWAIT, nullptr);
+  if (count < 0)
+  {
+    if (IsWouldBlock(errno))
+      return true;
+    log.AddError(std::string("udp in recvmmsg failed: ") + strerror(errno));
+    return false;
+  }
+
+  // kernel timestamps are CLOCK_REALTIME, router latency uses the monotonic clock
+  timespec realNow;
+  timespec monoNow;
+  clock_gettime(CLOCK_REALTIME, &realNow);
+  clock_gettime(CLOCK_MONOTONIC, &monoNow);
+  int64_t monoNowNS = TimespecToNS(monoNow);
+  int64_t realNowNS = TimespecToNS(realNow);
+
+  for (int i = 0; i < count; ++i)
+  {
+    const msghdr &hdr = m_Batch->headers[i].msg_hdr;
+    if (hdr.msg_flags & MSG_TRUNC)
+    {
+      log.AddWarning("udp in packet larger than receive buffer, dropped");
+      continue;
+    }
+
+    sPacket packet;
+    packet.data = static_cast<const char *>(m_Batch->iov[i].iov_base);
+    packet.len = static_cast<int>(m_Batch->headers[i].msg_len);
+    packet.ip = ntohl(m_Batch->addrs[i].sin_addr.s_addr);
+    packet.port = ntohs(m_Batch->addrs[i].sin_port);
+    packet.recvTime = monoNowNS;
+
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(const_cast<msghdr *>(&hdr)); cmsg; cmsg = CMSG_NXTHDR(const_cast<msghdr *>(&hdr), cmsg))
+    {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+      {
+        timespec stamp;
+        memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+        int64_t age = (realNowNS - TimespecToNS(stamp));
+        if (age > 0)
+          packet.recvTime = (monoNowNS - age);
+        break;
+      }
+    }
+
+    packets.push_back(packet);
+  }
+
+  return true;
+#elif defined(WIN32)
+  // no kernel timestamps, packets are stamped as they are read
+  for (int i = 0; i < MAX_BATCH; ++i)
+  {
+    char *buf = &m_Batch->data[static_cast<size_t>(i) * MAX_PACKET_SIZE];
+    sockaddr_in addr;
+    int addrLen = sizeof(addr);
+    int len = recvfrom(static_cast<SOCKET>(m_Socket), buf, MAX_PACKET_SIZE, 0, reinterpret_cast<sockaddr *>(&addr), &addrLen);
+    if (len < 0)
+    {
+      int error = GetSocketError();
+      if (IsWouldBlock(error))
+        break;
+
+      if (error == WSAEMSGSIZE)
+      {
+        log.AddWarning("udp in packet larger than receive buffer, dropped");
+        continue;
+      }
+
+      // ICMP port unreachable for an earlier send from this socket, nothing is lost
+      if (error == WSAECONNRESET)
+        continue;
+
+      log.AddError(std::string("udp in recvfrom failed: ") + SocketErrorText(error));
+      return false;
+    }
+
+    sPacket packet;
+    packet.data = buf;
+    packet.len = len;
+    packet.ip = ntohl(addr.sin_addr.s_addr);
+    packet.port = ntohs(addr.sin_port);
+    packet.recvTime = SteadyNowNS();
+    packets.push_back(packet);
+  }
+
+  return true;
+#else
+  for (int i = 0; i < MAX_BATCH; ++i)
+  {
+    sockaddr_in addr;
+    iovec iov;
+    iov.iov_base = &m_Batch->data[static_cast<size_t>(i) * MAX_PACKET_SIZE];
+    iov.iov_len = MAX_PACKET_SIZE;
+
+    msghdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &addr;
+    hdr.msg_namelen = sizeof(addr);
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = m_Batch->control;
+    hdr.msg_controllen = sizeof(m_Batch->control);
+
+    ssize_t len = recvmsg(m_Socket, &hdr, 0);
+    if (len < 0)
+    {
+      int error = GetSocketError();
+      if (IsWouldBlock(error))
+        break;
+      log.AddError(std::string("udp in recvmsg failed: ") + SocketErrorText(error));
+      return false;
+    }
+
+    if (hdr.msg_flags & MSG_TRUNC)
+    {
+      log.AddWarning("udp in packet larger than receive buffer, dropped");
+      continue;
+    }
+
+    sPacket packet;
+    packet.data = static_cast<const char *>(iov.iov_base);
+    packet.len = static_cast<int>(len);
+    packet.ip = ntohl(addr.sin_addr.s_addr);
+    packet.port = ntohs(addr.sin_port);
+    packet.recvTime = SteadyNowNS();
+
+    // kernel timestamps are wall clock, router latency uses the monotonic clock
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+    {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP)
+      {
+        timeval stamp;
+        memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+        int64_t age = (SystemNowNS() - TimevalToNS(stamp));
+        if (age > 0)
+          packet.recvTime -= age;
+        break;
+      }
+    }
+
+    packets.push_back(packet);
+  }
+
+  return true;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+UdpPoller::UdpPoller()
+  : m_State(nullptr)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+UdpPoller::~UdpPoller()
+{
+  Shutdown();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpPoller::IsSupported()
+{
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpPoller::Initialize(EosLog &log)
+{
+  Shutdown();
+
+  if (!StartSockets(log))
+    return false;
+
+  m_State = new sState;
+
+#ifdef __linux__
+  m_State->epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (m_State->epoll < 0)
+  {
+    log.AddError(std::string("udp in epoll_create1 failed: ") + strerror(errno));
+    Shutdown();
+    return false;
+  }
+#elif defined(__APPLE__)
+  m_State->kqueue = kqueue();
+  if (m_State->kqueue < 0)
+  {
+    log.AddError(std::string("udp in kqueue failed: ") + strerror(errno));
+    Shutdown();
+    return false;
+  }
+
+  fcntl(m_State->kqueue, F_SETFD, FD_CLOEXEC);
+#endif
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpPoller::Shutdown()
+{
+  if (!m_State)
+    return;
+
+#ifdef __linux__
+  if (m_State->epoll >= 0)
+    close(m_State->epoll);
+#elif defined(__APPLE__)
+  if (m_State->kqueue >= 0)
+    close(m_State->kqueue);
+#endif
+
+  delete m_State;
+  m_State = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpPoller::Add(EosLog &log, UDP_SOCKET socket, size_t id)
+{
+  if (!m_State || socket == UDP_INVALID_SOCKET)
+    return false;
+
+#ifdef __linux__
+  // level triggered, a socket with more than one batch queued is reported again on the next Wait
+  epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u64 = static_cast<uint64_t>(id);
+  if (epoll_ctl(m_State->epoll, EPOLL_CTL_ADD, socket, &ev) != 0)
+  {
+    log.AddError(std::string("udp in epoll_ctl failed: ") + strerror(errno));
+    return false;
+  }
+#elif defined(__APPLE__)
+  // without EV_CLEAR a filter is level triggered, like epoll above
+  struct kevent ev;
+  EV_SET(&ev, socket, EVFILT_READ, EV_ADD, 0, 0, reinterpret_cast<void *>(id));
+  if (kevent(m_State->kqueue, &ev, 1, nullptr, 0, nullptr) != 0)
+  {
+    log.AddError(std::string("udp in kevent failed: ") + strerror(errno));
+    return false;
+  }
+#else
+  (void)log;
+#ifdef WIN32
+  WSAPOLLFD pfd;
+  pfd.fd = static_cast<SOCKET>(socket);
+#else
+  pollfd pfd;
+  pfd.fd = socket;
+#endif
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  m_State->fds.push_back(pfd);
+  m_State->ids.push_back(id);
+#endif
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpPoller::Remove(UDP_SOCKET socket)
+{
+  if (!m_State || socket == UDP_INVALID_SOCKET)
+    return;
+
+#ifdef __linux__
+  epoll_ctl(m_State->epoll, EPOLL_CTL_DEL, socket, nullptr);
+#elif defined(__APPLE__)
+  struct kevent ev;
+  EV_SET(&ev, socket, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+  kevent(m_State->kqueue, &ev, 1, nullptr, 0, nullptr);
+#else
+  for (size_t i = 0; i < m_State->fds.size(); ++i)
+  {
+    if (static_cast<UDP_SOCKET>(m_State->fds[i].fd) == socket)
+    {
+      m_State->fds.erase(m_State->fds.begin() + static_cast<std::ptrdiff_t>(i));
+      m_State->ids.erase(m_State->ids.begin() + static_cast<std::ptrdiff_t>(i));
+      break;
+    }
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpPoller::Wait(EosLog &log, unsigned int timeoutMS, IDS &ready)
+{
+  ready.clear();
+
+  if (!m_State)
+    return false;
+
+#ifdef __linux__
+  epoll_event events[MAX_EVENTS];
+  int count = epoll_wait(m_State->epoll, events, MAX_EVENTS, static_cast<int>(timeoutMS));
+  if (count < 0)
+  {
+    if (errno == EINTR)
+      return true;
+    log.AddError(std::string("udp in epoll_wait failed: ") + strerror(errno));
+    return false;
+  }
+
+  for (int i = 0; i < count; ++i)
+    ready.push_back(static_cast<size_t>(events[i].data.u64));
+#elif defined(__APPLE__)
+  struct kevent events[MAX_EVENTS];
+  timespec timeout;
+  timeout.tv_sec = static_cast<time_t>(timeoutMS / 1000);
+  timeout.tv_nsec = static_cast<long>((timeoutMS % 1000) * 1000000);
+  int count = kevent(m_State->kqueue, nullptr, 0, events, MAX_EVENTS, &timeout);
+  if (count < 0)
+  {
+    if (errno == EINTR)
+      return true;
+    log.AddError(std::string("udp in kevent failed: ") + strerror(errno));
+    return false;
+  }
+
+  for (int i = 0; i < count; ++i)
+    ready.push_back(reinterpret_cast<size_t>(events[i].udata));
+#else
+  // WSAPoll rejects an empty set, so an idle poller just waits out the timeout
+  if (m_State->fds.empty())
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMS));
+    return true;
+  }
+
+  int count = PollSockets(m_State->fds.data(), m_State->fds.size(), timeoutMS);
+  if (count < 0)
+  {
+    int error = GetSocketError();
+    if (IsInterrupted(error))
+      return true;
+    log.AddError(std::string("udp in poll failed: ") + SocketErrorText(error));
+    return false;
+  }
+
+  // errors are reported as ready too, so the read fails and the input reconnects
+  for (size_t i = 0; i < m_State->fds.size() && count > 0; ++i)
+  {
+    if (m_State->fds[i].revents != 0)
+    {
+      ready.push_back(m_State->ids[i]);
+      --count;
+    }
+  }
+#endif
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsOSCPacket(const EosPacket &packet)
+{
+  int size = packet.GetSize();
+  if (size <= 0 || (size & 3) != 0)
+    return false;
+
+  const char *data = packet.GetDataConst();
+  return (data[0] == '/' || (size >= 16 && memcmp(data, "#bundle", 8) == 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+UdpBatchOut::UdpBatchOut()
+  : m_Socket(UDP_INVALID_SOCKET)
+  , m_Batch(nullptr)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+UdpBatchOut::~UdpBatchOut()
+{
+  Shutdown();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpBatchOut::IsSupported()
+{
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool UdpBatchOut::Initialize(EosLog &log, const char *ip, unsigned short port, bool multicast)
+{
+  Shutdown();
+
+  m_Name = std::string("udp out ") + ip + ":" + std::to_string(port);
+
+  if (!StartSockets(log))
+    return false;
+
+  m_Socket = CreateSocket();
+  if (m_Socket == UDP_INVALID_SOCKET)
+  {
+    LogSocketError(log, "udp out", "socket", ip, port);
+    return false;
+  }
+
+  // not connected, so ICMP errors from an absent receiver do not fail later sends
+  int on = 1;
+  SetSocketOption(m_Socket, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+
+  if (multicast)
+  {
+#ifdef WIN32
+    DWORD ttl = 1;
+#else
+    unsigned char ttl = 1;
+#endif
+    SetSocketOption(m_Socket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+  }
+
+  m_Batch = new sBatch;
+  memset(&m_Batch->addr, 0, sizeof(m_Batch->addr));
+  m_Batch->addr.sin_family = AF_INET;
+  m_Batch->addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, ip, &m_Batch->addr.sin_addr) != 1)
+  {
+    log.AddError(m_Name + " invalid address");
+    Shutdown();
+    return false;
+  }
+
+#ifdef __linux__
+  for (int i = 0; i < MAX_BATCH; ++i)
+  {
+    msghdr &hdr = m_Batch->headers[i].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &m_Batch->addr;
+    hdr.msg_namelen = sizeof(m_Batch->addr);
+    hdr.msg_iov = &m_Batch->iov[i];
+    hdr.msg_iovlen = 1;
+  }
+#endif
+
+  log.AddInfo(m_Name + " batch send enabled");
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpBatchOut::Shutdown()
+{
+  if (m_Socket != UDP_INVALID_SOCKET)
+  {
+    CloseSocket(m_Socket);
+    m_Socket = UDP_INVALID_SOCKET;
+  }
+
+  if (m_Batch)
+  {
+    delete m_Batch;
+    m_Batch = nullptr;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t UdpBatchOut::Send(EosLog &log, const EosPacket *packets, size_t count, INDICES &failed)
+{
+  failed.clear();
+
+  if (m_Socket == UDP_INVALID_SOCKET || !m_Batch)
+  {
+    for (size_t i = 0; i < count; ++i)
+      failed.push_back(i);
+    return 0;
+  }
+
+  // returns how many packets were sent, only a packet that fails is dropped, like EosUdpOut, and its index added to failed
+#ifdef __linux__
+  size_t next = 0;
+  while (next < count)
+  {
+    unsigned int batchSize = static_cast<unsigned int>(std::min(count - next, static_cast<size_t>(MAX_BATCH)));
+    for (unsigned int i = 0; i < batchSize; ++i)
+    {
+      const EosPacket &packet = packets[next + i];
+      m_Batch->iov[i].iov_base = const_cast<char *>(packet.GetDataConst());
+      m_Batch->iov[i].iov_len = static_cast<size_t>(packet.GetSize());
+      m_Batch->headers[i].msg_len = 0;
+    }
+
+    int result = sendmmsg(m_Socket, m_Batch->headers, batchSize, 0);
+    if (result < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      // sendmmsg only fails outright on the first message of the batch, skip it and send the rest
+      log.AddError(m_Name + " sendmmsg failed: " + strerror(errno));
+      failed.push_back(next);
+      ++next;
+      continue;
+    }
+
+    next += static_cast<size_t>(result);
+  }
+#else
+  size_t next = 0;
+  while (next < count)
+  {
+    const EosPacket &packet = packets[next];
+#ifdef WIN32
+    int result = sendto(static_cast<SOCKET>(m_Socket), packet.GetDataConst(), packet.GetSize(), 0, reinterpret_cast<const sockaddr *>(&m_Batch->addr), sizeof(m_Batch->addr));
+#else
+    ssize_t result = sendto(m_Socket, packet.GetDataConst(), static_cast<size_t>(packet.GetSize()), 0, reinterpret_cast<const sockaddr *>(&m_Batch->addr), sizeof(m_Batch->addr));
+#endif
+    if (result < 0)
+    {
+      int error = GetSocketError();
+      if (IsInterrupted(error))
+        continue;
+
+      log.AddError(m_Name + " sendto failed: " + SocketErrorText(error));
+      failed.push_back(next);
+    }
+
+    ++next;
+  }
+#endif
+
+  return (count - failed.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UdpBatchOut::Coalesce(const EosPacket::Q &packets, size_t maxSize, EosPacket::Q &out, INDICES &ends)
+{
+  // "#bundle", then the immediate time tag
+  static const char BUNDLE_HEADER[16] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+  std::vector<char> bundle;
+
+  size_t i = 0;
+  while (i < packets.size())
+  {
+    size_t first = i;
+    size_t bundleSize = sizeof(BUNDLE_HEADER);
+    while (i < packets.size() && IsOSCPacket(packets[i]) && (bundleSize + 4 + static_cast<size_t>(packets[i].GetSize())) <= maxSize)
+      bundleSize += (4 + static_cast<size_t>(packets[i++].GetSize()));
+
+    if ((i - first) < 2)
+    {
+      // nothing to gain, send as is without a copy
+      i = (first + 1);
+      out.push_back(packets[first]);
+      ends.push_back(i);
+      continue;
+    }
+
+    bundle.resize(bundleSize);
+    char *dst = bundle.data();
+    memcpy(dst, BUNDLE_HEADER, sizeof(BUNDLE_HEADER));
+    dst += sizeof(BUNDLE_HEADER);
+    for (size_t j = first; j < i; ++j)
+    {
+      uint32_t size = static_cast<uint32_t>(packets[j].GetSize());
+      dst[0] = static_cast<char>((size >> 24) & 0xff);
+      dst[1] = static_cast<char>((size >> 16) & 0xff);
+      dst[2] = static_cast<char>((size >> 8) & 0xff);
+      dst[3] = static_cast<char>(size & 0xff);
+      memcpy(dst + 4, packets[j].GetDataConst(), size);
+      dst += (4 + size);
+    }
+
+    out.push_back(EosPacket(bundle.data(), static_cast<int>(bundleSize)));
+    ends.push_back(i);
+  }
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef UDP_BATCH_H
+#define UDP_BATCH_H
+
+#ifndef EOS_LOG_H
+#include "EosLog.h"
+#endif
+
+#ifndef NETWORK_UTILS_H
+#include "NetworkUtils.h"
+#endif
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// native socket handle, SOCKET on Windows
+#ifdef WIN32
+typedef uintptr_t UDP_SOCKET;
+#else
+typedef int UDP_SOCKET;
+#endif
+
+static const UDP_SOCKET UDP_INVALID_SOCKET = static_cast<UDP_SOCKET>(-1);
+
+////////////////////////////////////////////////////////////////////////////////
+
+// native UDP input that drains a socket in batches with kernel receive timestamps where available
+//
+// recvmmsg on Linux, a recvmsg loop on macOS, a non-blocking recvfrom loop on Windows
+class UdpBatchIn
+{
+public:
+  enum EnumConstants
+  {
+    MAX_BATCH = 16,
+    MAX_PACKET_SIZE = 0xffff
+  };
+
+  struct sPacket
+  {
+    const char *data = nullptr;  // valid until the next Recv
+    int len = 0;
+    unsigned int ip = 0;  // host order
+    unsigned short port = 0;
+    int64_t recvTime = 0;  // LatencyStats::Now() clock, from SO_TIMESTAMPNS or SO_TIMESTAMP when available
+  };
+
+  typedef std::vector<sPacket> PACKETS;
+
+  UdpBatchIn();
+  virtual ~UdpBatchIn();
+
+  virtual bool Initialize(EosLog &log, const char *ip, unsigned short port, const char *multicastIP, unsigned int recvBufferSize);
+  virtual void Shutdown();
+  virtual bool Recv(EosLog &log, unsigned int timeoutMS, PACKETS &packets);
+  virtual bool RecvAvailable(EosLog &log, PACKETS &packets);
+  UDP_SOCKET GetSocket() const { return m_Socket; }
+
+  static bool IsSupported();
+
+private:
+  struct sBatch;
+
+  UDP_SOCKET m_Socket;
+  sBatch *m_Batch;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// waits for any of many sockets to become readable, so one thread can service all UDP inputs
+//
+// epoll on Linux, kqueue on macOS, WSAPoll on Windows, all level triggered
+// not thread safe, Add, Remove and Wait are called from the one thread that owns it
+class UdpPoller
+{
+public:
+  enum EnumConstants
+  {
+    MAX_EVENTS = 64
+  };
+
+  typedef std::vector<size_t> IDS;
+
+  UdpPoller();
+  virtual ~UdpPoller();
+
+  virtual bool Initialize(EosLog &log);
+  virtual void Shutdown();
+  virtual bool Add(EosLog &log, UDP_SOCKET socket, size_t id);
+  virtual void Remove(UDP_SOCKET socket);
+  virtual bool Wait(EosLog &log, unsigned int timeoutMS, IDS &ready);
+
+  static bool IsSupported();
+
+private:
+  struct sState;
+
+  sState *m_State;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// native UDP output to a single destination that sends queued packets in batches
+//
+// sendmmsg on Linux, a sendto loop elsewhere
+class UdpBatchOut
+{
+public:
+  enum EnumConstants
+  {
+    MAX_BATCH = 64
+  };
+
+  typedef std::vector<size_t> INDICES;
+
+  UdpBatchOut();
+  virtual ~UdpBatchOut();
+
+  virtual bool Initialize(EosLog &log, const char *ip, unsigned short port, bool multicast);
+  virtual void Shutdown();
+  virtual size_t Send(EosLog &log, const EosPacket *packets, size_t count, INDICES &failed);
+
+  static bool IsSupported();
+
+  // packs runs of consecutive OSC packets into #bundle packets of at most maxSize bytes
+  // ends[n] is one past the index of the last input packet carried by output packet n
+  static void Coalesce(const EosPacket::Q &packets, size_t maxSize, EosPacket::Q &out, INDICES &ends);
+
+private:
+  struct sBatch;
+
+  UDP_SOCKET m_Socket;
+  sBatch *m_Batch;
+  std::string m_Name;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
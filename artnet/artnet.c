@@ -690,9 +690,23 @@ int artnet_send_dmx(artnet_node vn,
  * ports configured.
  */
 int artnet_raw_send_dmx(artnet_node vn,
-                        uint8_t uni,
+                        uint16_t uni,
                         int16_t length,
                         const uint8_t *data) {
+  return artnet_raw_send_dmx_to(vn, 0, uni, length, data);
+}
+
+
+/*
+ * As artnet_raw_send_dmx, but unicast to a single node.
+ *
+ * @param ip the node's address in network byte order, 0 will broadcast
+ */
+int artnet_raw_send_dmx_to(artnet_node vn,
+                           uint32_t ip,
+                           uint16_t uni,
+                           int16_t length,
+                           const uint8_t *data) {
   node n = (node) vn;
   artnet_packet_t p;
 
@@ -710,7 +724,7 @@ int artnet_raw_send_dmx(artnet_node vn,
   }
 
   // set dst addr and length
-  p.to.s_addr = n->state.bcast_addr.s_addr;
+  p.to.s_addr = (ip != 0) ? ip : n->state.bcast_addr.s_addr;
 
   p.length = sizeof(artnet_dmx_t) - (ARTNET_DMX_LENGTH - length);
 
@@ -721,7 +735,7 @@ int artnet_raw_send_dmx(artnet_node vn,
   p.data.admx.ver = ARTNET_VERSION;
   p.data.admx.sequence = 0;
   p.data.admx.physical = 0;
-  p.data.admx.universe = uni;
+  p.data.admx.universe = htols(uni & 0x7fff);  // 15 bit port address
 
   // set length
   p.data.admx.lengthHi = short_get_high_byte(length);
@@ -732,6 +746,106 @@ int artnet_raw_send_dmx(artnet_node vn,
 }
 
 
+/*
+ * Sends an ArtSync, so receivers output all the ArtDmx sent before it at once.
+ * Like artnet_raw_send_dmx this only works if the node type is ARTNET_RAW.
+ */
+int artnet_raw_send_sync(artnet_node vn) {
+  node n = (node) vn;
+  artnet_packet_t p;
+
+  check_nullnode(vn);
+
+  if (n->state.mode != ARTNET_ON)
+    return ARTNET_EACTION;
+
+  if (n->state.node_type != ARTNET_RAW)
+    return ARTNET_ESTATE;
+
+  p.to.s_addr = n->state.bcast_addr.s_addr;
+  p.length = sizeof(artnet_sync_t);
+  p.type = ARTNET_SYNC;
+
+  memcpy(&p.data.async.id, ARTNET_STRING, ARTNET_STRING_SIZE);
+  p.data.async.opCode = htols(ARTNET_SYNC);
+  p.data.async.verH = 0;
+  p.data.async.ver = ARTNET_VERSION;
+  p.data.async.aux1 = 0;
+  p.data.async.aux2 = 0;
+
+  return artnet_net_send(n, &p);
+}
+
+
+/*
+ * Sends one ArtPollReply page for a raw node, to the address the last ArtPoll asked for.
+ * A raw node has no ports of its own, so the caller lists the output ports to advertise,
+ * all sharing one Net and Sub-Net, and numbers each page with its own bind index.
+ * Like artnet_raw_send_dmx this only works if the node type is ARTNET_RAW.
+ *
+ * @param bind_index page number, starting at 1
+ * @param net bits 14-8 of the port addresses
+ * @param subnet bits 7-4 of the port addresses
+ * @param num_ports number of ports in universes, up to ARTNET_MAX_PORTS
+ * @param universes bits 3-0 of each port's address
+ */
+int artnet_raw_send_poll_reply(artnet_node vn,
+                               uint8_t bind_index,
+                               uint8_t net,
+                               uint8_t subnet,
+                               uint8_t num_ports,
+                               const uint8_t *universes) {
+  node n = (node) vn;
+  artnet_packet_t reply;
+  int i;
+
+  check_nullnode(vn);
+
+  if (n->state.mode != ARTNET_ON)
+    return ARTNET_EACTION;
+
+  if (n->state.node_type != ARTNET_RAW)
+    return ARTNET_ESTATE;
+
+  if (num_ports > ARTNET_MAX_PORTS || (num_ports != 0 && universes == NULL)) {
+    artnet_error("%s : Invalid ports (%i)", __FUNCTION__, num_ports);
+    return ARTNET_EARG;
+  }
+
+  reply.to = n->state.reply_addr;
+  reply.type = ARTNET_REPLY;
+  reply.length = sizeof(artnet_reply_t);
+
+  // names, addresses and style from the poll reply template
+  memcpy(&reply.data, &n->ar_temp, sizeof(artnet_reply_t));
+
+  reply.data.ar.subH = net & 0x7f;
+  reply.data.ar.sub = subnet & 0x0f;
+  reply.data.ar.numbportsH = 0;
+  reply.data.ar.numbports = num_ports;
+
+  for (i = 0; i < ARTNET_MAX_PORTS; i++) {
+    reply.data.ar.porttypes[i] = (i < num_ports) ? (ARTNET_ENABLE_OUTPUT | ARTNET_PORT_DMX) : 0;
+    reply.data.ar.goodinput[i] = 0;
+    reply.data.ar.goodoutput[i] = 0;
+    reply.data.ar.swin[i] = 0;
+    reply.data.ar.swout[i] = (i < num_ports) ? (universes[i] & 0x0f) : 0;
+  }
+
+  // Art-Net 3 BindIp and BindIndex, the start of what this version of the packet calls filler
+  memcpy(&reply.data.ar.filler[0], &n->state.ip_addr.s_addr, 4);
+  reply.data.ar.filler[4] = bind_index;
+
+  snprintf((char *) &reply.data.ar.nodereport,
+           sizeof(reply.data.ar.nodereport),
+           "%04x [%04i] libartnet",
+           n->state.report_code,
+           n->state.ar_count);
+
+  return artnet_net_send(n, &reply);
+}
+
+
 
 int artnet_send_address(artnet_node vn,
                         artnet_node_entry e,
@@ -263,9 +263,21 @@ EXTERN int artnet_send_dmx(artnet_node n,
   int16_t length,
   const uint8_t *data);
 EXTERN int artnet_raw_send_dmx(artnet_node vn,
-  uint8_t uni,
+  uint16_t uni,
   int16_t length,
   const uint8_t *data);
+EXTERN int artnet_raw_send_dmx_to(artnet_node vn,
+  uint32_t ip,
+  uint16_t uni,
+  int16_t length,
+  const uint8_t *data);
+EXTERN int artnet_raw_send_sync(artnet_node vn);
+EXTERN int artnet_raw_send_poll_reply(artnet_node vn,
+  uint8_t bind_index,
+  uint8_t net,
+  uint8_t subnet,
+  uint8_t num_ports,
+  const uint8_t *universes);
 EXTERN int artnet_send_address(artnet_node n,
   artnet_node_entry e,
   const char *shortName,
@@ -41,28 +41,28 @@ int check_callback(node n, artnet_packet p, callback_t callback) {
  * Handle an artpoll packet
  */
 int handle_poll(node n, artnet_packet p) {
+  // before the callback, so a raw node replying with artnet_raw_send_poll_reply uses it too
+  //if we're told to unicast further replies
+  if (p->data.ap.ttm & TTM_REPLY_MASK) {
+    n->state.reply_addr = p->from;
+  } else {
+    n->state.reply_addr.s_addr = n->state.bcast_addr.s_addr;
+  }
+
+  // if we are told to send updates when node conditions change
+  if (p->data.ap.ttm & TTM_BEHAVIOUR_MASK) {
+    n->state.send_apr_on_change = TRUE;
+  } else {
+    n->state.send_apr_on_change = FALSE;
+  }
+
   // run callback if defined
   if (check_callback(n, p, n->callbacks.poll))
     return ARTNET_EOK;
 
-  if (n->state.node_type != ARTNET_RAW) {
-    //if we're told to unicast further replies
-    if (p->data.ap.ttm & TTM_REPLY_MASK) {
-      n->state.reply_addr = p->from;
-    } else {
-      n->state.reply_addr.s_addr = n->state.bcast_addr.s_addr;
-    }
-
-    // if we are told to send updates when node conditions change
-    if (p->data.ap.ttm & TTM_BEHAVIOUR_MASK) {
-      n->state.send_apr_on_change = TRUE;
-    } else {
-      n->state.send_apr_on_change = FALSE;
-    }
-
+  if (n->state.node_type != ARTNET_RAW)
     return artnet_tx_poll_reply(n, TRUE);
 
-  }
   return ARTNET_EOK;
 }
 
@@ -772,6 +772,9 @@ int handle(node n, artnet_packet p) {
     case ARTNET_DMX:
       handle_dmx(n, p);
       break;
+    case ARTNET_SYNC:
+      // timing only for nodes that buffer ArtDmx, nothing to handle
+      break;
     case ARTNET_ADDRESS:
       handle_address(n, p);
       break;
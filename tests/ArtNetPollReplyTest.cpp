@@ -0,0 +1,120 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ArtNetPollReply.h"
+#include "TestUtils.h"
+
+#include <set>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// a poll is answered with one reply per page, so together the pages must advertise every routed input universe
+
+static void CheckPages(const ArtNetPollReply::PORT_ADDRESSES &portAddresses, const ArtNetPollReply::PAGES &pages)
+{
+  std::set<uint16_t> expected(portAddresses.begin(), portAddresses.end());
+  std::set<uint16_t> advertised;
+  size_t portCount = 0;
+  for (size_t i = 0; i < pages.size(); ++i)
+  {
+    const ArtNetPollReply::sPage &page = pages[i];
+    CHECK(page.bindIndex == (i + 1));
+    CHECK(page.portCount != 0 && page.portCount <= ArtNetPollReply::PORTS_PER_PAGE);
+    for (size_t port = 0; port < page.portCount; ++port)
+    {
+      uint16_t portAddress = ArtNetPollReply::GetPortAddress(page, port);
+      CHECK(expected.count(portAddress) == 1);
+      advertised.insert(portAddress);
+      ++portCount;
+    }
+  }
+
+  // each universe on exactly one port
+  CHECK(advertised == expected);
+  CHECK(portCount == expected.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestPages()
+{
+  ArtNetPollReply::PAGES pages;
+
+  ArtNetPollReply::PORT_ADDRESSES none;
+  CHECK(ArtNetPollReply::BuildPages(none, pages) == 0);
+  CHECK(pages.empty());
+
+  // unsorted with a duplicate, across Sub-Nets and Nets up to the last port address
+  ArtNetPollReply::PORT_ADDRESSES portAddresses = {5, 0, 1, 2, 3, 4, 17, 300, 5, 32767, 16, 0x100, 0x7f0};
+  CHECK(ArtNetPollReply::BuildPages(portAddresses, pages) == 12);
+  CheckPages(portAddresses, pages);
+
+  // 0-3, 4-5, 16-17, 256, 300, 2032, 32767
+  CHECK(pages.size() == 7);
+  if (pages.size() == 7)
+  {
+    CHECK(pages[0].net == 0 && pages[0].subNet == 0 && pages[0].portCount == 4);
+    CHECK(pages[1].net == 0 && pages[1].subNet == 0 && pages[1].portCount == 2);
+    CHECK(pages[2].net == 0 && pages[2].subNet == 1 && pages[2].portCount == 2);
+    CHECK(pages[3].net == 1 && pages[3].subNet == 0 && pages[3].portCount == 1);
+    CHECK(pages[6].net == 0x7f && pages[6].subNet == 0xf && pages[6].universes[0] == 0xf);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestFullPages()
+{
+  // a whole Net, 256 universes on 64 pages
+  ArtNetPollReply::PORT_ADDRESSES portAddresses;
+  for (uint16_t i = 0; i < 256; ++i)
+    portAddresses.push_back(static_cast<uint16_t>(0x300 + i));
+
+  ArtNetPollReply::PAGES pages;
+  CHECK(ArtNetPollReply::BuildPages(portAddresses, pages) == 256);
+  CHECK(pages.size() == 64);
+  CheckPages(portAddresses, pages);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestTooManyPages()
+{
+  // one universe per Sub-Net needs a page each, only the first MAX_PAGES fit in a bind index
+  ArtNetPollReply::PORT_ADDRESSES portAddresses;
+  for (uint16_t i = 0; i < 300; ++i)
+    portAddresses.push_back(static_cast<uint16_t>(i << 4));
+
+  ArtNetPollReply::PAGES pages;
+  CHECK(ArtNetPollReply::BuildPages(portAddresses, pages) == ArtNetPollReply::MAX_PAGES);
+  CHECK(pages.size() == ArtNetPollReply::MAX_PAGES);
+  if (!pages.empty())
+    CHECK(pages.back().bindIndex == ArtNetPollReply::MAX_PAGES);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+  TestPages();
+  TestFullPages();
+  TestTooManyPages();
+  return TestResult();
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef GLOB_REFERENCE_H
+#define GLOB_REFERENCE_H
+
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// straightforward recursive matcher over the pattern text, the behavior OSCPathPattern must reproduce
+//
+// every '*' tries every split point, so it backtracks exponentially on patterns like /*?*?*?*x,
+// which is also how the matcher worked before it was rewritten as a two-pointer match
+inline bool GlobReferenceMatch(const char *p, const char *s)
+{
+  if (!*p)
+    return !*s;
+
+  if (*p == '*')
+  {
+    for (const char *t = s;; ++t)
+    {
+      if (GlobReferenceMatch(p + 1, t))
+        return true;
+      if (!*t)
+        return false;
+    }
+  }
+
+  if (*p == '?')
+    return (*s && GlobReferenceMatch(p + 1, s + 1));
+
+  if (*p == '[')
+  {
+    const char *end = strchr(p + 1, ']');
+    bool negate = (p[1] == '!');
+    bool member = false;
+    for (const char *q = (p + 1 + (negate ? 1 : 0)); q < end; ++q)
+    {
+      if ((q + 2) < end && q[1] == '-')
+      {
+        member = member || (*s >= q[0] && *s <= q[2]);
+        q += 2;
+      }
+      else
+        member = member || (*q == *s);
+    }
+
+    if (!*s || member == negate)
+      return false;
+
+    return GlobReferenceMatch(end + 1, s + 1);
+  }
+
+  if (*p == '{')
+  {
+    const char *end = strchr(p, '}');
+    const char *alternative = (p + 1);
+    for (;;)
+    {
+      const char *comma = alternative;
+      while (comma < end && *comma != ',')
+        ++comma;
+
+      size_t len = static_cast<size_t>(comma - alternative);
+      if (strncmp(s, alternative, len) == 0 && GlobReferenceMatch(end + 1, s + len))
+        return true;
+
+      if (comma == end)
+        return false;
+
+      alternative = (comma + 1);
+    }
+  }
+
+  return (*p == *s && GlobReferenceMatch(p + 1, s + 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "OSCPathMatcher.h"
+#include "GlobReference.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// times OSCPathPattern against the recursive reference matcher, not run by ctest
+//
+//   OSCPathMatcherBench [iterations]
+
+template <typename FUNC>
+static double NanosecondsPerCall(size_t iterations, FUNC func)
+{
+  auto start = std::chrono::steady_clock::now();
+  size_t matched = 0;
+  for (size_t i = 0; i < iterations; ++i)
+    matched += (func() ? 1 : 0);
+  auto end = std::chrono::steady_clock::now();
+
+  static volatile size_t sink = 0;
+  sink = sink + matched;
+
+  return (std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void Run(const char *name, const std::string &pattern, const std::string &path, size_t iterations)
+{
+  OSCPathPattern compiled;
+  if (!compiled.Compile(pattern))
+  {
+    printf("%-12s invalid pattern %s\n", name, pattern.c_str());
+    return;
+  }
+
+  double reference = NanosecondsPerCall(iterations, [&] { return GlobReferenceMatch(pattern.c_str(), path.c_str()); });
+  double current = NanosecondsPerCall(iterations, [&] { return compiled.Match(path.data(), path.size()); });
+  printf("%-12s reference %14.1f ns   OSCPathPattern %8.1f ns\n", name, reference, current);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+  size_t iterations = 1000000;
+  if (argc > 1)
+    iterations = static_cast<size_t>(std::stoul(argv[1]));
+
+  Run("typical", "/eos/out/*/fire", "/eos/out/event/cue/1/2/fire", iterations);
+  Run("alternative", "/eos/out/{cue,event}/*", "/eos/out/event/cue/1/2/fire", iterations);
+  Run("miss", "/eos/out/*/fire", "/eos/out/event/cue/1/2/fired", iterations);
+
+  // backtracking blows up here, so far fewer iterations
+  std::string longPath = "/" + std::string(64, 'a');
+  Run("adversarial", "/*?*?*?*?*x", longPath, (iterations / 100000) + 1);
+  return 0;
+}
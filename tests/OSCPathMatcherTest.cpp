@@ -0,0 +1,149 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "OSCPathMatcher.h"
+#include "GlobReference.h"
+#include "TestUtils.h"
+
+#include <random>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool Match(const std::string &pattern, const std::string &path)
+{
+  OSCPathPattern compiled;
+  return (compiled.Compile(pattern) && compiled.Match(path.data(), path.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestIsPattern()
+{
+  // only '*' makes a route path a pattern, saved literal paths keep matching exactly
+  CHECK(OSCPathPattern::IsPattern("/eos/out/*"));
+  CHECK(!OSCPathPattern::IsPattern("/eos/out/event"));
+  CHECK(!OSCPathPattern::IsPattern("/eos/out/cue?"));
+  CHECK(!OSCPathPattern::IsPattern("/eos/[1]/{a,b}"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestCompile()
+{
+  OSCPathPattern pattern;
+  CHECK(!pattern.Compile("/a*[bc"));
+  CHECK(!pattern.Compile("/a*{b,c"));
+  CHECK(!pattern.Compile("/*{a,*}"));
+  CHECK(!pattern.Compile("/*{a,[b]}"));
+
+  // closing brackets on their own are literal
+  CHECK(Match("/a*]b", "/a/x]b"));
+  CHECK(Match("/a*}b", "/a}b"));
+  CHECK(!Match("/a*]b", "/a/xb"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestMatch()
+{
+  CHECK(Match("/eos/out/*", "/eos/out/event/cue/1/2/fire"));
+  CHECK(Match("/eos/*/fire", "/eos/out/event/cue/1/2/fire"));
+  CHECK(!Match("/eos/*/fire", "/eos/out/event/cue/1/2/fired"));
+  CHECK(Match("/chan/?*", "/chan/1"));
+  CHECK(!Match("/chan/?*", "/chan/"));
+  CHECK(Match("/chan/[0-9]*", "/chan/42"));
+  CHECK(!Match("/chan/[!0-9]*", "/chan/42"));
+  CHECK(Match("/eos/out/{cue,event}/*", "/eos/out/event/x"));
+  CHECK(!Match("/eos/out/{cue,event}/*", "/eos/out/sub/x"));
+  CHECK(Match("/*{a,ab}b", "/xab"));
+  CHECK(Match("/*{a,ab}b", "/xabb"));
+
+  // exponential for a backtracking matcher, linear here
+  std::string longPath = "/" + std::string(4096, 'a');
+  CHECK(!Match("/*?*?*?*?*?*?*?*?*x", longPath));
+  CHECK(Match("/*?*?*?*?*?*?*?*?*a", longPath));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestReference()
+{
+  // random patterns and paths over a small alphabet, so most of them are near misses
+  static const char *tokens[] = {"a", "b", "/", "*", "?", "[ab]", "[!a]", "[a-b]", "{a,ab}", "{b,/a,}"};
+  static const char alphabet[] = "ab/";
+
+  std::mt19937 rng(1);
+  int mismatches = 0;
+  for (int n = 0; n < 200000; ++n)
+  {
+    std::string pattern;
+    size_t tokenCount = rng() % 7;
+    for (size_t i = 0; i < tokenCount; ++i)
+      pattern += tokens[rng() % (sizeof(tokens) / sizeof(tokens[0]))];
+
+    std::string path;
+    size_t pathLen = rng() % 10;
+    for (size_t i = 0; i < pathLen; ++i)
+      path += alphabet[rng() % (sizeof(alphabet) - 1)];
+
+    if (Match(pattern, path) != GlobReferenceMatch(pattern.c_str(), path.c_str()))
+    {
+      if (mismatches++ < 10)
+        printf("mismatch: pattern \"%s\" path \"%s\"\n", pattern.c_str(), path.c_str());
+    }
+  }
+
+  CHECK(mismatches == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestMatcher()
+{
+  OSCPathMatcher matcher;
+  CHECK(matcher.Add("/eos/out/*", 0));
+  CHECK(matcher.Add("/eos/*", 1));
+  CHECK(matcher.Add("*", 2));
+  CHECK(matcher.Add("/eos/out/{cue,event}/*", 3));
+  CHECK(!matcher.Add("/eos/[", 4));
+
+  OSCPathMatcher::IDS ids;
+  std::string path = "/eos/out/event/1";
+  matcher.Match(path.data(), path.size(), ids);
+  CHECK(ids == OSCPathMatcher::IDS({0, 1, 2, 3}));
+
+  ids.clear();
+  path = "/other";
+  matcher.Match(path.data(), path.size(), ids);
+  CHECK(ids == OSCPathMatcher::IDS({2}));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+  TestIsPattern();
+  TestCompile();
+  TestMatch();
+  TestReference();
+  TestMatcher();
+  return TestResult();
+}
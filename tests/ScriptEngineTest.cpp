@@ -0,0 +1,156 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ScriptEngine.h"
+#include "TestUtils.h"
+
+#include <cstring>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// compiled route scripts calling helper functions declared by the show script, which read and write
+// the OSC, ARGS, NAME and LOGS globals rather than the route script's own
+
+static EosPacket MakeOSCPacket(const char *path, int arg)
+{
+  OSCPacketWriter osc(path);
+  osc.AddInt32(arg);
+
+  size_t packetSize = 0;
+  char *packetData = osc.Create(packetSize);
+  EosPacket packet(packetData, static_cast<int>(packetSize));
+  delete[] packetData;
+  return packet;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static QString Call(ScriptEngine &engine, ScriptEngine::ID id, EosLog &log, const char *path, int arg, EosPacket &packet)
+{
+  EosPacket input = MakeOSCPacket(path, arg);
+  size_t argsCount = 0xffffffff;
+  OSCArgument *args = OSCArgument::GetArgs(input.GetData(), static_cast<size_t>(input.GetSize()), argsCount);
+  QString error = engine.call(id, &log, QString::fromUtf8(path), args, argsCount, nullptr, 0, &packet);
+  delete[] args;
+  return error;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool CheckPacket(const EosPacket &packet, const char *path, int arg)
+{
+  EosPacket expected = MakeOSCPacket(path, arg);
+  return (packet.GetSize() == expected.GetSize() && memcmp(packet.GetDataConst(), expected.GetDataConst(), static_cast<size_t>(expected.GetSize())) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool HasLog(EosLog &log, const std::string &text)
+{
+  EosLog::LOG_Q logQ;
+  log.Flush(logQ);
+  for (EosLog::LOG_Q::const_iterator i = logQ.begin(); i != logQ.end(); ++i)
+  {
+    if (i->text == text)
+      return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestHelperFunctions()
+{
+  ScriptEngine engine;
+  EosLog log;
+
+  QString error = engine.evaluate(QLatin1String("function addLog(msg) { LOGS.push(NAME + ': ' + msg); }\n"
+                                                "function firstArg() { return ARGS[0]; }\n"
+                                                "function redirect() { OSC = '/redirected'; }\n"),
+                                  &log);
+  CHECK(error.isEmpty());
+
+  ScriptEngine::ID id = engine.compile(QLatin1String("addLog('got ' + firstArg()); ARGS[0] = firstArg() * 2; OSC = '/out';"), QLatin1String("double"), &log);
+  CHECK(id != ScriptEngine::sm_Invalid_Id);
+
+  EosPacket packet;
+  CHECK(Call(engine, id, log, "/in", 21, packet).isEmpty());
+  CHECK(CheckPacket(packet, "/out", 42));
+  CHECK(HasLog(log, "double: got 21"));
+
+  // args and logs from the previous message are not carried over
+  CHECK(Call(engine, id, log, "/in", 5, packet).isEmpty());
+  CHECK(CheckPacket(packet, "/out", 10));
+  CHECK(HasLog(log, "double: got 5"));
+
+  // a helper replacing OSC changes where the message is sent
+  ScriptEngine::ID redirectId = engine.compile(QLatin1String("redirect();"), QLatin1String("redirect"), &log);
+  CHECK(Call(engine, redirectId, log, "/in", 7, packet).isEmpty());
+  CHECK(CheckPacket(packet, "/redirected", 7));
+
+  // without any assignment the message is sent on unchanged
+  ScriptEngine::ID passId = engine.compile(QLatin1String("addLog(OSC);"), QLatin1String("pass"), &log);
+  CHECK(Call(engine, passId, log, "/pass", 3, packet).isEmpty());
+  CHECK(CheckPacket(packet, "/pass", 3));
+  CHECK(HasLog(log, "pass: /pass"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestTopLevelDeclaration()
+{
+  ScriptEngine engine;
+  EosLog log;
+
+  // top level var keeps its value between messages
+  ScriptEngine::ID id = engine.compile(QLatin1String("var count = (typeof count === 'number') ? (count + 1) : 1; ARGS[0] = count;"), QLatin1String("count"), &log);
+
+  EosPacket packet;
+  CHECK(Call(engine, id, log, "/count", 0, packet).isEmpty());
+  CHECK(CheckPacket(packet, "/count", 1));
+  CHECK(Call(engine, id, log, "/count", 0, packet).isEmpty());
+  CHECK(CheckPacket(packet, "/count", 2));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestError()
+{
+  ScriptEngine engine;
+  EosLog log;
+
+  ScriptEngine::ID id = engine.compile(QLatin1String("missing();"), QLatin1String("error"), &log);
+
+  EosPacket packet;
+  CHECK(!Call(engine, id, log, "/in", 1, packet).isEmpty());
+  CHECK(packet.GetSize() == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+  TestHelperFunctions();
+  TestTopLevelDeclaration();
+  TestError();
+  return TestResult();
+}
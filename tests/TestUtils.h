@@ -0,0 +1,57 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include <cstdio>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// failed checks are printed and counted, main returns TestResult()
+
+static int g_Failures = 0;
+
+#define CHECK(expr)                                                    \
+  do                                                                   \
+  {                                                                    \
+    if (!(expr))                                                       \
+    {                                                                  \
+      printf("%s(%d): CHECK failed: %s\n", __FILE__, __LINE__, #expr); \
+      ++g_Failures;                                                    \
+    }                                                                  \
+  } while (0)
+
+inline int TestResult()
+{
+  if (g_Failures != 0)
+  {
+    printf("%d checks failed\n", g_Failures);
+    return 1;
+  }
+
+  printf("all checks passed\n");
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
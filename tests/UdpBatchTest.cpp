@@ -0,0 +1,148 @@
+// Copyright (c) 2018 Electronic Theatre Controls, Inc., http://www.etcconnect.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "UdpBatch.h"
+#include "TestUtils.h"
+
+#include <chrono>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// loopback round trip through UdpBatchOut, UdpPoller and UdpBatchIn, on whichever
+// implementation this platform builds
+
+static EosPacket MakeOSCPacket(unsigned int n)
+{
+  // path padded to 4 bytes, then an empty type tag string
+  std::string path = "/test/" + std::to_string(n);
+  std::string data = path;
+  data.append(4 - (path.size() % 4), '\0');
+  data.append(",\0\0\0", 4);
+  return EosPacket(data.data(), static_cast<int>(data.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestCoalesce()
+{
+  EosPacket::Q packets;
+  packets.push_back(MakeOSCPacket(1));
+  packets.push_back(MakeOSCPacket(2));
+  packets.push_back(EosPacket("raw", 3));
+  packets.push_back(MakeOSCPacket(3));
+
+  EosPacket::Q out;
+  UdpBatchOut::INDICES ends;
+  UdpBatchOut::Coalesce(packets, 1024, out, ends);
+
+  // the first two are bundled, the raw packet and the one after it are sent as is
+  CHECK(out.size() == 3);
+  CHECK(ends == UdpBatchOut::INDICES({2, 3, 4}));
+  if (out.size() == 3)
+  {
+    CHECK(out[0].GetSize() == (16 + 2 * (4 + packets[0].GetSize())));
+    CHECK(memcmp(out[0].GetDataConst(), "#bundle", 8) == 0);
+    CHECK(out[1].GetSize() == 3);
+    CHECK(out[2].GetSize() == packets[3].GetSize());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void TestLoopback()
+{
+  EosLog log;
+
+  UdpPoller poller;
+  CHECK(UdpPoller::IsSupported());
+  CHECK(poller.Initialize(log));
+
+  // first free port in a small range
+  UdpBatchIn in;
+  unsigned short port = 0;
+  for (unsigned short p = 47200; p < 47264 && port == 0; ++p)
+  {
+    if (in.Initialize(log, "127.0.0.1", p, nullptr, 0))
+      port = p;
+  }
+
+  CHECK(port != 0);
+  if (port == 0)
+    return;
+
+  CHECK(poller.Add(log, in.GetSocket(), 7));
+
+  UdpBatchOut out;
+  CHECK(out.Initialize(log, "127.0.0.1", port, false));
+
+  const unsigned int COUNT = 40;
+  EosPacket::Q packets;
+  for (unsigned int i = 0; i < COUNT; ++i)
+    packets.push_back(MakeOSCPacket(i));
+
+  UdpBatchOut::INDICES failed;
+  CHECK(out.Send(log, packets.data(), packets.size(), failed) == COUNT);
+  CHECK(failed.empty());
+
+  // loopback does not reorder, so packets arrive in the order they were sent
+  unsigned int received = 0;
+  UdpPoller::IDS ready;
+  UdpBatchIn::PACKETS recvPackets;
+  std::chrono::steady_clock::time_point deadline = (std::chrono::steady_clock::now() + std::chrono::seconds(2));
+  while (received < COUNT && std::chrono::steady_clock::now() < deadline)
+  {
+    CHECK(poller.Wait(log, 100, ready));
+    for (UdpPoller::IDS::const_iterator i = ready.begin(); i != ready.end(); ++i)
+    {
+      CHECK(*i == 7);
+      CHECK(in.RecvAvailable(log, recvPackets));
+      for (UdpBatchIn::PACKETS::const_iterator j = recvPackets.begin(); j != recvPackets.end(); ++j)
+      {
+        CHECK(j->ip == 0x7f000001);
+        CHECK(received < COUNT && j->len == packets[received].GetSize() && memcmp(j->data, packets[received].GetDataConst(), static_cast<size_t>(j->len)) == 0);
+        ++received;
+      }
+    }
+  }
+
+  CHECK(received == COUNT);
+
+  // nothing left queued, and a removed socket is no longer reported
+  CHECK(in.RecvAvailable(log, recvPackets));
+  CHECK(recvPackets.empty());
+  CHECK(out.Send(log, packets.data(), 1, failed) == 1);
+  poller.Remove(in.GetSocket());
+  CHECK(poller.Wait(log, 50, ready));
+  CHECK(ready.empty());
+
+  // Recv waits on the socket itself
+  CHECK(in.Recv(log, 1000, recvPackets));
+  CHECK(recvPackets.size() == 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+  TestCoalesce();
+  TestLoopback();
+  return TestResult();
+}